@@ -378,12 +378,8 @@ end
 -- them with an error then, perhaps.
 
 ---@private
-function Client:handle_body(body)
-  local ok, decoded = pcall(vim.json.decode, body, { luanil = { object = true } })
-  if not ok then
-    self:on_error(client_errors.INVALID_SERVER_JSON, decoded)
-    return
-  end
+--- Handles a decoded message from the server.
+function Client:handle_message(decoded)
   local _ = log.debug() and log.debug('rpc.receive', decoded)
 
   if type(decoded.method) == 'string' and decoded.id then
@@ -506,6 +502,33 @@ function Client:handle_body(body)
   end
 end
 
+---@private
+--- Like create_read_loop(), but the headers and the JSON bodies are parsed on
+--- the thread pool and the decoded messages are passed to {client}.
+---
+---@param client RpcClient
+local function create_client_read_loop(client, on_no_chunk, on_error)
+  local reader = vim._json_rpc_reader(function(decoded)
+    client:handle_message(decoded)
+  end, function(err, kind)
+    if kind == 'header' then
+      local _ = log.error() and log.error('invalid headers', err)
+      client:on_error(client_errors.INVALID_SERVER_MESSAGE, err)
+    else
+      client:on_error(client_errors.INVALID_SERVER_JSON, err)
+    end
+  end)
+  return function(err, chunk)
+    if err then
+      on_error(err)
+    elseif chunk then
+      reader:feed(chunk)
+    else
+      reader:close(on_no_chunk)
+    end
+  end
+end
+
 ---@private
 ---@return RpcClient
 local function new_client(dispatchers, transport)
@@ -622,10 +645,7 @@ local function connect(host, port)
         end)
         return
       end
-      local handle_body = function(body)
-        client:handle_body(body)
-      end
-      tcp:read_start(create_read_loop(handle_body, transport.terminate, function(read_err)
+      tcp:read_start(create_client_read_loop(client, transport.terminate, function(read_err)
         client:on_error(client_errors.READ_ERROR, read_err)
       end))
     end)
@@ -735,10 +755,7 @@ local function start(cmd, cmd_args, dispatchers, extra_spawn_params)
     end
   end)
 
-  local handle_body = function(body)
-    client:handle_body(body)
-  end
-  stdout:read_start(create_read_loop(handle_body, nil, function(err)
+  stdout:read_start(create_client_read_loop(client, nil, function(err)
     client:on_error(client_errors.READ_ERROR, err)
   end))
 
@@ -44,6 +44,7 @@
 #include <lua.h>
 #include <lauxlib.h>
 
+#include "nvim/json_scan.h"
 #include "nvim/lua/executor.h"
 
 #include "lua_cjson.h"
@@ -180,6 +181,7 @@ typedef struct {
 typedef struct {
     const char *data;
     const char *ptr;
+    const char *end;
     strbuf_t *tmp;    /* Temporary storage for strings */
     json_config_t *cfg;
     json_options_t *options;
@@ -545,7 +547,9 @@ static void json_encode_exception(lua_State *l, json_config_t *cfg, strbuf_t *js
 static void json_append_string(lua_State *l, strbuf_t *json, int lindex)
 {
     const char *escstr;
-    unsigned i;
+    const char *slash;
+    size_t i;
+    size_t run;
     const char *str;
     size_t len;
 
@@ -559,6 +563,16 @@ static void json_append_string(lua_State *l, strbuf_t *json, int lindex)
 
     strbuf_append_char_unsafe(json, '\"');
     for (i = 0; i < len; i++) {
+        /* Copy the run of bytes that need no escaping at once */
+        run = json_plain_len(str + i, len - i, false);
+        if (char2escape['/'] && (slash = memchr(str + i, '/', run)))
+            run = slash - (str + i);
+        if (run) {
+            strbuf_append_mem_unsafe(json, str + i, run);
+            i += run;
+            if (i == len)
+                break;
+        }
         escstr = char2escape[(unsigned char)str[i]];
         if (escstr)
             strbuf_append_string(json, escstr);
@@ -1024,6 +1038,7 @@ static void json_set_token_error(json_token_t *token, json_parse_t *json,
 static void json_next_string_token(json_parse_t *json, json_token_t *token)
 {
     char *escape2char = json->cfg->escape2char;
+    size_t run;
     char ch;
 
     /* Caller must ensure a string is next */
@@ -1039,6 +1054,14 @@ static void json_next_string_token(json_parse_t *json, json_token_t *token)
     strbuf_reset(json->tmp);
 
     while ((ch = *json->ptr) != '"') {
+        /* Copy the run of plain characters at once */
+        run = json_plain_len(json->ptr, json->end - json->ptr, false);
+        if (run) {
+            strbuf_append_mem_unsafe(json->tmp, json->ptr, run);
+            json->ptr += run;
+            continue;
+        }
+
         if (!ch) {
             /* Premature end of the string */
             json_set_token_error(token, json, "unexpected end of string");
@@ -1446,6 +1469,7 @@ static int json_decode(lua_State *l)
     json.options = &options;
     json.current_depth = 0;
     json.ptr = json.data;
+    json.end = json.data + json_len;
 
     /* Detect Unicode other than UTF-8 (see RFC 4627, Sec 3)
      *
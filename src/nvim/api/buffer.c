@@ -28,6 +28,7 @@
 #include "nvim/extmark.h"
 #include "nvim/globals.h"
 #include "nvim/lua/executor.h"
+#include "nvim/lua/lazy.h"
 #include "nvim/mapping.h"
 #include "nvim/mark.h"
 #include "nvim/memline.h"
@@ -1401,7 +1402,8 @@ static int64_t normalize_index(buf_T *buf, int64_t index, bool end_exclusive, bo
 }
 
 /// Initialise a string array either:
-/// - on the Lua stack (as a table) (if lstate is not NULL)
+/// - on the Lua stack (as a table, or a lazy array if requested by vim._lazy())
+///   (if lstate is not NULL)
 /// - as an API array object (if lstate is NULL).
 ///
 /// @param lstate  Lua state. When NULL the Array is initialized instead.
@@ -1410,7 +1412,11 @@ static int64_t normalize_index(buf_T *buf, int64_t index, bool end_exclusive, bo
 static inline void init_line_array(lua_State *lstate, Array *a, size_t size)
 {
   if (lstate) {
-    lua_createtable(lstate, (int)size, 0);
+    if (nlua_lazy_results(lstate)) {
+      nlua_push_lazy_lines(lstate, size);
+    } else {
+      lua_createtable(lstate, (int)size, 0);
+    }
   } else {
     a->size = size;
     a->items = xcalloc(a->size, sizeof(Object));
@@ -1419,7 +1425,8 @@ static inline void init_line_array(lua_State *lstate, Array *a, size_t size)
 
 /// Push a string onto either the Lua stack (as a table element) or an API array object.
 ///
-/// For Lua, a table of the correct size must be created first.
+/// For Lua, a table of the correct size must be created first. Lines are added
+/// to a lazy array in order, `idx` must be the number of lines added before.
 /// API array objects must be pre allocated.
 ///
 /// @param lstate      Lua state. When NULL the Array is pushed to instead.
@@ -1431,7 +1438,9 @@ static inline void init_line_array(lua_State *lstate, Array *a, size_t size)
 static void push_linestr(lua_State *lstate, Array *a, const char *s, size_t len, int idx,
                          bool replace_nl)
 {
-  if (lstate) {
+  if (lstate && lua_type(lstate, -1) == LUA_TUSERDATA) {
+    nlua_lazy_lines_add(lstate, s, s ? len : 0, replace_nl);
+  } else if (lstate) {
     // Vim represents NULs as NLs
     if (s && replace_nl && strchr(s, '\n')) {
       char *tmp = xmemdupz(s, len);
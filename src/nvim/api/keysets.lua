@@ -222,5 +222,9 @@ return {
   echo_opts = {
     "verbose";
   };
+  event_stats = {
+    "top";
+    "reset";
+  };
 }
 
@@ -28,6 +28,8 @@
 #include "nvim/eval.h"
 #include "nvim/eval/typval.h"
 #include "nvim/eval/typval_defs.h"
+#include "nvim/event/multiqueue.h"
+#include "nvim/event/stats.h"
 #include "nvim/ex_docmd.h"
 #include "nvim/ex_eval.h"
 #include "nvim/getchar.h"
@@ -35,6 +37,7 @@
 #include "nvim/grid.h"
 #include "nvim/highlight.h"
 #include "nvim/highlight_group.h"
+#include "nvim/histogram.h"
 #include "nvim/keycodes.h"
 #include "nvim/log.h"
 #include "nvim/lua/executor.h"
@@ -1813,6 +1816,22 @@ Float nvim__id_float(Float flt)
   return flt;
 }
 
+/// Sets the minimum level of the messages written to $NVIM_LOG_FILE for a
+/// subsystem, like $NVIM_LOG_LEVEL.
+///
+/// @param subsystem  "RPC", "UI" or "*" for other messages.
+/// @param level  "DBG", "INF", "WRN" or "ERR". Levels below the one Nvim was
+///               built with are not logged.
+/// @param[out] err Error details, if any
+void nvim__set_log_level(String subsystem, String level, Error *err)
+  FUNC_API_FAST
+{
+  if (!log_set_level(subsystem.data, level.data)) {
+    api_set_error(err, kErrorTypeValidation, "Invalid log subsystem or level: %s=%s",
+                  subsystem.data, level.data);
+  }
+}
+
 /// Gets internal stats.
 ///
 /// @return Map of various internal stats.
@@ -1824,6 +1843,101 @@ Dictionary nvim__stats(void)
   PUT(rv, "lua_refcount", INTEGER_OBJ(nlua_get_global_ref_count()));
   PUT(rv, "redraw", INTEGER_OBJ(g_stats.redraw));
   PUT(rv, "arena_alloc_count", INTEGER_OBJ((Integer)arena_alloc_count));
+  PUT(rv, "alloc_count", INTEGER_OBJ((Integer)alloc_count));
+  const GcStats *gc = gc_get_stats();
+  Dictionary gc_pause = histogram_to_dict(&gc->pause);
+  PUT(gc_pause, "skipped", INTEGER_OBJ((Integer)gc->skipped));
+  PUT(rv, "gc", DICTIONARY_OBJ(gc_pause));
+  Dictionary scopes = ARRAY_DICT_INIT;
+  PUT(scopes, "redraw", DICTIONARY_OBJ(arena_stats_to_dict(&redraw_scope.stats)));
+  PUT(scopes, "cmd", DICTIONARY_OBJ(arena_stats_to_dict(&cmd_scope.stats)));
+  PUT(rv, "arena_scopes", DICTIONARY_OBJ(scopes));
+  return rv;
+}
+
+static Dictionary arena_stats_to_dict(const ArenaStats *stats)
+{
+  Dictionary rv = ARRAY_DICT_INIT;
+  PUT(rv, "scope_count", INTEGER_OBJ((Integer)stats->scope_count));
+  PUT(rv, "alloc_count", INTEGER_OBJ((Integer)stats->alloc_count));
+  PUT(rv, "alloc_bytes", INTEGER_OBJ((Integer)stats->alloc_bytes));
+  PUT(rv, "malloc_count", INTEGER_OBJ((Integer)stats->malloc_count));
+  return rv;
+}
+
+static Dictionary histogram_to_dict(const Histogram *h)
+{
+  Dictionary rv = ARRAY_DICT_INIT;
+  PUT(rv, "count", INTEGER_OBJ((Integer)h->count));
+  PUT(rv, "min", INTEGER_OBJ((Integer)h->min));
+  PUT(rv, "max", INTEGER_OBJ((Integer)h->max));
+  PUT(rv, "mean", INTEGER_OBJ((Integer)histogram_mean(h)));
+  PUT(rv, "p50", INTEGER_OBJ((Integer)histogram_percentile(h, 50)));
+  PUT(rv, "p90", INTEGER_OBJ((Integer)histogram_percentile(h, 90)));
+  PUT(rv, "p99", INTEGER_OBJ((Integer)histogram_percentile(h, 99)));
+  return rv;
+}
+
+/// Gets event loop statistics.
+///
+/// Times are in nanoseconds. Statistics are also appended to
+/// "$XDG_STATE_HOME/nvim/event_stats.log" when Nvim receives SIGUSR1.
+///
+/// @param opts  Optional parameters.
+///              - top: number of slowest handlers to return (default 10, at
+///                most the number of tracked handlers).
+///              - reset: clear the statistics after reading them.
+/// @param[out] err Error details, if any
+/// @return Map with keys:
+///   - "queues": map of queue kind ("main", "fast", "channel", "ui") to a map
+///     with "depth_max" and the "wait" and "run" time distributions.
+///   - "handlers": list of the handlers with the highest maximum run time, one
+///     item per handler name.
+Dictionary nvim__event_stats(Dict(event_stats) *opts, Error *err)
+{
+  Dictionary rv = ARRAY_DICT_INIT;
+  Integer top = 10;
+  if (HAS_KEY(opts->top)) {
+    if (opts->top.type != kObjectTypeInteger || opts->top.data.integer < 0) {
+      api_set_error(err, kErrorTypeValidation, "top must be a non-negative integer");
+      return rv;
+    }
+    top = opts->top.data.integer;
+  }
+  bool reset = api_object_to_bool(opts->reset, "reset", false, err);
+  if (ERROR_SET(err)) {
+    return rv;
+  }
+
+  Dictionary queues = ARRAY_DICT_INIT;
+  for (int i = 0; i < kMultiQueueKindCount; i++) {
+    const EventQueueStats *s = event_stats_get((MultiQueueKind)i);
+    Dictionary q = ARRAY_DICT_INIT;
+    PUT(q, "depth_max", INTEGER_OBJ((Integer)s->depth_max));
+    PUT(q, "wait", DICTIONARY_OBJ(histogram_to_dict(&s->wait)));
+    PUT(q, "run", DICTIONARY_OBJ(histogram_to_dict(&s->run)));
+    PUT(queues, multiqueue_kind_name((MultiQueueKind)i), DICTIONARY_OBJ(q));
+  }
+  PUT(rv, "queues", DICTIONARY_OBJ(queues));
+
+  top = MIN(top, EVENT_STATS_HANDLERS_MAX);
+  EventHandlerStats *slowest = xmalloc((size_t)top * sizeof(*slowest));
+  size_t n = event_stats_slowest(slowest, (size_t)top);
+  Array handlers = ARRAY_DICT_INIT;
+  for (size_t i = 0; i < n; i++) {
+    Dictionary h = ARRAY_DICT_INIT;
+    PUT(h, "name", CSTR_TO_OBJ(slowest[i].name));
+    PUT(h, "count", INTEGER_OBJ((Integer)slowest[i].count));
+    PUT(h, "total", INTEGER_OBJ((Integer)slowest[i].total));
+    PUT(h, "max", INTEGER_OBJ((Integer)slowest[i].max));
+    ADD(handlers, DICTIONARY_OBJ(h));
+  }
+  xfree(slowest);
+  PUT(rv, "handlers", ARRAY_OBJ(handlers));
+
+  if (reset) {
+    event_stats_reset();
+  }
   return rv;
 }
 
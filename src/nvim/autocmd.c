@@ -9,6 +9,7 @@
 #include <string.h>
 #include <time.h>
 
+#include "klib/kvec.h"
 #include "nvim/api/private/helpers.h"
 #include "nvim/ascii.h"
 #include "nvim/autocmd.h"
@@ -57,6 +58,31 @@
 #include "nvim/vim.h"
 #include "nvim/window.h"
 
+/// Kind of a pattern in the dispatch index.
+typedef enum {
+  kAuPatOther,     ///< matched with its regprog
+  kAuPatName,      ///< matches only one file name, e.g. "Makefile"
+  kAuPatExt,       ///< matches one extension, e.g. "*.c"
+  kAuPatBuflocal,  ///< <buffer=N>
+} AuPatKind;
+
+typedef kvec_t(int) AuOrdVec;
+
+/// Dispatch index of the patterns of an event. The position of a pattern in
+/// the list of the event is its ordinal. Patterns with the same key are
+/// chained with "next" in ascending order, the maps store the first ordinal
+/// plus one.
+typedef struct {
+  bool valid;
+  AutoPat **pats;             ///< all patterns by ordinal
+  int *next;                  ///< next ordinal with the same key, or -1
+  int npats;
+  Map(String, int) names;     ///< case-folded name -> first ordinal + 1
+  Map(String, int) exts;      ///< case-folded extension -> first ordinal + 1
+  Map(int, int) buflocal;     ///< buffer number -> first ordinal + 1
+  AuOrdVec other;             ///< ordinals of the kAuPatOther patterns
+} AuIndex;
+
 #ifdef INCLUDE_GENERATED_DECLARATIONS
 # include "auevents_name_map.generated.h"
 # include "autocmd.c.generated.h"
@@ -105,6 +131,13 @@
 //   The order of AutoCmds is important, this is the order in which they were
 //   defined and will have to be executed.
 //
+// To avoid matching every pattern of an event when it is triggered, each event
+// also has a dispatch index (AuIndex), built when the event is triggered after
+// its patterns changed. It finds the patterns that can match a file name by
+// hash lookups on the name and its extensions, and by buffer number for
+// buffer-local patterns. Only the remaining patterns, those with wildcards
+// other than a leading "*.", are tried one by one.
+//
 
 // Code for automatic commands.
 static AutoPatCmd *active_apc_list = NULL;  // stack of active autocommands
@@ -130,6 +163,8 @@ static bool autocmd_include_groups = false;
 
 static char *old_termresponse = NULL;
 
+static AuIndex au_index[NUM_EVENTS];
+
 /// Iterates over all the AutoPats for a particular event
 #define FOR_ALL_AUPATS_IN_EVENT(event, ap) \
   for (AutoPat *ap = first_autopat[event]; ap != NULL; ap = ap->next)  // NOLINT
@@ -413,6 +448,7 @@ static void au_cleanup(void)
         *prev_ap = ap->next;
         vim_regfree(ap->reg_prog);
         xfree(ap);
+        au_index[(int)event].valid = false;
       } else {
         prev_ap = &(ap->next);
       }
@@ -429,6 +465,206 @@ AutoPat *au_get_autopat_for_event(event_T event)
   return first_autopat[(int)event];
 }
 
+/// Gets the kind of "ap" in the dispatch index.
+///
+/// @param[out] key  For kAuPatName and kAuPatExt: the name or extension, not
+///                  case-folded.
+static AuPatKind aupat_index_kind(const AutoPat *ap, String *key)
+{
+  if (ap->buflocal_nr != 0) {
+    return kAuPatBuflocal;
+  }
+  if (ap->allow_dirs) {
+    return kAuPatOther;
+  }
+
+  const char *p = ap->pat;
+  size_t len = (size_t)ap->patlen;
+  AuPatKind kind = kAuPatName;
+  if (len > 2 && p[0] == '*' && p[1] == '.') {
+    kind = kAuPatExt;
+    p += 2;
+    len -= 2;
+  }
+  if (len == 0) {
+    return kAuPatOther;
+  }
+  // Only characters that stand for themselves in a file pattern.
+  for (size_t i = 0; i < len; i++) {
+    if (!ASCII_ISALNUM(p[i]) && p[i] != '_' && p[i] != '-' && p[i] != '.') {
+      return kAuPatOther;
+    }
+  }
+  *key = (String){ .data = (char *)p, .size = len };
+  return kind;
+}
+
+/// Frees the dispatch index of an event.
+static void au_index_clear(AuIndex *idx)
+{
+  String key;
+  int ord;
+  map_foreach(&idx->names, key, ord, {
+    (void)ord;
+    api_free_string(key);
+  });
+  map_destroy(String, int)(&idx->names);
+  map_foreach(&idx->exts, key, ord, {
+    (void)ord;
+    api_free_string(key);
+  });
+  map_destroy(String, int)(&idx->exts);
+  map_destroy(int, int)(&idx->buflocal);
+  kv_destroy(idx->other);
+  kv_init(idx->other);
+  XFREE_CLEAR(idx->pats);
+  XFREE_CLEAR(idx->next);
+  idx->npats = 0;
+  idx->valid = false;
+}
+
+/// Adds ordinal "ord" in front of the chain for "key", case-folded.
+static void au_index_add_key(AuIndex *idx, Map(String, int) *map, String key, int ord)
+{
+  char *folded = xmemdupz(key.data, key.size);
+  for (size_t i = 0; i < key.size; i++) {
+    folded[i] = (char)TOLOWER_ASC(folded[i]);
+  }
+  String fkey = { .data = folded, .size = key.size };
+  int *head = map_ref(String, int)(map, fkey, false);
+  if (head != NULL) {
+    xfree(folded);
+  } else {
+    head = map_ref(String, int)(map, fkey, true);
+  }
+  idx->next[ord] = *head - 1;
+  *head = ord + 1;
+}
+
+/// Builds the dispatch index of an event from its list of patterns.
+static void au_index_build(event_T event)
+{
+  AuIndex *idx = &au_index[(int)event];
+  au_index_clear(idx);
+
+  FOR_ALL_AUPATS_IN_EVENT(event, ap) {
+    idx->npats++;
+  }
+  idx->pats = xmalloc((size_t)idx->npats * sizeof(*idx->pats));
+  idx->next = xmalloc((size_t)idx->npats * sizeof(*idx->next));
+  int ord = 0;
+  FOR_ALL_AUPATS_IN_EVENT(event, ap) {
+    idx->pats[ord++] = ap;
+  }
+
+  // Go backwards and add each pattern in front of its chain, so that the
+  // chains are in ascending order.
+  for (ord = idx->npats - 1; ord >= 0; ord--) {
+    AutoPat *ap = idx->pats[ord];
+    idx->next[ord] = -1;
+    if (ap->pat == NULL) {  // removed, freed by au_cleanup()
+      continue;
+    }
+    String key = STRING_INIT;
+    switch (aupat_index_kind(ap, &key)) {
+    case kAuPatName:
+      au_index_add_key(idx, &idx->names, key, ord);
+      break;
+    case kAuPatExt:
+      au_index_add_key(idx, &idx->exts, key, ord);
+      break;
+    case kAuPatBuflocal: {
+      int *head = map_ref(int, int)(&idx->buflocal, ap->buflocal_nr, true);
+      idx->next[ord] = *head - 1;
+      *head = ord + 1;
+      break;
+    }
+    case kAuPatOther:
+      kv_push(idx->other, ord);
+      break;
+    }
+  }
+  for (size_t i = 0, j = kv_size(idx->other); i + 1 < j; i++, j--) {
+    int tmp = kv_A(idx->other, i);
+    kv_A(idx->other, i) = kv_A(idx->other, j - 1);
+    kv_A(idx->other, j - 1) = tmp;
+  }
+
+  idx->valid = true;
+}
+
+static void au_index_add_chain(const AuIndex *idx, int head, AuOrdVec *ords)
+{
+  for (int ord = head - 1; ord >= 0; ord = idx->next[ord]) {
+    kv_push(*ords, ord);
+  }
+}
+
+static int au_ord_cmp(const void *a, const void *b)
+{
+  return *(const int *)a - *(const int *)b;
+}
+
+/// Gets the patterns of "event" that may match "tail" or buffer "bufnr", in
+/// the order they were defined. The caller still has to match them.
+///
+/// @param[out] count  Number of patterns.
+/// @return allocated array of patterns, or NULL when there are none.
+static AutoPat **au_index_candidates(event_T event, const char *tail, int bufnr, size_t *count)
+{
+  AuIndex *idx = &au_index[(int)event];
+  if (!idx->valid) {
+    au_index_build(event);
+  }
+
+  AuOrdVec ords = KV_INITIAL_VALUE;
+  size_t len = strlen(tail);
+  char *folded = xmemdupz(tail, len);
+  bool all = false;
+  for (size_t i = 0; i < len; i++) {
+    if (p_fic && (uint8_t)folded[i] >= 0x80) {
+      // Ignoring case may fold a multibyte character to an ASCII one.
+      all = true;
+      break;
+    }
+    folded[i] = (char)TOLOWER_ASC(folded[i]);
+  }
+
+  if (all) {
+    for (int ord = 0; ord < idx->npats; ord++) {
+      kv_push(ords, ord);
+    }
+  } else {
+    au_index_add_chain(idx, map_get(String, int)(&idx->names, ((String){ .data = folded, .size = len })),
+                       &ords);
+    for (size_t i = 0; i < len; i++) {
+      if (folded[i] == '.') {
+        String ext = { .data = folded + i + 1, .size = len - i - 1 };
+        au_index_add_chain(idx, map_get(String, int)(&idx->exts, ext), &ords);
+      }
+    }
+    if (bufnr != 0) {
+      au_index_add_chain(idx, map_get(int, int)(&idx->buflocal, bufnr), &ords);
+    }
+    for (size_t i = 0; i < kv_size(idx->other); i++) {
+      kv_push(ords, kv_A(idx->other, i));
+    }
+    qsort(ords.items, kv_size(ords), sizeof(int), au_ord_cmp);
+  }
+  xfree(folded);
+
+  *count = kv_size(ords);
+  AutoPat **pats = NULL;
+  if (*count > 0) {
+    pats = xmalloc(*count * sizeof(*pats));
+    for (size_t i = 0; i < *count; i++) {
+      pats[i] = idx->pats[kv_A(ords, i)];
+    }
+  }
+  kv_destroy(ords);
+  return pats;
+}
+
 // Called when buffer is freed, to remove/invalidate related buffer-local
 // autocmds.
 void aubuflocal_remove(buf_T *buf)
@@ -644,6 +880,9 @@ void free_all_autocmds(void)
 
   au_need_clean = true;
   au_cleanup();
+  FOR_ALL_AUEVENTS(event) {
+    au_index_clear(&au_index[(int)event]);
+  }
 
   // Delete the augroup_map, including free the data
   String name;
@@ -1173,6 +1412,7 @@ int autocmd_register(int64_t id, event_T event, char *pat, int patlen, int group
     *prev_ap = ap;
     last_autopat[(int)event] = ap;
     ap->next = NULL;
+    au_index[(int)event].valid = false;
     if (group == AUGROUP_ALL) {
       ap->group = current_augroup;
     } else {
@@ -1682,7 +1922,6 @@ bool apply_autocmds_group(event_T event, char *fname, char *fname_io, bool force
   char *sfname = NULL;  // short file name
   bool retval = false;
   static int nesting = 0;
-  AutoPat *ap;
   char *save_cmdarg;
   long save_cmdbang;
   static int filechangeshell_busy = false;
@@ -1874,9 +2113,10 @@ bool apply_autocmds_group(event_T event, char *fname, char *fname_io, bool force
 
   char *tail = path_tail(fname);
 
-  // Find first autocommand that matches
+  // Find first autocommand that matches. Only the patterns that exist now
+  // are used, to avoid an endless loop when more patterns are added when
+  // executing autocommands.
   AutoPatCmd patcmd = {
-    .curpat = first_autopat[(int)event],
     .group = group,
     .fname = fname,
     .sfname = sfname,
@@ -1884,7 +2124,8 @@ bool apply_autocmds_group(event_T event, char *fname, char *fname_io, bool force
     .event = event,
     .arg_bufnr = autocmd_bufnr,
   };
-  auto_next_pat(&patcmd, false);
+  patcmd.pats = au_index_candidates(event, tail, autocmd_bufnr, &patcmd.npats);
+  auto_next_pat(&patcmd);
 
   // found one, start executing the autocommands
   if (patcmd.curpat != NULL) {
@@ -1904,12 +2145,6 @@ bool apply_autocmds_group(event_T event, char *fname, char *fname_io, bool force
       save_cmdarg = NULL;  // avoid gcc warning
     }
     retval = true;
-    // mark the last pattern, to avoid an endless loop when more patterns
-    // are added when executing autocommands
-    for (ap = patcmd.curpat; ap->next != NULL; ap = ap->next) {
-      ap->last = false;
-    }
-    ap->last = true;
 
     // Make sure cursor and topline are valid.  The first time the current
     // values are saved, restored by reset_lnums().  When nested only the
@@ -1938,6 +2173,7 @@ bool apply_autocmds_group(event_T event, char *fname, char *fname_io, bool force
       active_apc_list = patcmd.next;
     }
   }
+  xfree(patcmd.pats);
 
   RedrawingDisabled--;
   autocmd_busy = save_autocmd_busy;
@@ -2040,11 +2276,9 @@ bool is_autocmd_blocked(void)
   return autocmd_blocked != 0;
 }
 
-/// Find next autocommand pattern that matches.
-/// stop when 'last' flag is set
-void auto_next_pat(AutoPatCmd *apc, int stop_at_last)
+/// Find next autocommand pattern that matches, starting at apc->patidx.
+void auto_next_pat(AutoPatCmd *apc)
 {
-  AutoPat *ap;
   AutoCmd *cp;
   char *s;
 
@@ -2054,8 +2288,9 @@ void auto_next_pat(AutoPatCmd *apc, int stop_at_last)
   XFREE_CLEAR(entry->es_name);
   entry->es_info.aucmd = NULL;
 
-  for (ap = apc->curpat; ap != NULL && !got_int; ap = ap->next) {
-    apc->curpat = NULL;
+  apc->curpat = NULL;
+  for (; apc->patidx < apc->npats && !got_int; apc->patidx++) {
+    AutoPat *ap = apc->pats[apc->patidx];
 
     // Only use a pattern when it has not been removed, has commands and
     // the group matches. For buffer-local autocommands only check the
@@ -2102,9 +2337,6 @@ void auto_next_pat(AutoPatCmd *apc, int stop_at_last)
         break;
       }
     }
-    if (stop_at_last && ap->last) {
-      break;
-    }
   }
 }
 
@@ -2191,14 +2423,8 @@ char *getnextac(int c, void *cookie, int indent, bool do_concat)
     }
 
     // at end of commands, find next pattern that matches
-    if (acp->curpat->last) {
-      acp->curpat = NULL;
-    } else {
-      acp->curpat = acp->curpat->next;
-    }
-    if (acp->curpat != NULL) {
-      auto_next_pat(acp, true);
-    }
+    acp->patidx++;
+    auto_next_pat(acp);
     if (acp->curpat == NULL) {
       return NULL;
     }
@@ -2265,6 +2491,13 @@ char *getnextac(int c, void *cookie, int indent, bool do_concat)
 /// @param buf buffer the file is open in
 bool has_autocmd(event_T event, char *sfname, buf_T *buf)
   FUNC_ATTR_WARN_UNUSED_RESULT
+{
+  return has_autocmd_except(event, sfname, buf, AUGROUP_ERROR);
+}
+
+/// Like has_autocmd(), but ignore the autocommands in group "group".
+bool has_autocmd_except(event_T event, char *sfname, buf_T *buf, int group)
+  FUNC_ATTR_WARN_UNUSED_RESULT
 {
   char *tail = path_tail(sfname);
   bool retval = false;
@@ -2283,7 +2516,7 @@ bool has_autocmd(event_T event, char *sfname, buf_T *buf)
 #endif
 
   for (AutoPat *ap = first_autopat[(int)event]; ap != NULL; ap = ap->next) {
-    if (ap->pat != NULL && ap->cmds != NULL
+    if (ap->pat != NULL && ap->cmds != NULL && ap->group != group
         && (ap->buflocal_nr == 0
             ? match_file_pat(NULL,
                              &ap->reg_prog,
@@ -58,13 +58,15 @@ struct AutoPat_S {
   int patlen;                           // strlen() of pat
   int buflocal_nr;                      // !=0 for buffer-local AutoPat
   char allow_dirs;                      // Pattern may match whole path
-  char last;                            // last pattern for apply_autocmds()
 };
 
 /// Struct used to keep status while executing autocommands for an event.
 typedef struct AutoPatCmd_S AutoPatCmd;
 struct AutoPatCmd_S {
-  AutoPat *curpat;          // next AutoPat to examine
+  AutoPat *curpat;          // AutoPat being executed
+  AutoPat **pats;           // AutoPats that may match, from the dispatch index
+  size_t npats;             // number of items in pats
+  size_t patidx;            // index of curpat in pats
   AutoCmd *nextcmd;         // next AutoCmd to execute
   int group;                // group being used
   char *fname;              // fname to match with
@@ -66,6 +66,7 @@
 #include "nvim/help.h"
 #include "nvim/indent.h"
 #include "nvim/indent_c.h"
+#include "nvim/insexpand.h"
 #include "nvim/main.h"
 #include "nvim/map.h"
 #include "nvim/mapping.h"
@@ -818,6 +819,7 @@ void buf_freeall(buf_T *buf, int flags)
 
   ml_close(buf, true);              // close and delete the memline/memfile
   buf->b_ml.ml_line_count = 0;      // no lines in buffer
+  ins_compl_free_index(buf);
   if ((flags & BFA_KEEP_UNDO) == 0) {
     u_blockfree(buf);               // free the memory allocated for undo
     u_clearall(buf);                // reset all undo information
@@ -887,7 +889,9 @@ static void free_buffer_stuff(buf_T *buf, int free_flags)
     clear_wininfo(buf);                 // including window-local options
     free_buf_options(buf, true);
     ga_clear(&buf->b_s.b_langp);
+    spell_cache_free(&buf->b_s);
   }
+  ins_compl_free_index(buf);
   {
     // Avoid losing b:changedtick when deleting buffer: clearing variables
     // implies using clear_tv() on b:changedtick and that sets changedtick to
@@ -379,6 +379,12 @@ struct stl_item {
 
 typedef struct qf_info_S qf_info_T;
 
+// Cached spell_check() results, defined in spell.c.
+typedef struct spell_cache_S spell_cache_T;
+
+// Words of a buffer for insert mode completion, defined in insexpand.c.
+typedef struct compl_index_S compl_index_T;
+
 // Used for :syntime: timing of executing a syntax pattern.
 typedef struct {
   proftime_T total;             // total time used
@@ -438,6 +444,7 @@ typedef struct {
 
   // for spell checking
   garray_T b_langp;           // list of pointers to slang_T, see spell.c
+  spell_cache_T *b_spell_cache;  // checked words for b_langp or NULL
   bool b_spell_ismw[256];     // flags: is midword char
   char *b_spell_ismw_mb;      // multi-byte midword chars
   char *b_p_spc;              // 'spellcapcheck'
@@ -611,6 +618,7 @@ struct file_buffer {
   colnr_T b_u_line_colnr;       // optional column number
 
   bool b_scanned;               // ^N/^P have scanned this buffer
+  compl_index_T *b_compl_index;  // words for ^N/^P or NULL
 
   // flags for use of ":lmap" and IM control
   long b_p_iminsert;            // input mode for insert
@@ -885,6 +893,9 @@ struct diffblock_S {
                         // smaller diff hunks?
 };
 
+// Diff being computed on the thread pool, defined in diff.c.
+typedef struct diffjob_S diffjob_T;
+
 #define SNAP_HELP_IDX   0
 #define SNAP_AUCMD_IDX 1
 #define SNAP_COUNT     2
@@ -911,6 +922,12 @@ struct tabpage_S {
   buf_T *(tp_diffbuf[DB_COUNT]);
   int tp_diff_invalid;              ///< list of diffs is outdated
   int tp_diff_update;               ///< update diffs before redrawing
+  bool tp_diff_incremental;         ///< only the dirty lines need a new diff
+  linenr_T tp_diff_dirty_top[DB_COUNT];  ///< first line changed since the
+                                         ///< last update, zero if none
+  linenr_T tp_diff_dirty_bot[DB_COUNT];  ///< last line changed since the
+                                         ///< last update
+  diffjob_T *tp_diff_job;           ///< diff being computed, or NULL
   frame_T *(tp_snapshot[SNAP_COUNT]);    ///< window layout snapshots
   ScopeDictDictItem tp_winvar;      ///< Variable for "t:" Dictionary.
   dict_T *tp_vars;         ///< Internal variables, local to tab page.
@@ -1083,6 +1100,24 @@ typedef struct {
   pos_T w_cursor_corr;  // corrected cursor position
 } pos_save_T;
 
+/// Result of 'foldexpr' for one line, see fold.c.
+typedef struct {
+  int fe_level;  ///< number returned by the expression
+  char fe_type;  ///< character before the number ('a', '>', ...), or NUL
+  bool fe_valid;
+} foldexpr_line_T;
+
+/// Results of 'foldexpr' for the lines of the buffer in a window, kept for as
+/// long as the lines don't change.
+typedef struct {
+  foldexpr_line_T *fc_lines;  ///< entry per line, "fc_lines[0]" is line 1
+  linenr_T fc_count;  ///< number of lines in the buffer
+  linenr_T fc_size;  ///< allocated entries
+  varnumber_T fc_tick;  ///< b:changedtick the entries are up to date with
+  char *fc_expr;  ///< 'foldexpr' the entries were computed with
+  bool fc_disabled;  ///< expression calls foldlevel(), don't cache results
+} foldexpr_cache_T;
+
 /// Structure which contains all information that belongs to a window.
 ///
 /// All row numbers are relative to the start of the window, except w_winrow.
@@ -1283,6 +1318,7 @@ struct window_S {
   wline_T *w_lines;
 
   garray_T w_folds;                 // array of nested folds
+  foldexpr_cache_T w_fold_expr_cache;  // results of 'foldexpr' per line
   bool w_fold_manual;               // when true: some folds are opened/closed
                                     // manually
   bool w_foldinvalid;               // when true: folding needs to be
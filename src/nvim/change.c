@@ -168,6 +168,7 @@ static void changed_common(linenr_T lnum, colnr_T col, linenr_T lnume, linenr_T
   if (curwin->w_p_diff && diff_internal()) {
     curtab->tp_diff_update = true;
   }
+  diff_changed_lines(curbuf, lnum, lnume, xtra);
 
   // set the '. mark
   if ((cmdmod.cmod_flags & CMOD_KEEPJUMPS) == 0) {
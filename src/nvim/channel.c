@@ -197,6 +197,7 @@ Channel *channel_alloc(ChannelStreamType type)
     chan->id = next_chan_id++;
   }
   chan->events = multiqueue_new_child(main_loop.events);
+  multiqueue_set_kind(chan->events, kMultiQueueChannel);
   chan->refcount = 1;
   chan->exit_status = -1;
   chan->streamtype = type;
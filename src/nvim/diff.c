@@ -28,6 +28,7 @@
 #include "nvim/diff.h"
 #include "nvim/drawscreen.h"
 #include "nvim/eval.h"
+#include "nvim/event/pool.h"
 #include "nvim/ex_cmds.h"
 #include "nvim/ex_cmds_defs.h"
 #include "nvim/ex_docmd.h"
@@ -85,6 +86,15 @@ static int linematch_lines = 0;
 
 #define LBUFLEN 50               // length of line in diff file
 
+// A complete update of diffs with at least this many lines in total is done on
+// the thread pool when redrawing, an incremental update of this many lines is
+// replaced with a complete one.
+#define DIFF_ASYNC_MINLINES 20000
+
+// Number of unchanged lines kept between the changed lines and the diff blocks
+// that are kept by an incremental update.
+#define DIFF_INCR_CONTEXT 1
+
 // kTrue when "diff -a" works, kFalse when it doesn't work,
 // kNone when not checked yet
 static TriState diff_a_works = kNone;
@@ -123,6 +133,26 @@ typedef enum {
   DIFF_NONE,
 } diffstyle_T;
 
+// line changes made while a diff job is running, see diff_mark_adjust()
+typedef struct {
+  int idx;
+  linenr_T line1;
+  linenr_T line2;
+  linenr_T amount;
+  linenr_T amount_after;
+} diffadjust_T;
+
+// Complete diff computed on the thread pool, see diff_update_start_job().
+struct diffjob_S {
+  tabpage_T *tp;                ///< NULL when cancelled
+  int idx_orig;
+  unsigned long xdiff_flags;
+  mmfile_t text[DB_COUNT];      ///< buffer text, ptr is NULL if not diffed
+  garray_T hunks[DB_COUNT];     ///< diffhunk_T against "idx_orig"
+  bool failed;
+  garray_T adjust;              ///< diffadjust_T since the text was copied
+};
+
 #ifdef INCLUDE_GENERATED_DECLARATIONS
 # include "diff.c.generated.h"
 #endif
@@ -137,7 +167,7 @@ void diff_buf_delete(buf_T *buf)
 
     if (i != DB_COUNT) {
       tp->tp_diffbuf[i] = NULL;
-      tp->tp_diff_invalid = true;
+      diff_set_invalid(tp);
 
       if (tp == curtab) {
         // don't redraw right away, more might change or buffer state
@@ -169,7 +199,7 @@ void diff_buf_adjust(win_T *win)
       int i = diff_buf_idx(win->w_buffer);
       if (i != DB_COUNT) {
         curtab->tp_diffbuf[i] = NULL;
-        curtab->tp_diff_invalid = true;
+        diff_set_invalid(curtab);
         diff_redraw(true);
       }
     }
@@ -197,7 +227,7 @@ void diff_buf_add(buf_T *buf)
   for (int i = 0; i < DB_COUNT; i++) {
     if (curtab->tp_diffbuf[i] == NULL) {
       curtab->tp_diffbuf[i] = buf;
-      curtab->tp_diff_invalid = true;
+      diff_set_invalid(curtab);
       diff_redraw(true);
       return;
     }
@@ -214,7 +244,7 @@ static void diff_buf_clear(void)
   for (int i = 0; i < DB_COUNT; i++) {
     if (curtab->tp_diffbuf[i] != NULL) {
       curtab->tp_diffbuf[i] = NULL;
-      curtab->tp_diff_invalid = true;
+      diff_set_invalid(curtab);
       diff_redraw(true);
     }
   }
@@ -256,7 +286,7 @@ void diff_invalidate(buf_T *buf)
   FOR_ALL_TABS(tp) {
     int i = diff_buf_idx_tp(buf, tp);
     if (i != DB_COUNT) {
-      tp->tp_diff_invalid = true;
+      diff_set_invalid(tp);
       if (tp == curtab) {
         diff_redraw(true);
       }
@@ -276,11 +306,89 @@ void diff_mark_adjust(linenr_T line1, linenr_T line2, linenr_T amount, linenr_T
   FOR_ALL_TABS(tp) {
     int idx = diff_buf_idx_tp(curbuf, tp);
     if (idx != DB_COUNT) {
+      if (tp->tp_diff_job != NULL) {
+        // Replayed on the diff blocks computed by the job.
+        GA_APPEND(diffadjust_T, &tp->tp_diff_job->adjust, ((diffadjust_T){
+          .idx = idx,
+          .line1 = line1,
+          .line2 = line2,
+          .amount = amount,
+          .amount_after = amount_after,
+        }));
+      }
       diff_mark_adjust_tp(tp, idx, line1, line2, amount, amount_after);
     }
   }
 }
 
+/// Called by changed_common(): remember which lines of "buf" changed, so
+/// that an update only needs to diff the lines around them again.
+///
+/// @param lnum  first changed line
+/// @param lnume  line below the last changed line, before the change
+/// @param xtra  number of extra lines (negative when deleting)
+void diff_changed_lines(buf_T *buf, linenr_T lnum, linenr_T lnume, linenr_T xtra)
+{
+  // last changed line after the change, for a deletion the line below it
+  const linenr_T last = MAX(lnume + xtra - 1, lnum);
+
+  FOR_ALL_TABS(tp) {
+    int idx = diff_buf_idx_tp(buf, tp);
+    if (idx == DB_COUNT) {
+      continue;
+    }
+    linenr_T *top = &tp->tp_diff_dirty_top[idx];
+    linenr_T *bot = &tp->tp_diff_dirty_bot[idx];
+    if (*top == 0) {
+      *top = lnum;
+      *bot = last;
+      continue;
+    }
+    if (*top >= lnume) {
+      *top += xtra;
+    }
+    if (*bot >= lnume) {
+      *bot += xtra;
+    }
+    *top = MAX(MIN(*top, lnum), 1);
+    *bot = MAX(*bot, last);
+  }
+}
+
+/// Mark the diffs of tab page "tp" as outdated, they are computed again for
+/// all lines when needed.
+static void diff_set_invalid(tabpage_T *tp)
+{
+  tp->tp_diff_invalid = true;
+  tp->tp_diff_incremental = false;
+  diff_cancel_update(tp);
+}
+
+/// Forget about the diff being computed for tab page "tp", if any.
+void diff_cancel_update(tabpage_T *tp)
+{
+  if (tp->tp_diff_job != NULL) {
+    tp->tp_diff_job->tp = NULL;  // freed by diff_job_done()
+    tp->tp_diff_job = NULL;
+  }
+}
+
+static void diff_clear_dirty(tabpage_T *tp)
+{
+  memset(tp->tp_diff_dirty_top, 0, sizeof(tp->tp_diff_dirty_top));
+  memset(tp->tp_diff_dirty_bot, 0, sizeof(tp->tp_diff_dirty_bot));
+}
+
+static bool diff_is_dirty(tabpage_T *tp)
+{
+  for (int i = 0; i < DB_COUNT; i++) {
+    if (tp->tp_diffbuf[i] != NULL && tp->tp_diff_dirty_top[i] != 0) {
+      return true;
+    }
+  }
+  return false;
+}
+
 /// Update line numbers in tab page "tp" for "curbuf" with index "idx".
 ///
 /// This attempts to update the changes as much as possible:
@@ -932,25 +1040,50 @@ static int diff_internal_failed(void)
   return false;
 }
 
-/// Completely update the diffs for the buffers involved.
+/// Update the diffs for the buffers involved.
 ///
 /// When using the external "diff" command the buffers are written to a file,
 /// also for unmodified buffers (the file could have been produced by
 /// autocommands, e.g. the netrw plugin).
 ///
+/// Without "eap" and with the internal diff only the lines changed since the
+/// last update are diffed again, if possible.
+///
 /// @param eap can be NULL
 void ex_diffupdate(exarg_T *eap)
+{
+  diff_update(eap, false);
+}
+
+/// Update the diffs for the current tab page before redrawing.
+///
+/// Unlike ex_diffupdate(), a large diff is computed on the thread pool.  Until
+/// it is done the current diff blocks are used, with their line numbers
+/// adjusted for the changes made.
+void diff_update_async(void)
+{
+  diff_update(NULL, true);
+}
+
+/// @param eap can be NULL
+/// @param async  may compute the diff on the thread pool
+static void diff_update(exarg_T *eap, bool async)
 {
   if (diff_busy) {
     diff_need_update = true;
     return;
   }
 
-  int had_diffs = curtab->tp_first_diff != NULL;
+  if (curtab->tp_diff_job != NULL) {
+    if (async) {
+      // Keep the current diff until the result arrives.
+      curtab->tp_diff_invalid = false;
+      return;
+    }
+    diff_cancel_update(curtab);
+  }
 
-  // Delete all diffblocks.
-  diff_clear(curtab);
-  curtab->tp_diff_invalid = false;
+  int had_diffs = curtab->tp_first_diff != NULL;
 
   // Use the first buffer as the original text.
   int idx_orig;
@@ -960,18 +1093,34 @@ void ex_diffupdate(exarg_T *eap)
     }
   }
 
-  if (idx_orig == DB_COUNT) {
-    goto theend;
+  // Only need to do something when there is another buffer.
+  int idx_new = DB_COUNT;
+  if (idx_orig != DB_COUNT) {
+    for (idx_new = idx_orig + 1; idx_new < DB_COUNT; idx_new++) {
+      if (curtab->tp_diffbuf[idx_new] != NULL) {
+        break;
+      }
+    }
   }
 
-  // Only need to do something when there is another buffer.
-  int idx_new;
-  for (idx_new = idx_orig + 1; idx_new < DB_COUNT; idx_new++) {
-    if (curtab->tp_diffbuf[idx_new] != NULL) {
-      break;
+  if (idx_new != DB_COUNT && eap == NULL
+      && diff_internal() && !diff_internal_failed()) {
+    if (diff_update_incremental(idx_orig)) {
+      curtab->tp_diff_invalid = false;
+      goto theend;
+    }
+    if (async && diff_update_start_job(idx_orig)) {
+      curtab->tp_diff_invalid = false;
+      return;
     }
   }
 
+  // Delete all diffblocks.
+  diff_clear(curtab);
+  diff_clear_dirty(curtab);
+  curtab->tp_diff_invalid = false;
+  curtab->tp_diff_incremental = false;
+
   if (idx_new == DB_COUNT) {
     goto theend;
   }
@@ -987,6 +1136,7 @@ void ex_diffupdate(exarg_T *eap)
     CLEAR_FIELD(diffio);
     diff_try_update(&diffio, idx_orig, eap);
   }
+  curtab->tp_diff_incremental = diffio.dio_internal && !diff_internal_failed();
 
   // force updating cursor position on screen
   curwin->w_valid_cursor.lnum = 0;
@@ -1000,6 +1150,282 @@ theend:
   }
 }
 
+/// Check whether diff block "dp" ends at least DIFF_INCR_CONTEXT lines above
+/// the changed lines "top" of every buffer.
+static bool diff_block_above(const diff_T *dp, const linenr_T *top)
+{
+  for (int i = 0; i < DB_COUNT; i++) {
+    if (top[i] != 0 && dp->df_lnum[i] + dp->df_count[i] + DIFF_INCR_CONTEXT > top[i]) {
+      return false;
+    }
+  }
+  return true;
+}
+
+/// Check whether diff block "dp" starts more than DIFF_INCR_CONTEXT lines
+/// below the changed lines "top" to "bot" of every buffer.
+static bool diff_block_below(const diff_T *dp, const linenr_T *top, const linenr_T *bot)
+{
+  for (int i = 0; i < DB_COUNT; i++) {
+    if (top[i] != 0 && dp->df_lnum[i] <= bot[i] + DIFF_INCR_CONTEXT) {
+      return false;
+    }
+  }
+  return true;
+}
+
+/// Update the diff blocks of the current tab page for the lines that changed
+/// since the last update, keeping the other blocks.
+///
+/// Lines between two diff blocks are equal in all buffers.  The lines between
+/// the last block above and the first block below the changed lines are
+/// diffed again and the blocks found replace the ones in between.  Since the
+/// lines at both ends are equal, the new blocks never touch the kept ones.
+/// The result is a valid diff, but not always the one a complete update
+/// finds: xdiff may align the lines differently when it sees more of them.
+///
+/// @return false if a complete update is needed.
+static bool diff_update_incremental(int idx_orig)
+{
+  tabpage_T *const tp = curtab;
+  linenr_T top[DB_COUNT];
+  linenr_T bot[DB_COUNT];
+  bool dirty = false;
+
+  if (!tp->tp_diff_incremental) {
+    return false;
+  }
+  for (int i = 0; i < DB_COUNT; i++) {
+    buf_T *buf = tp->tp_diffbuf[i];
+    top[i] = 0;
+    bot[i] = 0;
+    if (buf == NULL || tp->tp_diff_dirty_top[i] == 0) {
+      continue;
+    }
+    if (buf->b_ml.ml_mfp == NULL) {
+      return false;
+    }
+    top[i] = tp->tp_diff_dirty_top[i];
+    bot[i] = MIN(tp->tp_diff_dirty_bot[i], buf->b_ml.ml_line_count);
+    dirty = true;
+  }
+  if (!dirty) {
+    return true;
+  }
+
+  // Find the blocks around the changed lines.  Blocks split by linematch
+  // touch each other, they are diffed again as a whole.
+  diff_T *dprev = NULL;
+  for (diff_T *dp = tp->tp_first_diff; dp != NULL && diff_block_above(dp, top);
+       dp = dp->df_next) {
+    if (!dp->is_linematched) {
+      dprev = dp;
+    }
+  }
+  diff_T *dnext = dprev == NULL ? tp->tp_first_diff : dprev->df_next;
+  while (dnext != NULL && (dnext->is_linematched || !diff_block_below(dnext, top, bot))) {
+    dnext = dnext->df_next;
+  }
+
+  // Lines in between, for each buffer.
+  linenr_T start[DB_COUNT];
+  linenr_T end[DB_COUNT];
+  linenr_T total = 0;
+  for (int i = idx_orig; i < DB_COUNT; i++) {
+    buf_T *buf = tp->tp_diffbuf[i];
+    if (buf == NULL || buf->b_ml.ml_mfp == NULL) {
+      if (i == idx_orig) {
+        return false;
+      }
+      continue;
+    }
+    start[i] = dprev == NULL ? 1 : dprev->df_lnum[i] + dprev->df_count[i];
+    end[i] = dnext == NULL ? buf->b_ml.ml_line_count : dnext->df_lnum[i] - 1;
+    total += end[i] - start[i] + 1;
+  }
+  if (total >= DIFF_ASYNC_MINLINES) {
+    return false;
+  }
+
+  mmfile_t orig;
+  if (diff_write_buffer(tp->tp_diffbuf[idx_orig], &orig, start[idx_orig],
+                        end[idx_orig]) == FAIL) {
+    return false;
+  }
+  const unsigned long flags = diff_xdiff_flags();
+  garray_T hunks[DB_COUNT];
+  bool ok = true;
+  for (int i = idx_orig + 1; i < DB_COUNT; i++) {
+    ga_init(&hunks[i], sizeof(diffhunk_T), 100);
+    buf_T *buf = tp->tp_diffbuf[i];
+    if (!ok || buf == NULL || buf->b_ml.ml_mfp == NULL) {
+      continue;
+    }
+    mmfile_t new;
+    if (diff_write_buffer(buf, &new, start[i], end[i]) == FAIL) {
+      ok = false;
+      continue;
+    }
+    ok = diff_xdiff(&orig, &new, flags, &hunks[i]) == OK;
+    xfree(new.ptr);
+    // Make the line numbers relative to the start of the buffers.
+    for (int h = 0; h < hunks[i].ga_len; h++) {
+      diffhunk_T *hunk = &((diffhunk_T *)hunks[i].ga_data)[h];
+      hunk->lnum_orig += start[idx_orig] - 1;
+      hunk->lnum_new += start[i] - 1;
+    }
+  }
+  xfree(orig.ptr);
+
+  if (ok) {
+    diff_T *dp = dprev == NULL ? tp->tp_first_diff : dprev->df_next;
+    while (dp != dnext) {
+      dp = diff_free(tp, dprev, dp);
+    }
+    for (int i = idx_orig + 1; i < DB_COUNT; i++) {
+      buf_T *buf = tp->tp_diffbuf[i];
+      if (buf != NULL && buf->b_ml.ml_mfp != NULL) {
+        diff_apply_hunks(idx_orig, i, &hunks[i], dprev, dnext);
+      }
+    }
+    diff_clear_dirty(tp);
+  }
+  for (int i = idx_orig + 1; i < DB_COUNT; i++) {
+    ga_clear(&hunks[i]);
+  }
+  return ok;
+}
+
+/// Start computing the diffs of the current tab page on the thread pool, if
+/// they are large enough to be worth it.  Copies the text of the buffers, the
+/// result is used by diff_job_done().
+///
+/// @return false if the diff was not started.
+static bool diff_update_start_job(int idx_orig)
+{
+  linenr_T total = 0;
+  for (int i = idx_orig; i < DB_COUNT; i++) {
+    buf_T *buf = curtab->tp_diffbuf[i];
+    if (buf != NULL && buf->b_ml.ml_mfp != NULL) {
+      total += buf->b_ml.ml_line_count;
+    } else if (i == idx_orig) {
+      return false;
+    }
+  }
+  if (total < DIFF_ASYNC_MINLINES) {
+    return false;
+  }
+
+  diffjob_T *job = xcalloc(1, sizeof(*job));
+  job->idx_orig = idx_orig;
+  job->xdiff_flags = diff_xdiff_flags();
+  ga_init(&job->adjust, sizeof(diffadjust_T), 10);
+  for (int i = idx_orig; i < DB_COUNT; i++) {
+    ga_init(&job->hunks[i], sizeof(diffhunk_T), 100);
+    buf_T *buf = curtab->tp_diffbuf[i];
+    if (buf != NULL && buf->b_ml.ml_mfp != NULL
+        && diff_write_buffer(buf, &job->text[i], 1, -1) == FAIL) {
+      diff_job_free(job);
+      return false;
+    }
+  }
+
+  job->tp = curtab;
+  curtab->tp_diff_job = job;
+  // Lines changed from now on are diffed again when the job is done.
+  curtab->tp_diff_incremental = false;
+  diff_clear_dirty(curtab);
+  pool_submit(diff_job_work, diff_job_done, diff_job_cancel, job);
+  return true;
+}
+
+static void diff_job_free(diffjob_T *job)
+{
+  for (int i = 0; i < DB_COUNT; i++) {
+    xfree(job->text[i].ptr);
+    ga_clear(&job->hunks[i]);
+  }
+  ga_clear(&job->adjust);
+  xfree(job);
+}
+
+/// Runs on a thread pool worker.
+static void diff_job_work(void *data)
+{
+  diffjob_T *job = data;
+  mmfile_t *orig = &job->text[job->idx_orig];
+  for (int i = job->idx_orig + 1; i < DB_COUNT && !job->failed; i++) {
+    if (job->text[i].ptr != NULL
+        && diff_xdiff(orig, &job->text[i], job->xdiff_flags, &job->hunks[i]) == FAIL) {
+      job->failed = true;
+    }
+  }
+}
+
+/// Called instead of diff_job_work() and diff_job_done() when the thread pool
+/// discards the job.
+static void diff_job_cancel(void *data)
+{
+  diffjob_T *job = data;
+  if (job->tp != NULL) {
+    job->tp->tp_diff_job = NULL;
+    diff_set_invalid(job->tp);
+  }
+  diff_job_free(job);
+}
+
+/// Use the diff computed by diff_job_work() for the tab page it was started
+/// for.
+static void diff_job_done(void *data)
+{
+  diffjob_T *job = data;
+  tabpage_T *tp = job->tp;
+
+  if (tp == NULL || exiting) {
+    diff_job_free(job);
+    return;
+  }
+  tp->tp_diff_job = NULL;
+  if (job->failed || tp != curtab || diff_busy) {
+    // Update again when needed, without the thread pool, which also gives
+    // the error message.
+    diff_job_free(job);
+    diff_set_invalid(tp);
+    if (tp == curtab) {
+      redraw_later(curwin, UPD_VALID);
+    }
+    return;
+  }
+
+  int had_diffs = tp->tp_first_diff != NULL;
+  diff_clear(tp);
+  for (int i = job->idx_orig + 1; i < DB_COUNT; i++) {
+    if (job->text[i].ptr != NULL) {
+      diff_apply_hunks(job->idx_orig, i, &job->hunks[i], NULL, NULL);
+    }
+  }
+  // Move the blocks like the lines were moved meanwhile.  The changed lines
+  // themselves are diffed by the next (incremental) update.
+  for (int i = 0; i < job->adjust.ga_len; i++) {
+    diffadjust_T *adj = &((diffadjust_T *)job->adjust.ga_data)[i];
+    diff_mark_adjust_tp(tp, adj->idx, adj->line1, adj->line2, adj->amount,
+                        adj->amount_after);
+  }
+  diff_job_free(job);
+  tp->tp_diff_incremental = true;
+  if (diff_is_dirty(tp)) {
+    tp->tp_diff_invalid = true;
+  }
+
+  // force updating cursor position on screen
+  curwin->w_valid_cursor.lnum = 0;
+
+  if (had_diffs || tp->tp_first_diff != NULL) {
+    diff_redraw(true);
+    apply_autocmds(EVENT_DIFFUPDATED, NULL, NULL, false, curbuf);
+  }
+}
+
 ///
 /// Do a quick test if "diff" really works.  Otherwise it looks like there
 /// are no differences.  Can't use the return value, it's non-zero when
@@ -1093,39 +1519,55 @@ static int check_external_diff(diffio_T *diffio)
 ///
 static int diff_file_internal(diffio_T *diffio)
 {
-  xpparam_t param;
-  xdemitconf_t emit_cfg;
-  xdemitcb_t emit_cb;
-
-  CLEAR_FIELD(param);
-  CLEAR_FIELD(emit_cfg);
-  CLEAR_FIELD(emit_cb);
+  if (diff_xdiff(&diffio->dio_orig.din_mmfile, &diffio->dio_new.din_mmfile,
+                 diff_xdiff_flags(), &diffio->dio_diff.dout_ga) == FAIL) {
+    emsg(_("E960: Problem creating the internal diff"));
+    return FAIL;
+  }
+  return OK;
+}
 
-  param.flags = (unsigned long)diff_algorithm;
+/// Get the xdiff flags for the current 'diffopt'.
+static unsigned long diff_xdiff_flags(void)
+{
+  unsigned long flags = (unsigned long)diff_algorithm;
 
   if (diff_flags & DIFF_IWHITE) {
-    param.flags |= XDF_IGNORE_WHITESPACE_CHANGE;
+    flags |= XDF_IGNORE_WHITESPACE_CHANGE;
   }
   if (diff_flags & DIFF_IWHITEALL) {
-    param.flags |= XDF_IGNORE_WHITESPACE;
+    flags |= XDF_IGNORE_WHITESPACE;
   }
   if (diff_flags & DIFF_IWHITEEOL) {
-    param.flags |= XDF_IGNORE_WHITESPACE_AT_EOL;
+    flags |= XDF_IGNORE_WHITESPACE_AT_EOL;
   }
   if (diff_flags & DIFF_IBLANK) {
-    param.flags |= XDF_IGNORE_BLANK_LINES;
+    flags |= XDF_IGNORE_BLANK_LINES;
   }
+  return flags;
+}
+
+/// Diff "orig" and "new" with the internal diff library and append the hunks
+/// to "hunks".  Does not use any global state, may be called from a thread
+/// pool worker.
+///
+/// @return OK or FAIL
+static int diff_xdiff(mmfile_t *orig, mmfile_t *new, unsigned long flags, garray_T *hunks)
+{
+  xpparam_t param;
+  xdemitconf_t emit_cfg;
+  xdemitcb_t emit_cb;
+
+  CLEAR_FIELD(param);
+  CLEAR_FIELD(emit_cfg);
+  CLEAR_FIELD(emit_cb);
+
+  param.flags = flags;
 
   emit_cfg.ctxlen = 0;  // don't need any diff_context here
-  emit_cb.priv = &diffio->dio_diff;
+  emit_cb.priv = hunks;
   emit_cfg.hunk_func = xdiff_out;
-  if (xdl_diff(&diffio->dio_orig.din_mmfile,
-               &diffio->dio_new.din_mmfile,
-               &param, &emit_cfg, &emit_cb) < 0) {
-    emsg(_("E960: Problem creating the internal diff"));
-    return FAIL;
-  }
-  return OK;
+  return xdl_diff(orig, new, &param, &emit_cfg, &emit_cb) < 0 ? FAIL : OK;
 }
 
 /// Make a diff between files "tmp_orig" and "tmp_new", results in "tmp_diff".
@@ -1537,6 +1979,8 @@ void ex_diffoff(exarg_T *eap)
     diff_need_update = false;
     curtab->tp_diff_invalid = false;
     curtab->tp_diff_update = false;
+    curtab->tp_diff_incremental = false;
+    diff_cancel_update(curtab);
     diff_clear(curtab);
   }
 
@@ -1773,6 +2217,30 @@ static void diff_read(int idx_orig, int idx_new, diffio_T *dio)
   }
 }
 
+/// Add the hunks found between buffers "idx_orig" and "idx_new" to the diff
+/// blocks after "dprev" (NULL for the start of the list) and before "dend"
+/// (NULL for the end of the list).
+static void diff_apply_hunks(int idx_orig, int idx_new, garray_T *hunks, diff_T *dprev,
+                             diff_T *dend)
+{
+  diff_T *dp = dprev == NULL ? curtab->tp_first_diff : dprev->df_next;
+  bool notset = true;  // block "*dp" not set yet
+
+  for (int i = 0; i < hunks->ga_len; i++) {
+    process_hunk(&dp, &dprev, idx_orig, idx_new, &((diffhunk_T *)hunks->ga_data)[i], &notset);
+  }
+
+  // for remaining diff blocks orig and new are equal
+  while (dp != dend) {
+    if (notset) {
+      diff_copy_entry(dprev, dp, idx_orig, idx_new);
+    }
+    dprev = dp;
+    dp = dp->df_next;
+    notset = true;
+  }
+}
+
 /// Copy an entry at "dp" from "idx_orig" to "idx_new".
 ///
 /// @param dprev
@@ -2083,7 +2551,8 @@ static void run_linematch_algorithm(diff_T *dp)
   // of integers (*decisions) and the length of that array (decisions_length)
   int *decisions = NULL;
   const bool iwhite = (diff_flags & (DIFF_IWHITEALL | DIFF_IWHITE)) > 0;
-  size_t decisions_length = linematch_nbuffers(diffbufs, diff_length, ndiffs, &decisions, iwhite);
+  size_t decisions_length = linematch_nbuffers(diffbufs, diff_length, ndiffs, &decisions, iwhite,
+                                                LINEMATCH_BUDGET);
 
   for (size_t i = 0; i < ndiffs; i++) {
     XFREE_CLEAR(diffbufs_mm[i].ptr);
@@ -2114,7 +2583,7 @@ int diff_check_with_linestatus(win_T *wp, linenr_T lnum, int *linestatus)
 
   if (curtab->tp_diff_invalid) {
     // update after a big change
-    ex_diffupdate(NULL);
+    diff_update_async();
   }
 
   // no diffs at all
@@ -2557,7 +3026,7 @@ int diffopt_changed(void)
   // update the diff.
   if (diff_flags != diff_flags_new || diff_algorithm != diff_algorithm_new) {
     FOR_ALL_TABS(tp) {
-      tp->tp_diff_invalid = true;
+      diff_set_invalid(tp);
     }
   }
 
@@ -2924,6 +3393,11 @@ void ex_diffgetput(exarg_T *eap)
     }
   }
 
+  // Don't use diff blocks that are only adjusted while a diff is computed.
+  if (curtab->tp_diff_job != NULL) {
+    ex_diffupdate(NULL);
+  }
+
   diff_busy = true;
 
   // When no range given include the line above or below the cursor.
@@ -3504,8 +3978,8 @@ static int parse_diff_unified(char *line, diffhunk_T *hunk)
 ///
 static int xdiff_out(long start_a, long count_a, long start_b, long count_b, void *priv)
 {
-  diffout_T *dout = (diffout_T *)priv;
-  GA_APPEND(diffhunk_T, &(dout->dout_ga), ((diffhunk_T){
+  garray_T *hunks = (garray_T *)priv;
+  GA_APPEND(diffhunk_T, hunks, ((diffhunk_T){
     .lnum_orig  = (linenr_T)start_a + 1,
     .count_orig = count_a,
     .lnum_new   = (linenr_T)start_b + 1,
@@ -487,6 +487,21 @@ static bool check_mb_utf8(int *c, int *u8cc)
   return false;
 }
 
+/// Allocates a buffer for "p_extra", from the redraw arena during a redraw.
+/// Pass it to set_extra_free() when the previous buffer is not used anymore.
+static char *alloc_extra(size_t size)
+{
+  return arena_alloc(arena_scope_get(&redraw_scope), size, false);
+}
+
+/// Frees the previous buffer of "p_extra" and keeps "p" in "*p_extra_free"
+/// if it must be freed, i.e. it was not allocated from the redraw arena.
+static void set_extra_free(char **p_extra_free, char *p)
+{
+  xfree(*p_extra_free);
+  *p_extra_free = arena_scope_get(&redraw_scope) == NULL ? p : NULL;
+}
+
 /// Display line "lnum" of window 'wp' on the screen.
 /// wp->w_virtcol needs to be valid.
 ///
@@ -1132,11 +1147,10 @@ int win_line(win_T *wp, linenr_T lnum, int startrow, int endrow, bool nochange,
         if (fdc > 0) {
           // Draw the 'foldcolumn'.  Allocate a buffer, "extra" may
           // already be in use.
-          xfree(p_extra_free);
-          p_extra_free = xmalloc(MAX_MCO * (size_t)fdc + 1);
-          n_extra = (int)fill_foldcolumn((char_u *)p_extra_free, wp, foldinfo, lnum);
-          p_extra_free[n_extra] = NUL;
-          p_extra = p_extra_free;
+          p_extra = alloc_extra(MAX_MCO * (size_t)fdc + 1);
+          set_extra_free(&p_extra_free, p_extra);
+          n_extra = (int)fill_foldcolumn((char_u *)p_extra, wp, foldinfo, lnum);
+          p_extra[n_extra] = NUL;
           c_extra = NUL;
           c_final = NUL;
           if (use_cursor_line_sign(wp, lnum)) {
@@ -1975,11 +1989,11 @@ int win_line(win_T *wp, linenr_T lnum, int startrow, int endrow, bool nochange,
               len += n_extra - tab_len;
             }
             c = wp->w_p_lcs_chars.tab1;
-            p = xmalloc((size_t)len + 1);
+            char *tab_extra = alloc_extra((size_t)len + 1);
+            p = (char_u *)tab_extra;
             memset(p, ' ', (size_t)len);
             p[len] = NUL;
-            xfree(p_extra_free);
-            p_extra_free = (char *)p;
+            set_extra_free(&p_extra_free, tab_extra);
             for (i = 0; i < tab_len; i++) {
               if (*p == NUL) {
                 tab_len = i;
@@ -1994,7 +2008,7 @@ int win_line(win_T *wp, linenr_T lnum, int startrow, int endrow, bool nochange,
               p += utf_char2bytes(lcs, (char *)p);
               n_extra += utf_char2len(lcs) - (saved_nextra > 0 ? 1 : 0);
             }
-            p_extra = p_extra_free;
+            p_extra = tab_extra;
 
             // n_extra will be increased by FIX_FOX_BOGUSCOLS
             // macro below, so need to adjust for that here
@@ -2096,14 +2110,14 @@ int win_line(win_T *wp, linenr_T lnum, int startrow, int endrow, bool nochange,
             char_u *p;
 
             c = (uint8_t)(*p_extra);
-            p = xmalloc((size_t)n_extra + 1);
+            p = (char_u *)alloc_extra((size_t)n_extra + 1);
             memset(p, ' ', (size_t)n_extra);
             strncpy((char *)p,  // NOLINT(runtime/printf)
                     p_extra + 1,
                     (size_t)strlen(p_extra) - 1);
             p[n_extra] = NUL;
-            xfree(p_extra_free);
-            p_extra_free = p_extra = (char *)p;
+            set_extra_free(&p_extra_free, (char *)p);
+            p_extra = (char *)p;
           } else {
             n_extra = byte2cells(c) - 1;
             c = (uint8_t)(*p_extra++);
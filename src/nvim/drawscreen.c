@@ -82,6 +82,7 @@
 #include "nvim/match.h"
 #include "nvim/mbyte.h"
 #include "nvim/memline.h"
+#include "nvim/memory.h"
 #include "nvim/message.h"
 #include "nvim/move.h"
 #include "nvim/normal.h"
@@ -405,6 +406,8 @@ int update_screen(void)
   must_redraw = 0;
 
   updating_screen = 1;
+  const char *save_subsystem = profile_sample_enter("redraw");
+  ArenaMark redraw_mark = arena_scope_enter(&redraw_scope);
 
   display_tick++;  // let syntax code know we're in a next round of
                    // display updating
@@ -609,6 +612,7 @@ int update_screen(void)
   }
 
   updating_screen = 0;
+  profile_sample_leave(save_subsystem);
 
   // Clear or redraw the command line.  Done last, because scrolling may
   // mess up the command line.
@@ -627,6 +631,7 @@ int update_screen(void)
 
   // either cmdline is cleared, not drawn or mode is last drawn
   cmdline_was_last_drawn = false;
+  arena_scope_leave(&redraw_scope, redraw_mark);
   return OK;
 }
 
@@ -65,6 +65,7 @@
 #include "nvim/os/os.h"
 #include "nvim/os/shell.h"
 #include "nvim/os/stdpaths_defs.h"
+#include "nvim/os/time.h"
 #include "nvim/path.h"
 #include "nvim/pos.h"
 #include "nvim/profile.h"
@@ -298,6 +299,8 @@ static partial_T *vvlua_partial;
 static uint64_t last_timer_id = 1;
 static PMap(uint64_t) timers = MAP_INIT;
 
+static GcStats gc_stats;
+
 static const char *const msgpack_type_names[] = {
   [kMPNil] = "nil",
   [kMPBoolean] = "boolean",
@@ -3953,6 +3956,8 @@ void partial_unref(partial_T *pt)
 {
   if (pt != NULL && --pt->pt_refcount <= 0) {
     partial_free(pt);
+  } else if (pt != NULL) {
+    gc_candidates++;
   }
 }
 
@@ -4093,6 +4098,8 @@ int get_copyID(void)
 bool garbage_collect(bool testing)
 {
   bool abort = false;
+  const uint64_t start = os_hrtime();
+  const char *save_subsystem = profile_sample_enter("garbage_collect");
 #define ABORTING(func) abort = abort || func
 
   if (!testing) {
@@ -4291,13 +4298,39 @@ bool garbage_collect(bool testing)
     // 3. Check if any funccal can be freed now.
     //    This may call us back recursively.
     did_free = free_unref_funccal(copyID, testing) || did_free;
+
+    // Freeing unreferences the items that were kept alive by the garbage.
+    gc_candidates = 0;
   } else if (p_verbose > 0) {
     verb_msg(_("Not enough memory to set references, garbage collection aborted!"));
   }
 #undef ABORTING
+  profile_sample_leave(save_subsystem);
+  histogram_record(&gc_stats.pause, os_hrtime() - start);
   return did_free;
 }
 
+/// Do garbage collection while waiting for input, see before_blocking().
+///
+/// Skipped when nothing was unreferenced since the last collection: then no
+/// unreachable cycle can have appeared and a full collection would only cost
+/// a pause proportional to all the lists and dicts in use.
+void garbage_collect_idle(void)
+{
+  if (gc_candidates == 0 && !want_garbage_collect) {
+    gc_stats.skipped++;
+    return;
+  }
+  garbage_collect(false);
+}
+
+/// Gets the statistics of garbage collection.
+const GcStats *gc_get_stats(void)
+  FUNC_ATTR_PURE
+{
+  return &gc_stats;
+}
+
 /// Free lists and dictionaries that are no longer referenced.
 ///
 /// @note  This function may only be called from garbage_collect().
@@ -7209,6 +7242,7 @@ void new_script_vars(scid_T id)
     hashtab_T *ht = &SCRIPT_VARS(i);
     if (ht->ht_mask == HT_INIT_SIZE - 1) {
       ht->ht_array = ht->ht_smallarray;
+      ht->ht_ctrl = ht->ht_smallctrl;
     }
     sv = SCRIPT_SV(i);
     sv->sv_var.di_tv.vval.v_dict = &sv->sv_dict;
@@ -3,6 +3,7 @@
 
 #include <stdbool.h>
 #include <stddef.h>
+#include <stdint.h>
 
 #include "nvim/buffer_defs.h"
 #include "nvim/channel.h"
@@ -10,6 +11,7 @@
 #include "nvim/event/time.h"
 #include "nvim/ex_cmds_defs.h"
 #include "nvim/hashtab.h"
+#include "nvim/histogram.h"
 #include "nvim/os/fileio.h"
 #include "nvim/os/stdpaths_defs.h"
 
@@ -260,6 +262,12 @@ typedef enum {
 
 typedef int (*ex_unletlock_callback)(lval_T *, char *, exarg_T *, int);
 
+/// Statistics of garbage_collect().
+typedef struct {
+  Histogram pause;  ///< duration of each collection, in nanoseconds
+  uint64_t skipped;  ///< collections skipped by garbage_collect_idle()
+} GcStats;
+
 // Used for checking if local variables or arguments used in a lambda.
 extern bool *eval_lavars_used;
 
@@ -20,6 +20,7 @@
 #include "nvim/garray.h"
 #include "nvim/gettext.h"
 #include "nvim/hashtab.h"
+#include "nvim/json_scan.h"
 #include "nvim/macros.h"
 #include "nvim/mbyte.h"
 #include "nvim/memory.h"
@@ -333,8 +334,17 @@ static inline int parse_json_string(const char *const buf, const size_t buf_len,
   size_t len = 0;
   const char *const s = ++p;
   int ret = OK;
+  bool has_escape = false;
   while (p < e && *p != '"') {
+    // Printable ASCII needs no checks: skip all of it at once.
+    const size_t plain_len = json_plain_len(p, (size_t)(e - p), true);
+    if (plain_len > 0) {
+      len += plain_len;
+      p += plain_len;
+      continue;
+    }
     if (*p == '\\') {
+      has_escape = true;
       p++;
       if (p == e) {
         semsg(_("E474: Unfinished escape sequence: %.*s"),
@@ -416,6 +426,15 @@ static inline int parse_json_string(const char *const buf, const size_t buf_len,
     }), false);
     goto parse_json_string_ret;
   }
+  if (!has_escape) {
+    // Nothing to convert: the string is the source text.
+    typval_T obj = decode_string(s, len, kFalse, false, false);
+    if (obj.v_type == VAR_UNKNOWN) {
+      goto parse_json_string_fail;
+    }
+    POP(obj, obj.v_type != VAR_STRING);
+    goto parse_json_string_ret;
+  }
   char *str = xmalloc(len + 1);
   int fst_in_pair = 0;
   char *str_end = str;
@@ -484,7 +503,12 @@ static inline int parse_json_string(const char *const buf, const size_t buf_len,
         abort();
       }
     } else {
-      *str_end++ = *t;
+      // Copy everything up to the next escape at once.
+      const char *const esc = memchr(t, '\\', (size_t)(p - t));
+      const size_t run_len = (size_t)((esc != NULL ? esc : p) - t);
+      memcpy(str_end, t, run_len);
+      str_end += run_len;
+      t += run_len - 1;
     }
   }
   PUT_FST_IN_PAIR(fst_in_pair, str_end);
@@ -604,6 +628,13 @@ parse_json_number_check:
             (int)exp_num_len, s, num_len, exp_num_len);
     }
     tv.v_type = VAR_FLOAT;
+  } else if (p - ints <= 18) {
+    // Convert integer that cannot overflow without going through vim_str2nr()
+    varnumber_T nr = 0;
+    for (const char *d = ints; d < p; d++) {
+      nr = nr * 10 + (*d - '0');
+    }
+    tv.vval.v_number = (*s == '-' ? -nr : nr);
   } else {
     // Convert integer
     varnumber_T nr;
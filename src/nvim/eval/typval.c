@@ -341,6 +341,8 @@ void tv_list_unref(list_T *const l)
 {
   if (l != NULL && --l->lv_refcount <= 0) {
     tv_list_free(l);
+  } else if (l != NULL) {
+    gc_candidates++;
   }
 }
 
@@ -2007,6 +2009,8 @@ void tv_dict_unref(dict_T *const d)
 {
   if (d != NULL && --d->dv_refcount <= 0) {
     tv_dict_free(d);
+  } else if (d != NULL) {
+    gc_candidates++;
   }
 }
 
@@ -3013,6 +3017,7 @@ static inline int _nothing_conv_func_start(typval_T *const tv, char_u *const fun
     partial_T *const pt_ = tv->vval.v_partial;
     if (pt_ != NULL && pt_->pt_refcount > 1) {
       pt_->pt_refcount--;
+      gc_candidates++;
       tv->vval.v_partial = NULL;
       return OK;
     }
@@ -3087,6 +3092,7 @@ static inline int _nothing_conv_real_list_after_start(typval_T *const tv,
   tv->v_lock = VAR_UNLOCKED;
   if (tv->vval.v_list->lv_refcount > 1) {
     tv->vval.v_list->lv_refcount--;
+    gc_candidates++;
     tv->vval.v_list = NULL;
     mpsv->data.l.li = NULL;
     return OK;
@@ -3127,6 +3133,7 @@ static inline int _nothing_conv_real_dict_after_start(typval_T *const tv, dict_T
   }
   if ((const void *)dictp != nodictvar && (*dictp)->dv_refcount > 1) {
     (*dictp)->dv_refcount--;
+    gc_candidates++;
     *dictp = NULL;
     mpsv->data.d.todo = 0;
     return OK;
@@ -277,7 +277,7 @@ typedef struct {
 enum { MAX_FUNC_ARGS = 20, };
 /// Short variable name length
 enum { VAR_SHORT_LEN = 20, };
-/// Number of fixed variables used for arguments
+/// Number of fixed variables used for arguments and local variables
 enum { FIXVAR_CNT = 12, };
 
 /// Structure to hold info for a function that is currently being executed.
@@ -287,8 +287,9 @@ struct funccall_S {
   ufunc_T *func;  ///< Function being called.
   int linenr;  ///< Next line to be executed.
   int returned;  ///< ":return" used.
-  /// Fixed variables for arguments.
+  /// Fixed variables for arguments and the first local variables.
   TV_DICTITEM_STRUCT(VAR_SHORT_LEN + 1) fixvar[FIXVAR_CNT];
+  int fixvar_idx;  ///< Next unused entry in "fixvar".
   dict_T l_vars;  ///< l: local function variables.
   ScopeDictDictItem l_vars_var;  ///< Variable for l: scope.
   dict_T l_avars;  ///< a: argument variables.
@@ -307,6 +308,23 @@ struct funccall_S {
   garray_T fc_funcs;  ///< List of ufunc_T* which keep a reference to "func".
 };
 
+/// Command of a function line, parsed when the line is first executed.
+///
+/// Only lines starting with a built-in command without modifiers or range are
+/// cached, see do_one_cmd().
+typedef struct {
+  int ul_cmdidx;   ///< cmdidx_T of the command, or one of the UL_ values
+  int ul_flags;    ///< EXFLAG_ flags set by find_ex_command()
+  int ul_cmd_off;  ///< byte offset of the command name in the line
+  int ul_arg_off;  ///< byte offset of the text after the command name
+} ufunc_line_T;
+
+/// Values for ul_cmdidx that are not a command.
+enum {
+  UL_NOT_PARSED = -1,  ///< line was not executed yet
+  UL_NO_CACHE = -2,  ///< line cannot be cached
+};
+
 /// Structure to hold info for a user function.
 struct ufunc {
   int uf_varargs;       ///< variable nr of arguments
@@ -316,6 +334,7 @@ struct ufunc {
   garray_T uf_args;          ///< arguments
   garray_T uf_def_args;      ///< default argument expressions
   garray_T uf_lines;         ///< function lines
+  ufunc_line_T *uf_line_cmds;  ///< parsed commands of "uf_lines" or NULL
   int uf_profiling;     ///< true when func is being profiled
   int uf_prof_initialized;
   LuaRef uf_luaref;      ///< lua callback, used if (uf_flags & FC_LUAREF)
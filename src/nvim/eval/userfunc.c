@@ -64,6 +64,11 @@ static funccall_T *current_funccal = NULL;
 // item in it is still being used.
 static funccall_T *previous_funccal = NULL;
 
+// Freed funccall_T structs, linked with "caller", for reuse by the next calls.
+#define FUNCCAL_FREE_MAX 32
+static funccall_T *funccal_free_list = NULL;
+static int funccal_free_count = 0;
+
 static char *e_funcexts = N_("E122: Function %s already exists, add ! to replace it");
 static char *e_funcdict = N_("E717: Dictionary entry already exists");
 static char *e_funcref = N_("E718: Funcref required");
@@ -633,7 +638,26 @@ static void free_funccal(funccall_T *fc)
   ga_clear(&fc->fc_funcs);
 
   func_ptr_unref(fc->func);
-  xfree(fc);
+  if (funccal_free_count < FUNCCAL_FREE_MAX) {
+    fc->caller = funccal_free_list;
+    funccal_free_list = fc;
+    funccal_free_count++;
+  } else {
+    xfree(fc);
+  }
+}
+
+/// Allocate a cleared funccall_T, reusing a freed one if possible.
+static funccall_T *funccal_alloc(void)
+{
+  funccall_T *fc = funccal_free_list;
+  if (fc == NULL) {
+    return xcalloc(1, sizeof(funccall_T));
+  }
+  funccal_free_list = fc->caller;
+  funccal_free_count--;
+  memset(fc, 0, sizeof(*fc));
+  return fc;
 }
 
 /// Free "fc" and what it contains.
@@ -707,6 +731,7 @@ static void cleanup_function_call(funccall_T *fc)
     // Link "fc" in the list for garbage collection later.
     fc->caller = previous_funccal;
     previous_funccal = fc;
+    gc_candidates++;
 
     if (want_garbage_collect) {
       // If garbage collector is ready, clear count.
@@ -736,6 +761,7 @@ static void funccal_unref(funccall_T *fc, ufunc_T *fp, bool force)
   }
 
   fc->fc_refcount--;
+  gc_candidates++;
   if (force ? fc->fc_refcount <= 0 : !fc_referenced(fc)) {
     for (pfc = &previous_funccal; *pfc != NULL; pfc = &(*pfc)->caller) {
       if (fc == *pfc) {
@@ -773,6 +799,7 @@ static void func_clear_items(ufunc_T *fp)
   ga_clear_strings(&(fp->uf_args));
   ga_clear_strings(&(fp->uf_def_args));
   ga_clear_strings(&(fp->uf_lines));
+  XFREE_CLEAR(fp->uf_line_cmds);
   XFREE_CLEAR(fp->uf_name_exp);
 
   if (fp->uf_flags & FC_LUAREF) {
@@ -842,7 +869,6 @@ void call_user_func(ufunc_T *fp, int argcount, typval_T *argvars, typval_T *rett
   int save_did_emsg;
   static int depth = 0;
   dictitem_T *v;
-  int fixvar_idx = 0;           // index in fixvar[]
   int ai;
   bool islambda = false;
   char_u numbuf[NUMBUFLEN];
@@ -873,7 +899,7 @@ void call_user_func(ufunc_T *fp, int argcount, typval_T *argvars, typval_T *rett
   // check for CTRL-C hit
   line_breakcheck();
   // prepare the funccall_T structure
-  fc = xcalloc(1, sizeof(funccall_T));
+  fc = funccal_alloc();
   fc->caller = current_funccal;
   current_funccal = fc;
   fc->func = fp;
@@ -900,7 +926,7 @@ void call_user_func(ufunc_T *fp, int argcount, typval_T *argvars, typval_T *rett
   if (selfdict != NULL) {
     // Set l:self to "selfdict".  Use "name" to avoid a warning from
     // some compiler that checks the destination size.
-    v = (dictitem_T *)&fc->fixvar[fixvar_idx++];
+    v = (dictitem_T *)&fc->fixvar[fc->fixvar_idx++];
 #ifndef __clang_analyzer__
     name = (char *)v->di_key;
     STRCPY(name, "self");
@@ -918,7 +944,7 @@ void call_user_func(ufunc_T *fp, int argcount, typval_T *argvars, typval_T *rett
   // Set a:000 to a list with room for the "..." arguments.
   init_var_dict(&fc->l_avars, &fc->l_avars_var, VAR_SCOPE);
   if ((fp->uf_flags & FC_NOARGS) == 0) {
-    add_nr_var(&fc->l_avars, (dictitem_T *)&fc->fixvar[fixvar_idx++], "0",
+    add_nr_var(&fc->l_avars, (dictitem_T *)&fc->fixvar[fc->fixvar_idx++], "0",
                (varnumber_T)(argcount >= fp->uf_args.ga_len
                              ? argcount - fp->uf_args.ga_len : 0));
   }
@@ -926,7 +952,7 @@ void call_user_func(ufunc_T *fp, int argcount, typval_T *argvars, typval_T *rett
   if ((fp->uf_flags & FC_NOARGS) == 0) {
     // Use "name" to avoid a warning from some compiler that checks the
     // destination size.
-    v = (dictitem_T *)&fc->fixvar[fixvar_idx++];
+    v = (dictitem_T *)&fc->fixvar[fc->fixvar_idx++];
 #ifndef __clang_analyzer__
     name = (char *)v->di_key;
     STRCPY(name, "000");
@@ -945,9 +971,9 @@ void call_user_func(ufunc_T *fp, int argcount, typval_T *argvars, typval_T *rett
   // Set a:N to the "..." arguments.
   // Skipped when no a: variables used (in lambda).
   if ((fp->uf_flags & FC_NOARGS) == 0) {
-    add_nr_var(&fc->l_avars, (dictitem_T *)&fc->fixvar[fixvar_idx++],
+    add_nr_var(&fc->l_avars, (dictitem_T *)&fc->fixvar[fc->fixvar_idx++],
                "firstline", (varnumber_T)firstline);
-    add_nr_var(&fc->l_avars, (dictitem_T *)&fc->fixvar[fixvar_idx++],
+    add_nr_var(&fc->l_avars, (dictitem_T *)&fc->fixvar[fc->fixvar_idx++],
                "lastline", (varnumber_T)lastline);
   }
   bool default_arg_err = false;
@@ -987,8 +1013,8 @@ void call_user_func(ufunc_T *fp, int argcount, typval_T *argvars, typval_T *rett
       snprintf((char *)numbuf, sizeof(numbuf), "%d", ai + 1);
       name = (char *)numbuf;
     }
-    if (fixvar_idx < FIXVAR_CNT && strlen(name) <= VAR_SHORT_LEN) {
-      v = (dictitem_T *)&fc->fixvar[fixvar_idx++];
+    if (fc->fixvar_idx < FIXVAR_CNT && strlen(name) <= VAR_SHORT_LEN) {
+      v = (dictitem_T *)&fc->fixvar[fc->fixvar_idx++];
       v->di_flags = DI_FLAGS_RO | DI_FLAGS_FIX;
     } else {
       v = xmalloc(sizeof(dictitem_T) + strlen(name));
@@ -1357,6 +1383,13 @@ void free_all_functions(void)
   if (skipped == 0) {
     hash_clear(&func_hashtab);
   }
+
+  while (funccal_free_list != NULL) {
+    funccall_T *fc = funccal_free_list;
+    funccal_free_list = fc->caller;
+    xfree(fc);
+  }
+  funccal_free_count = 0;
 }
 
 #endif
@@ -3292,6 +3325,47 @@ int func_has_abort(void *cookie)
   return ((funccall_T *)cookie)->func->uf_flags & FC_ABORT;
 }
 
+/// Gets an unused fixed variable of the current function call for a new l:
+/// variable, so that it doesn't need to be allocated.
+///
+/// @param ht  hashtab the variable is added to.
+///
+/// @return  NULL if "ht" is not the l: scope of the current function or there
+///          is no fixed variable left for "name".
+dictitem_T *funccal_local_fixvar(const hashtab_T *ht, const char *name)
+{
+  if (current_funccal == NULL) {
+    return NULL;
+  }
+  funccall_T *fc = get_funccal();
+  if (ht != &fc->l_vars.dv_hashtab || fc->fixvar_idx >= FIXVAR_CNT
+      || strlen(name) > VAR_SHORT_LEN) {
+    return NULL;
+  }
+  return (dictitem_T *)&fc->fixvar[fc->fixvar_idx++];
+}
+
+/// Gets the parsed command of a line of the function executed with "cookie".
+/// The cache is dropped when the function is redefined.
+///
+/// @param lnum  line number in the function, as set by get_func_line().
+///
+/// @return  NULL if "lnum" is not a line of the function.
+ufunc_line_T *func_line_cmd(void *cookie, linenr_T lnum)
+{
+  ufunc_T *fp = ((funccall_T *)cookie)->func;
+  if (lnum < 1 || lnum > fp->uf_lines.ga_len) {
+    return NULL;
+  }
+  if (fp->uf_line_cmds == NULL) {
+    fp->uf_line_cmds = xmalloc((size_t)fp->uf_lines.ga_len * sizeof(*fp->uf_line_cmds));
+    for (int i = 0; i < fp->uf_lines.ga_len; i++) {
+      fp->uf_line_cmds[i].ul_cmdidx = UL_NOT_PARSED;
+    }
+  }
+  return &fp->uf_line_cmds[lnum - 1];
+}
+
 /// Turn "dict.Func" into a partial for "Func" bound to "dict".
 /// Changes "rettv" in-place.
 void make_partial(dict_T *const selfdict, typval_T *const rettv)
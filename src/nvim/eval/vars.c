@@ -1168,7 +1168,9 @@ void delete_var(hashtab_T *ht, hashitem_T *hi)
 
   hash_remove(ht, hi);
   tv_clear(&di->di_tv);
-  xfree(di);
+  if (di->di_flags & DI_FLAGS_ALLOC) {
+    xfree(di);
+  }
 }
 
 /// List the value of one internal variable.
@@ -1341,13 +1343,20 @@ void set_var_const(const char *name, const size_t name_len, typval_T *const tv,
     // Make sure dict is valid
     assert(dict != NULL);
 
-    v = xmalloc(sizeof(dictitem_T) + strlen(varname));
+    // A local variable of a function may not need to be allocated.
+    v = funccal_local_fixvar(ht, varname);
+    const bool fixvar = v != NULL;
+    if (!fixvar) {
+      v = xmalloc(sizeof(dictitem_T) + strlen(varname));
+    }
     STRCPY(v->di_key, varname);
     if (hash_add(ht, (char *)v->di_key) == FAIL) {
-      xfree(v);
+      if (!fixvar) {
+        xfree(v);
+      }
       return;
     }
-    v->di_flags = DI_FLAGS_ALLOC;
+    v->di_flags = fixvar ? 0 : DI_FLAGS_ALLOC;
     if (is_const) {
       v->di_flags |= DI_FLAGS_LOCK;
     }
@@ -9,6 +9,7 @@
 typedef void (*argv_callback)(void **argv);
 typedef struct message {
   argv_callback handler;
+  const char *name;  ///< handler name, for event loop statistics
   void *argv[EVENT_HANDLER_MAX_ARGC];
 } Event;
 typedef void (*event_scheduler)(Event event, void *data);
@@ -17,6 +18,7 @@ typedef void (*event_scheduler)(Event event, void *data);
   do { \
     assert(a <= EVENT_HANDLER_MAX_ARGC); \
     (event)->handler = h; \
+    (event)->name = NULL; \
     if (a) { \
       va_list args; \
       va_start(args, a); \
@@ -27,11 +29,15 @@ typedef void (*event_scheduler)(Event event, void *data);
     } \
   } while (0)
 
-static inline Event event_create(argv_callback cb, int argc, ...)
+/// Creates an Event, recording the name of the handler for statistics.
+#define event_create(cb, ...) event_create_named(#cb, cb, __VA_ARGS__)
+
+static inline Event event_create_named(const char *name, argv_callback cb, int argc, ...)
 {
   assert(argc <= EVENT_HANDLER_MAX_ARGC);
   Event event;
   VA_EVENT_INIT(&event, cb, argc);
+  event.name = name;
   return event;
 }
 
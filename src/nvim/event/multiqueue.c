@@ -44,6 +44,11 @@
 // the event loop queue and poll job1 queue instead. Same with channels, when
 // calling `rpcrequest` we want to temporarily stop processing events from
 // other sources and focus on a specific channel.
+//
+// Queues with a MultiQueueKind other than kMultiQueueUntracked also feed the
+// event loop statistics (see event/stats.c): every pushed item is stamped with
+// the time it was queued, so that the wait time, the handler run time and the
+// queue depth can be recorded when it is consumed.
 
 #include <assert.h>
 #include <stdbool.h>
@@ -52,8 +57,10 @@
 
 #include "nvim/event/defs.h"
 #include "nvim/event/multiqueue.h"
+#include "nvim/event/stats.h"
 #include "nvim/lib/queue.h"
 #include "nvim/memory.h"
+#include "nvim/os/time.h"
 
 typedef struct multiqueue_item MultiQueueItem;
 struct multiqueue_item {
@@ -62,6 +69,7 @@ struct multiqueue_item {
     struct {
       Event event;
       MultiQueueItem *parent_item;
+      uint64_t queued;  // os_hrtime() at push, only set for tracked queues
     } item;
   } data;
   bool link;  // true: current item is just a link to a node in a child queue
@@ -74,6 +82,7 @@ struct multiqueue {
   PutCallback put_cb;
   void *data;
   size_t size;
+  MultiQueueKind kind;
 };
 
 typedef struct {
@@ -109,9 +118,19 @@ static MultiQueue *multiqueue_new(MultiQueue *parent, PutCallback put_cb, void *
   rv->parent = parent;
   rv->put_cb = put_cb;
   rv->data = data;
+  rv->kind = parent ? parent->kind : kMultiQueueUntracked;
   return rv;
 }
 
+/// Sets the statistics category of a queue.
+///
+/// Child queues created afterwards inherit the kind.
+void multiqueue_set_kind(MultiQueue *this, MultiQueueKind kind)
+  FUNC_ATTR_NONNULL_ALL
+{
+  this->kind = kind;
+}
+
 void multiqueue_free(MultiQueue *this)
 {
   assert(this);
@@ -132,7 +151,7 @@ void multiqueue_free(MultiQueue *this)
 /// Removes the next item and returns its Event.
 Event multiqueue_get(MultiQueue *this)
 {
-  return multiqueue_empty(this) ? NILEVENT : multiqueue_remove(this);
+  return multiqueue_empty(this) ? NILEVENT : multiqueue_remove(this, NULL, NULL);
 }
 
 void multiqueue_put_event(MultiQueue *this, Event event)
@@ -148,10 +167,26 @@ void multiqueue_process_events(MultiQueue *this)
 {
   assert(this);
   while (!multiqueue_empty(this)) {
-    Event event = multiqueue_remove(this);
-    if (event.handler) {
-      event.handler(event.argv);
-    }
+    multiqueue_process_one(this);
+  }
+}
+
+/// Removes the next item, if any, and invokes its handler.
+void multiqueue_process_one(MultiQueue *this)
+{
+  assert(this);
+  if (multiqueue_empty(this)) {
+    return;
+  }
+  MultiQueueKind kind;
+  uint64_t start;
+  Event event = multiqueue_remove(this, &kind, &start);
+  if (!event.handler) {
+    return;
+  }
+  event.handler(event.argv);
+  if (kind != kMultiQueueUntracked) {
+    event_stats_record_run(kind, event.name, os_hrtime() - start);
   }
 }
 
@@ -160,7 +195,7 @@ void multiqueue_purge_events(MultiQueue *this)
 {
   assert(this);
   while (!multiqueue_empty(this)) {
-    (void)multiqueue_remove(this);
+    (void)multiqueue_remove(this, NULL, NULL);
   }
 }
 
@@ -185,7 +220,10 @@ size_t multiqueue_size(MultiQueue *this)
 /// Gets an Event from an item.
 ///
 /// @param remove   Remove the node from its queue, and free it.
-static Event multiqueueitem_get_event(MultiQueueItem *item, bool remove)
+/// @param[out] kind  Kind of the queue the event was pushed to.
+/// @param[out] queued  Time the event was pushed.
+static Event multiqueueitem_get_event(MultiQueueItem *item, bool remove, MultiQueueKind *kind,
+                                      uint64_t *queued)
 {
   assert(item != NULL);
   Event ev;
@@ -196,12 +234,15 @@ static Event multiqueueitem_get_event(MultiQueueItem *item, bool remove)
     MultiQueueItem *child =
       multiqueue_node_data(QUEUE_HEAD(&linked->headtail));
     ev = child->data.item.event;
+    *kind = linked->kind;
+    *queued = child->data.item.queued;
     // remove the child node
     if (remove) {
       QUEUE_REMOVE(&child->node);
       xfree(child);
     }
   } else {
+    *queued = item->data.item.queued;
     // remove the corresponding link node in the parent queue
     if (remove && item->data.item.parent_item) {
       QUEUE_REMOVE(&item->data.item.parent_item->node);
@@ -213,16 +254,35 @@ static Event multiqueueitem_get_event(MultiQueueItem *item, bool remove)
   return ev;
 }
 
-static Event multiqueue_remove(MultiQueue *this)
+/// Removes the next item and returns its Event.
+///
+/// @param[out] kind  If not NULL, set to the kind of the queue the event was
+///                   pushed to (which can be a child of `this`).
+/// @param[out] now  If not NULL, set to the time of removal.
+static Event multiqueue_remove(MultiQueue *this, MultiQueueKind *kind, uint64_t *now)
 {
   assert(!multiqueue_empty(this));
   QUEUE *h = QUEUE_HEAD(&this->headtail);
   QUEUE_REMOVE(h);
   MultiQueueItem *item = multiqueue_node_data(h);
   assert(!item->link || !this->parent);  // Only a parent queue has link-nodes
-  Event ev = multiqueueitem_get_event(item, true);
+  MultiQueueKind item_kind = this->kind;
+  uint64_t queued = 0;
+  Event ev = multiqueueitem_get_event(item, true, &item_kind, &queued);
   this->size--;
   xfree(item);
+
+  uint64_t removed = 0;
+  if (item_kind != kMultiQueueUntracked) {
+    removed = os_hrtime();
+    event_stats_record_wait(item_kind, removed - queued);
+  }
+  if (kind) {
+    *kind = item_kind;
+  }
+  if (now) {
+    *now = removed;
+  }
   return ev;
 }
 
@@ -232,6 +292,7 @@ static void multiqueue_push(MultiQueue *this, Event event)
   item->link = false;
   item->data.item.event = event;
   item->data.item.parent_item = NULL;
+  item->data.item.queued = this->kind != kMultiQueueUntracked ? os_hrtime() : 0;
   QUEUE_INSERT_TAIL(&this->headtail, &item->node);
   if (this->parent) {
     // push link node to the parent queue
@@ -242,6 +303,9 @@ static void multiqueue_push(MultiQueue *this, Event event)
                       &item->data.item.parent_item->node);
   }
   this->size++;
+  if (this->kind != kMultiQueueUntracked) {
+    event_stats_record_depth(this->kind, this->size);
+  }
 }
 
 static MultiQueueItem *multiqueue_node_data(QUEUE *q)
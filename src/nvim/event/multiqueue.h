@@ -9,6 +9,17 @@
 typedef struct multiqueue MultiQueue;
 typedef void (*PutCallback)(MultiQueue *multiq, void *data);
 
+/// Category of a queue, used to attribute event loop statistics.
+/// Child queues inherit the kind of their parent unless set explicitly.
+typedef enum {
+  kMultiQueueUntracked = -1,  ///< no statistics (e.g. queues of other threads)
+  kMultiQueueMain = 0,
+  kMultiQueueFast,
+  kMultiQueueChannel,
+  kMultiQueueUI,
+} MultiQueueKind;
+#define kMultiQueueKindCount (kMultiQueueUI + 1)
+
 #define multiqueue_put(q, h, ...) \
   multiqueue_put_event(q, event_create(h, __VA_ARGS__));
 
@@ -0,0 +1,332 @@
+// This is an open source non-commercial project. Dear PVS-Studio, please check
+// it. PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+
+// Work-stealing thread pool shared by the core and Lua (vim.pool).
+//
+// Every worker owns a deque of tasks. Tasks submitted from outside the pool
+// are spread over the deques round-robin, tasks submitted by a worker go to
+// its own deque. A worker takes tasks from the bottom of its own deque (LIFO,
+// which keeps recently split work cache-hot) and, when that is empty, steals
+// from the top of the other deques (FIFO, which takes the oldest and usually
+// largest chunks of work).
+//
+// The `done` callback of a task is scheduled on the loop given to pool_init()
+// with loop_schedule_deferred(), so it runs as a regular event on the main
+// thread. A task that is discarded instead of run, because the pool is
+// stopped, gets its `cancel` callback, so that its data can be freed.
+//
+// Each deque has its own mutex and the sleep/wake-up state has another.
+// pool_submit() pushes to a deque while holding the latter, so that it can't
+// race with pool_teardown(); no other code path holds two of them.
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <uv.h>
+
+#include "nvim/event/defs.h"
+#include "nvim/event/loop.h"
+#include "nvim/event/pool.h"
+#include "nvim/log.h"
+#include "nvim/memory.h"
+
+typedef struct {
+  pool_task_cb work;
+  pool_task_cb done;
+  pool_task_cb cancel;
+  void *data;
+} PoolTask;
+
+typedef struct {
+  uv_mutex_t mutex;
+  PoolTask **items;  ///< ring buffer, `capacity` is a power of two
+  size_t capacity;
+  size_t head;  ///< index of the oldest item, the end that is stolen from
+  size_t size;
+} TaskDeque;
+
+typedef struct {
+  uv_thread_t thread;
+  TaskDeque deque;
+  size_t index;
+} PoolWorker;
+
+#define DEQUE_INITIAL_CAPACITY 16
+
+static struct {
+  Loop *loop;
+  PoolWorker *workers;
+  size_t nworkers;
+  size_t nthreads;  ///< workers whose thread is running
+  bool started;
+  uv_mutex_t mutex;  ///< protects the fields below, initialized by pool_init()
+  uv_cond_t cond;
+  int64_t pending;  ///< queued tasks, may be briefly negative
+  size_t next;  ///< round-robin deque for submissions from outside the pool
+  bool stopping;  ///< set by pool_teardown(), tasks are cancelled from then on
+} pool;
+
+static uv_once_t pool_once = UV_ONCE_INIT;
+static uv_key_t worker_key;
+
+#ifdef INCLUDE_GENERATED_DECLARATIONS
+# include "event/pool.c.generated.h"
+#endif
+
+/// Initializes the pool. Worker threads are only started by the first
+/// pool_submit().
+///
+/// @param loop  Loop that `done` callbacks are scheduled on.
+void pool_init(Loop *loop)
+  FUNC_ATTR_NONNULL_ALL
+{
+  pool.loop = loop;
+  uv_mutex_init(&pool.mutex);
+  uv_cond_init(&pool.cond);
+  uv_cpu_info_t *cpus;
+  int count = 0;
+  if (uv_cpu_info(&cpus, &count) == 0) {
+    uv_free_cpu_info(cpus, count);
+  }
+  pool.nworkers = count > 0 ? (size_t)count : 1;
+}
+
+/// Gets the number of worker threads.
+size_t pool_size(void)
+{
+  return pool.nworkers;
+}
+
+/// Checks whether the current thread is a pool worker.
+bool pool_in_worker(void)
+{
+  return pool.started && uv_key_get(&worker_key) != NULL;
+}
+
+/// Submits a task to the pool.
+///
+/// Can be called from any thread, including from a running task. After
+/// pool_teardown() the task is cancelled right away.
+///
+/// @param work  Called with `data` on a worker thread.
+/// @param done  If not NULL, called with `data` on the main loop after `work`
+///              returned.
+/// @param cancel  If not NULL, called with `data` instead of `work` and `done`
+///                when the task is discarded: by pool_teardown() on the main
+///                thread, or by pool_submit() after it.
+/// @param data  Task data, owned by the callbacks.
+void pool_submit(pool_task_cb work, pool_task_cb done, pool_task_cb cancel, void *data)
+  FUNC_ATTR_NONNULL_ARG(1)
+{
+  assert(pool.loop);
+  uv_mutex_lock(&pool.mutex);
+  bool stopping = pool.stopping;
+  uv_mutex_unlock(&pool.mutex);
+  if (stopping) {
+    if (cancel) {
+      cancel(data);
+    }
+    return;
+  }
+  uv_once(&pool_once, pool_start);
+
+  PoolTask *task = xmalloc(sizeof(*task));
+  task->work = work;
+  task->done = done;
+  task->cancel = cancel;
+  task->data = data;
+
+  uv_mutex_lock(&pool.mutex);
+  if (pool.stopping) {
+    // pool_teardown() was called meanwhile.
+    uv_mutex_unlock(&pool.mutex);
+    pool_cancel(task);
+    return;
+  }
+  PoolWorker *target = uv_key_get(&worker_key);
+  if (target == NULL) {
+    target = &pool.workers[pool.next++ % pool.nworkers];
+  }
+  deque_push(&target->deque, task);
+  pool.pending++;
+  uv_cond_signal(&pool.cond);
+  uv_mutex_unlock(&pool.mutex);
+}
+
+/// Stops the pool. Tasks that have not started are cancelled, running tasks
+/// delay this until they return. The `done` callbacks of finished tasks only
+/// run if the loop is processed afterwards. Tasks submitted after this are
+/// cancelled.
+void pool_teardown(void)
+{
+  if (pool.loop == NULL) {
+    return;
+  }
+  uv_mutex_lock(&pool.mutex);
+  pool.stopping = true;
+  uv_cond_broadcast(&pool.cond);
+  uv_mutex_unlock(&pool.mutex);
+  if (!pool.started) {
+    return;
+  }
+
+  for (size_t i = 0; i < pool.nthreads; i++) {
+    uv_thread_join(&pool.workers[i].thread);
+  }
+  for (size_t i = 0; i < pool.nworkers; i++) {
+    TaskDeque *d = &pool.workers[i].deque;
+    PoolTask *task;
+    while ((task = deque_pop(d)) != NULL) {
+      pool_cancel(task);
+    }
+    uv_mutex_destroy(&d->mutex);
+    xfree(d->items);
+  }
+  XFREE_CLEAR(pool.workers);
+  uv_key_delete(&worker_key);
+  pool.nthreads = 0;
+  pool.pending = 0;
+  pool.started = false;
+}
+
+static void pool_cancel(PoolTask *task)
+{
+  if (task->cancel) {
+    task->cancel(task->data);
+  }
+  xfree(task);
+}
+
+static void pool_start(void)
+{
+  uv_key_create(&worker_key);
+  pool.workers = xcalloc(pool.nworkers, sizeof(*pool.workers));
+  for (size_t i = 0; i < pool.nworkers; i++) {
+    PoolWorker *w = &pool.workers[i];
+    w->index = i;
+    uv_mutex_init(&w->deque.mutex);
+    w->deque.capacity = DEQUE_INITIAL_CAPACITY;
+    w->deque.items = xmalloc(w->deque.capacity * sizeof(*w->deque.items));
+  }
+  pool.started = true;
+  // Tasks on the deque of a worker without a thread are stolen by the others.
+  for (; pool.nthreads < pool.nworkers; pool.nthreads++) {
+    PoolWorker *w = &pool.workers[pool.nthreads];
+    if (uv_thread_create(&w->thread, pool_worker_main, w) != 0) {
+      break;
+    }
+  }
+  if (pool.nthreads == 0) {
+    // Nothing could ever run the submitted tasks.
+    abort();
+  } else if (pool.nthreads < pool.nworkers) {
+    ELOG("could only start %zu of %zu pool workers", pool.nthreads, pool.nworkers);
+  }
+}
+
+static void pool_worker_main(void *arg)
+{
+  PoolWorker *self = arg;
+  uv_key_set(&worker_key, self);
+
+  while (true) {
+    uv_mutex_lock(&pool.mutex);
+    while (pool.pending <= 0 && !pool.stopping) {
+      uv_cond_wait(&pool.cond, &pool.mutex);
+    }
+    bool stop = pool.stopping;
+    uv_mutex_unlock(&pool.mutex);
+    if (stop) {
+      // Queued tasks are cancelled by pool_teardown().
+      break;
+    }
+
+    PoolTask *task = deque_pop(&self->deque);
+    if (task == NULL) {
+      task = pool_steal(self);
+    }
+    if (task != NULL) {
+      uv_mutex_lock(&pool.mutex);
+      pool.pending--;
+      uv_mutex_unlock(&pool.mutex);
+      pool_run(task);
+    }
+  }
+  log_thread_exit();
+}
+
+static PoolTask *pool_steal(PoolWorker *self)
+{
+  for (size_t i = 1; i < pool.nworkers; i++) {
+    PoolWorker *victim = &pool.workers[(self->index + i) % pool.nworkers];
+    PoolTask *task = deque_steal(&victim->deque);
+    if (task != NULL) {
+      return task;
+    }
+  }
+  return NULL;
+}
+
+static void pool_run(PoolTask *task)
+{
+  task->work(task->data);
+  if (task->done) {
+    loop_schedule_deferred(pool.loop, event_create(pool_done_event, 1, task));
+  } else {
+    xfree(task);
+  }
+}
+
+static void pool_done_event(void **argv)
+{
+  PoolTask *task = argv[0];
+  task->done(task->data);
+  xfree(task);
+}
+
+static void deque_push(TaskDeque *d, PoolTask *task)
+{
+  uv_mutex_lock(&d->mutex);
+  if (d->size == d->capacity) {
+    size_t capacity = d->capacity * 2;
+    PoolTask **items = xmalloc(capacity * sizeof(*items));
+    for (size_t i = 0; i < d->size; i++) {
+      items[i] = d->items[(d->head + i) & (d->capacity - 1)];
+    }
+    xfree(d->items);
+    d->items = items;
+    d->capacity = capacity;
+    d->head = 0;
+  }
+  d->items[(d->head + d->size) & (d->capacity - 1)] = task;
+  d->size++;
+  uv_mutex_unlock(&d->mutex);
+}
+
+/// Takes the newest task, used by the owner of the deque.
+static PoolTask *deque_pop(TaskDeque *d)
+{
+  PoolTask *task = NULL;
+  uv_mutex_lock(&d->mutex);
+  if (d->size > 0) {
+    d->size--;
+    task = d->items[(d->head + d->size) & (d->capacity - 1)];
+  }
+  uv_mutex_unlock(&d->mutex);
+  return task;
+}
+
+/// Takes the oldest task, used by other workers.
+static PoolTask *deque_steal(TaskDeque *d)
+{
+  PoolTask *task = NULL;
+  uv_mutex_lock(&d->mutex);
+  if (d->size > 0) {
+    task = d->items[d->head];
+    d->head = (d->head + 1) & (d->capacity - 1);
+    d->size--;
+  }
+  uv_mutex_unlock(&d->mutex);
+  return task;
+}
@@ -0,0 +1,17 @@
+#ifndef NVIM_EVENT_POOL_H
+#define NVIM_EVENT_POOL_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "nvim/event/loop.h"
+
+/// Task callback. `work` callbacks run on a worker thread and must not touch
+/// editor state; `done` callbacks run on the main loop; `cancel` callbacks
+/// free the data of a task that is not run, see pool_submit().
+typedef void (*pool_task_cb)(void *data);
+
+#ifdef INCLUDE_GENERATED_DECLARATIONS
+# include "event/pool.h.generated.h"
+#endif
+#endif  // NVIM_EVENT_POOL_H
@@ -0,0 +1,213 @@
+// This is an open source non-commercial project. Dear PVS-Studio, please check
+// it. PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+
+// Event loop statistics.
+//
+// Always-on instrumentation of the tracked multiqueues (see
+// multiqueue_set_kind()): wait and run time histograms and the depth
+// high-water mark per queue kind, and per-handler run times keyed by the
+// handler name recorded by event_create().
+//
+// Only queues owned by the main thread are tracked, so no locking is done.
+
+#include <assert.h>
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "nvim/event/multiqueue.h"
+#include "nvim/event/stats.h"
+#include "nvim/func_attr.h"
+#include "nvim/histogram.h"
+#include "nvim/macros.h"
+#include "nvim/memory.h"
+#include "nvim/os/fs.h"
+#include "nvim/os/os.h"
+#include "nvim/os/time.h"
+#include "nvim/strings.h"
+
+// Power of two. Handler names are string literals, so the table is keyed by
+// pointer and only needs room for the number of distinct handlers.
+#define HANDLER_TABLE_SIZE (EVENT_STATS_HANDLERS_MAX - 1)
+
+static EventQueueStats queue_stats[kMultiQueueKindCount];
+static EventHandlerStats handler_stats[HANDLER_TABLE_SIZE];
+/// Handlers that did not fit into `handler_stats`.
+static EventHandlerStats handler_overflow = { .name = "(other)" };
+
+static const char *kind_names[kMultiQueueKindCount] = {
+  [kMultiQueueMain] = "main",
+  [kMultiQueueFast] = "fast",
+  [kMultiQueueChannel] = "channel",
+  [kMultiQueueUI] = "ui",
+};
+
+#ifdef INCLUDE_GENERATED_DECLARATIONS
+# include "event/stats.c.generated.h"
+#endif
+
+const char *multiqueue_kind_name(MultiQueueKind kind)
+  FUNC_ATTR_PURE
+{
+  return (kind >= 0 && kind < kMultiQueueKindCount) ? kind_names[kind] : "untracked";
+}
+
+void event_stats_record_depth(MultiQueueKind kind, size_t depth)
+{
+  if (depth > queue_stats[kind].depth_max) {
+    queue_stats[kind].depth_max = depth;
+  }
+}
+
+void event_stats_record_wait(MultiQueueKind kind, uint64_t ns)
+{
+  histogram_record(&queue_stats[kind].wait, ns);
+}
+
+void event_stats_record_run(MultiQueueKind kind, const char *name, uint64_t ns)
+{
+  histogram_record(&queue_stats[kind].run, ns);
+
+  EventHandlerStats *h = handler_lookup(name ? name : "(unnamed)");
+  h->count++;
+  h->total += ns;
+  if (ns > h->max) {
+    h->max = ns;
+  }
+}
+
+static EventHandlerStats *handler_lookup(const char *name)
+{
+  size_t mask = HANDLER_TABLE_SIZE - 1;
+  size_t i = ((uintptr_t)name >> 3) & mask;
+  for (size_t probe = 0; probe < HANDLER_TABLE_SIZE; probe++) {
+    EventHandlerStats *h = &handler_stats[(i + probe) & mask];
+    if (h->name == name) {
+      return h;
+    } else if (h->name == NULL) {
+      h->name = name;
+      return h;
+    }
+  }
+  return &handler_overflow;
+}
+
+/// Gets the statistics of the queues of one kind.
+const EventQueueStats *event_stats_get(MultiQueueKind kind)
+  FUNC_ATTR_PURE
+{
+  assert(kind >= 0 && kind < kMultiQueueKindCount);
+  return &queue_stats[kind];
+}
+
+static int handler_name_cmp(const void *a, const void *b)
+{
+  return strcmp(((const EventHandlerStats *)a)->name, ((const EventHandlerStats *)b)->name);
+}
+
+static int handler_cmp(const void *a, const void *b)
+{
+  uint64_t ma = ((const EventHandlerStats *)a)->max;
+  uint64_t mb = ((const EventHandlerStats *)b)->max;
+  return ma < mb ? 1 : (ma > mb ? -1 : 0);
+}
+
+/// Gets the handlers with the highest maximum run time. Handlers with the same
+/// name, e.g. callbacks of the same name in different files, are merged into
+/// one item.
+///
+/// @param[out] out  Array of at least `n` items.
+/// @param n  Number of handlers to get.
+/// @return number of items stored in `out`, sorted by decreasing maximum.
+size_t event_stats_slowest(EventHandlerStats *out, size_t n)
+  FUNC_ATTR_NONNULL_ALL
+{
+  EventHandlerStats all[HANDLER_TABLE_SIZE + 1];
+  size_t count = 0;
+  for (size_t i = 0; i < HANDLER_TABLE_SIZE; i++) {
+    if (handler_stats[i].name) {
+      all[count++] = handler_stats[i];
+    }
+  }
+  if (handler_overflow.count) {
+    all[count++] = handler_overflow;
+  }
+  // The table is keyed by pointer, equal names may be stored more than once.
+  qsort(all, count, sizeof(*all), handler_name_cmp);
+  size_t merged = 0;
+  for (size_t i = 0; i < count; i++) {
+    if (merged > 0 && strequal(all[merged - 1].name, all[i].name)) {
+      EventHandlerStats *h = &all[merged - 1];
+      h->count += all[i].count;
+      h->total += all[i].total;
+      h->max = MAX(h->max, all[i].max);
+    } else {
+      all[merged++] = all[i];
+    }
+  }
+  count = merged;
+  qsort(all, count, sizeof(*all), handler_cmp);
+  if (count > n) {
+    count = n;
+  }
+  memcpy(out, all, count * sizeof(*out));
+  return count;
+}
+
+void event_stats_reset(void)
+{
+  for (int i = 0; i < kMultiQueueKindCount; i++) {
+    histogram_reset(&queue_stats[i].wait);
+    histogram_reset(&queue_stats[i].run);
+    queue_stats[i].depth_max = 0;
+  }
+  memset(handler_stats, 0, sizeof(handler_stats));
+  handler_overflow.count = handler_overflow.total = handler_overflow.max = 0;
+}
+
+/// Appends a human-readable report of the event loop statistics to a file.
+///
+/// @param fname  File to append to.
+/// @param top  Number of slowest handlers to list.
+/// @return false if the file could not be opened.
+bool event_stats_dump(const char *fname, size_t top)
+  FUNC_ATTR_NONNULL_ALL
+{
+  FILE *f = os_fopen(fname, "a");
+  if (f == NULL) {
+    return false;
+  }
+
+  char date[100];
+  fprintf(f, "event loop statistics, pid %" PRId64 ", %s", os_get_pid(),
+          os_ctime(date, sizeof(date), true));
+  fprintf(f, "%-8s %10s %8s | %10s %10s %10s %10s | %10s %10s %10s %10s\n",
+          "queue", "events", "depth", "wait p50", "wait p99", "wait max", "wait avg",
+          "run p50", "run p99", "run max", "run avg");
+  for (int i = 0; i < kMultiQueueKindCount; i++) {
+    const EventQueueStats *s = &queue_stats[i];
+    fprintf(f, "%-8s %10" PRIu64 " %8zu | %10" PRIu64 " %10" PRIu64 " %10" PRIu64 " %10" PRIu64
+            " | %10" PRIu64 " %10" PRIu64 " %10" PRIu64 " %10" PRIu64 "\n",
+            kind_names[i], s->wait.count, s->depth_max,
+            histogram_percentile(&s->wait, 50) / 1000, histogram_percentile(&s->wait, 99) / 1000,
+            s->wait.max / 1000, histogram_mean(&s->wait) / 1000,
+            histogram_percentile(&s->run, 50) / 1000, histogram_percentile(&s->run, 99) / 1000,
+            s->run.max / 1000, histogram_mean(&s->run) / 1000);
+  }
+
+  EventHandlerStats *slowest = xmalloc(top * sizeof(*slowest));
+  size_t n = event_stats_slowest(slowest, top);
+  fprintf(f, "slowest handlers (us):\n%-40s %10s %10s %10s\n", "handler", "count", "max", "avg");
+  for (size_t i = 0; i < n; i++) {
+    fprintf(f, "%-40s %10" PRIu64 " %10" PRIu64 " %10" PRIu64 "\n", slowest[i].name,
+            slowest[i].count, slowest[i].max / 1000, slowest[i].total / slowest[i].count / 1000);
+  }
+  fputs("\n", f);
+  xfree(slowest);
+  fclose(f);
+  return true;
+}
@@ -0,0 +1,32 @@
+#ifndef NVIM_EVENT_STATS_H
+#define NVIM_EVENT_STATS_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "nvim/event/multiqueue.h"
+#include "nvim/histogram.h"
+
+/// Statistics of all queues of one MultiQueueKind.
+typedef struct {
+  Histogram wait;  ///< time from push to removal, in nanoseconds
+  Histogram run;  ///< handler run time, in nanoseconds
+  size_t depth_max;  ///< high-water mark of the queue depth
+} EventQueueStats;
+
+/// Run time statistics of one event handler.
+typedef struct {
+  const char *name;
+  uint64_t count;
+  uint64_t total;  ///< nanoseconds
+  uint64_t max;  ///< nanoseconds
+} EventHandlerStats;
+
+/// Maximum number of handlers returned by event_stats_slowest(): the tracked
+/// ones and one entry for the rest.
+#define EVENT_STATS_HANDLERS_MAX 257
+
+#ifdef INCLUDE_GENERATED_DECLARATIONS
+# include "event/stats.h.generated.h"
+#endif
+#endif  // NVIM_EVENT_STATS_H
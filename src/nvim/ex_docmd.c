@@ -104,6 +104,7 @@ static bool ex_pressedreturn = false;
 typedef struct {
   char *line;            // command line
   linenr_T lnum;                // sourcing_lnum of the line
+  bool func_line;               // a whole line of a function
 } wcmd_T;
 
 #define FREE_WCMD(wcmd) xfree((wcmd)->line)
@@ -330,6 +331,7 @@ int do_cmdline(char *cmdline, LineGetter fgetline, void *cookie, int flags)
   struct loop_cookie cmd_loop_cookie;
   void *real_cookie;
   int getline_is_func;
+  linenr_T func_lnum;                   // function line in "next_cmdline"
   static int call_depth = 0;            // recursiveness
 
   // For every pair of do_cmdline()/do_one_cmd() calls, use an extra memory
@@ -416,6 +418,7 @@ int do_cmdline(char *cmdline, LineGetter fgetline, void *cookie, int flags)
   next_cmdline = cmdline;
   do {
     getline_is_func = getline_equal(fgetline, cookie, get_func_line);
+    func_lnum = 0;
 
     // stop skipping cmds for an error msg after all endif/while/for
     if (next_cmdline == NULL
@@ -467,6 +470,9 @@ int do_cmdline(char *cmdline, LineGetter fgetline, void *cookie, int flags)
 
       next_cmdline = ((wcmd_T *)(lines_ga.ga_data))[current_line].line;
       SOURCING_LNUM = ((wcmd_T *)(lines_ga.ga_data))[current_line].lnum;
+      if (((wcmd_T *)(lines_ga.ga_data))[current_line].func_line) {
+        func_lnum = SOURCING_LNUM;
+      }
 
       // Did we encounter a breakpoint?
       if (breakpoint != NULL && *breakpoint != 0 && *breakpoint <= SOURCING_LNUM) {
@@ -525,6 +531,9 @@ int do_cmdline(char *cmdline, LineGetter fgetline, void *cookie, int flags)
         break;
       }
       used_getline = true;
+      if (getline_is_func) {
+        func_lnum = SOURCING_LNUM;
+      }
 
       // Keep the first typed line.  Clear it when more lines are typed.
       if (flags & DOCMD_KEEPLINE) {
@@ -548,7 +557,7 @@ int do_cmdline(char *cmdline, LineGetter fgetline, void *cookie, int flags)
     // :endwhile/:endfor.
     if (current_line == lines_ga.ga_len
         && (cstack.cs_looplevel || has_loop_cmd(next_cmdline))) {
-      store_loop_line(&lines_ga, next_cmdline);
+      store_loop_line(&lines_ga, next_cmdline, func_lnum != 0);
     }
     did_endif = false;
 
@@ -576,7 +585,7 @@ int do_cmdline(char *cmdline, LineGetter fgetline, void *cookie, int flags)
     //    do_one_cmd() will return NULL if there is no trailing '|'.
     //    "cmdline_copy" can change, e.g. for '%' and '#' expansion.
     recursive++;
-    next_cmdline = do_one_cmd(&cmdline_copy, flags, &cstack, cmd_getline, cmd_cookie);
+    next_cmdline = do_one_cmd(&cmdline_copy, flags, &cstack, cmd_getline, cmd_cookie, func_lnum);
     recursive--;
 
     if (cmd_cookie == (void *)&cmd_loop_cookie) {
@@ -924,7 +933,7 @@ static char *get_loop_line(int c, void *cookie, int indent, bool do_concat)
       line = cp->getline(c, cp->cookie, indent, do_concat);
     }
     if (line != NULL) {
-      store_loop_line(cp->lines_gap, line);
+      store_loop_line(cp->lines_gap, line, false);
       cp->current_line++;
     }
 
@@ -939,11 +948,12 @@ static char *get_loop_line(int c, void *cookie, int indent, bool do_concat)
 }
 
 /// Store a line in "gap" so that a ":while" loop can execute it again.
-static void store_loop_line(garray_T *gap, char *line)
+static void store_loop_line(garray_T *gap, char *line, bool func_line)
 {
   wcmd_T *p = GA_APPEND_VIA_PTR(wcmd_T, gap);
   p->line = xstrdup(line);
   p->lnum = SOURCING_LNUM;
+  p->func_line = func_line;
 }
 
 /// If "fgetline" is get_loop_line(), return true if the getline it uses equals
@@ -1864,8 +1874,10 @@ static bool skip_cmd(const exarg_T *eap)
 /// This function may be called recursively!
 ///
 /// @param cookie  argument for fgetline()
+/// @param func_lnum  when not zero "*cmdlinep" is this line of the executed
+///                   function, the parsed command is cached for it.
 static char *do_one_cmd(char **cmdlinep, int flags, cstack_T *cstack, LineGetter fgetline,
-                        void *cookie)
+                        void *cookie, linenr_T func_lnum)
 {
   char *errormsg = NULL;  // error message
   const int save_reg_executing = reg_executing;
@@ -1876,6 +1888,8 @@ static char *do_one_cmd(char **cmdlinep, int flags, cstack_T *cstack, LineGetter
     .line2 = 1,
   };
   ex_nesting_level++;
+  PROFILE_SAMPLE_CHECK();
+  ArenaMark cmd_mark = arena_scope_enter(&cmd_scope);
 
   // When the last file has not been edited :q has to be typed twice.
   if (quitmore
@@ -1906,7 +1920,16 @@ static char *do_one_cmd(char **cmdlinep, int flags, cstack_T *cstack, LineGetter
   ea.cookie = cookie;
   ea.cstack = cstack;
 
-  if (parse_command_modifiers(&ea, &errormsg, &cmdmod, false) == FAIL) {
+  // A function line that was executed before doesn't need to be parsed again
+  // up to the command name.
+  ufunc_line_T *line_cmd = func_lnum > 0
+                           ? func_line_cmd(getline_cookie(fgetline, cookie), func_lnum)
+                           : NULL;
+  const bool use_line_cmd = line_cmd != NULL && line_cmd->ul_cmdidx >= 0;
+  if (use_line_cmd) {
+    CLEAR_FIELD(cmdmod);
+    ea.cmd = *cmdlinep + line_cmd->ul_cmd_off;
+  } else if (parse_command_modifiers(&ea, &errormsg, &cmdmod, false) == FAIL) {
     goto doend;
   }
   apply_cmdmod(&cmdmod);
@@ -1923,11 +1946,21 @@ static char *do_one_cmd(char **cmdlinep, int flags, cstack_T *cstack, LineGetter
   //
   // We need the command to know what kind of range it uses.
   char *cmd = ea.cmd;
-  ea.cmd = skip_range(ea.cmd, NULL);
-  if (*ea.cmd == '*') {
-    ea.cmd = skipwhite(ea.cmd + 1);
+  char *p;
+  if (use_line_cmd) {
+    ea.cmdidx = (cmdidx_T)line_cmd->ul_cmdidx;
+    ea.flags = line_cmd->ul_flags;
+    p = *cmdlinep + line_cmd->ul_arg_off;
+  } else {
+    ea.cmd = skip_range(ea.cmd, NULL);
+    if (*ea.cmd == '*') {
+      ea.cmd = skipwhite(ea.cmd + 1);
+    }
+    p = find_ex_command(&ea, NULL);
+    if (line_cmd != NULL && line_cmd->ul_cmdidx == UL_NOT_PARSED) {
+      cache_line_cmd(line_cmd, &ea, *cmdlinep, cmd, p);
+    }
   }
-  char *p = find_ex_command(&ea, NULL);
 
   profile_cmd(&ea, cstack, fgetline, cookie);
 
@@ -2011,9 +2044,8 @@ static char *do_one_cmd(char **cmdlinep, int flags, cstack_T *cstack, LineGetter
     while (ASCII_ISALNUM(*p)) {
       p++;
     }
-    p = xstrnsave(ea.cmd, (size_t)(p - ea.cmd));
+    p = arena_memdupz(arena_scope_get(&cmd_scope), ea.cmd, (size_t)(p - ea.cmd));
     int ret = apply_autocmds(EVENT_CMDUNDEFINED, p, p, true, NULL);
-    xfree(p);
     // If the autocommands did something and didn't cause an error, try
     // finding the command again.
     p = (ret && !aborting()) ? find_ex_command(&ea, NULL) : ea.cmd;
@@ -2327,6 +2359,7 @@ doend:
   }
 
   ex_nesting_level--;
+  arena_scope_leave(&cmd_scope, cmd_mark);
 
   return ea.nextcmd;
 }
@@ -2343,6 +2376,33 @@ char *ex_errmsg(const char *const msg, const char *const arg)
   return ex_error_buf;
 }
 
+/// Remember the command found by find_ex_command() for a function line, when
+/// it does not depend on anything but the text up to the command name.
+///
+/// @param line  start of the line
+/// @param cmd  start of the command after the modifiers
+/// @param p  end of the command name
+static void cache_line_cmd(ufunc_line_T *line_cmd, const exarg_T *eap, const char *line,
+                           const char *cmd, const char *p)
+{
+  const char *s = line;
+  while (*s == ' ' || *s == '\t' || *s == ':') {
+    s++;
+  }
+  // Modifiers and ranges are parsed every time, user commands can be
+  // redefined and :Next is found after user commands.
+  if (s != cmd || eap->cmd != cmd || p == NULL
+      || !ASCII_ISLOWER(*cmd) || IS_USER_CMDIDX(eap->cmdidx) || eap->cmdidx >= CMD_SIZE
+      || p - line > INT_MAX) {
+    line_cmd->ul_cmdidx = UL_NO_CACHE;
+    return;
+  }
+  line_cmd->ul_cmdidx = (int)eap->cmdidx;
+  line_cmd->ul_flags = eap->flags;
+  line_cmd->ul_cmd_off = (int)(cmd - line);
+  line_cmd->ul_arg_off = (int)(p - line);
+}
+
 /// Parse and skip over command modifiers:
 /// - update eap->cmd
 /// - store flags in "cmod".
@@ -13,6 +13,7 @@
 #include <string.h>
 
 #include "nvim/ascii.h"
+#include "nvim/buffer.h"
 #include "nvim/buffer_defs.h"
 #include "nvim/buffer_updates.h"
 #include "nvim/change.h"
@@ -116,6 +117,24 @@ static linenr_T invalid_bot = (linenr_T)0;
 static linenr_T prev_lnum = 0;
 static int prev_lnum_lvl = -1;
 
+// The results of 'foldexpr' are kept per line in "w_fold_expr_cache" while
+// the lines don't change.  After a change the expression is evaluated for the
+// changed lines and the line above them.  Below them it is evaluated again
+// until the result for a line is the cached one, the lines after that are
+// taken from the cache.  Missing results are computed for a batch of lines at
+// once.
+#define FOLD_EXPR_BATCH   64  // lines to evaluate 'foldexpr' for at once
+
+// Line below a freshly evaluated line, for which the cached result of
+// 'foldexpr' must be checked.  Zero when the cache can be used.
+static linenr_T fold_expr_check_lnum = 0;
+
+// Set while evaluating 'foldexpr', "fold_expr_used_foldlevel" is set when it
+// called foldlevel().  Such a result depends on the levels being computed
+// and can't be cached.
+static bool fold_expr_evaluating = false;
+static bool fold_expr_used_foldlevel = false;
+
 // Flags used for "done" argument of setManualFold.
 #define DONE_NOTHING    0
 #define DONE_ACTION     1       // did close or open a fold
@@ -261,6 +280,9 @@ bool hasFoldingWin(win_T *const win, const linenr_T lnum, linenr_T *const firstp
 /// @return  fold level at line number "lnum" in the current window.
 static int foldLevel(linenr_T lnum)
 {
+  if (fold_expr_evaluating) {
+    fold_expr_used_foldlevel = true;
+  }
   // While updating the folds lines between invalid_top and invalid_bot have
   // an undefined fold level.  Otherwise update the folds first.
   if (invalid_top == (linenr_T)0) {
@@ -759,6 +781,7 @@ void clearFolding(win_T *win)
 {
   deleteFoldRecurse(win->w_buffer, &win->w_folds);
   win->w_foldinvalid = false;
+  fold_expr_cache_clear(win);
 }
 
 // foldUpdate() {{{2
@@ -768,6 +791,8 @@ void clearFolding(win_T *win)
 /// The changes in lines from top to bot (inclusive).
 void foldUpdate(win_T *wp, linenr_T top, linenr_T bot)
 {
+  fold_expr_cache_invalidate(wp, top, bot);
+
   if (disable_fold_update || State & MODE_INSERT) {
     return;
   }
@@ -1347,6 +1372,8 @@ void foldMarkAdjust(win_T *wp, linenr_T line1, linenr_T line2, linenr_T amount,
 {
   // If deleting marks from line1 to line2, but not deleting all those
   // lines, set line2 so that only deleted lines have their folds removed.
+  fold_expr_cache_mark_adjust(wp, line1, line2, amount, amount_after);
+
   if (amount == MAXLNUM && line2 >= line1 && line2 - line1 >= -amount_after) {
     line2 = line1 - amount_after - 1;
   }
@@ -1885,6 +1912,8 @@ static void foldUpdateIEMS(win_T *const wp, linenr_T top, linenr_T bot)
     top = 1;
     bot = wp->w_buffer->b_ml.ml_line_count;
     wp->w_foldinvalid = false;
+    // Evaluate 'foldexpr' again, it may depend on more than the text.
+    fold_expr_cache_clear(wp);
 
     // Mark all folds as maybe-small.
     setSmallMaybe(&wp->w_folds);
@@ -1954,6 +1983,8 @@ static void foldUpdateIEMS(win_T *const wp, linenr_T top, linenr_T bot)
     fline.lnum = top;
     if (foldmethodIsExpr(wp)) {
       getlevel = foldlevelExpr;
+      fold_expr_cache_check(wp);
+      fold_expr_check_lnum = 0;
       // start one line back, because a "<1" may indicate the end of a
       // fold in the topline
       if (top > 1) {
@@ -2097,6 +2128,10 @@ static void foldUpdateIEMS(win_T *const wp, linenr_T top, linenr_T bot)
     }
   }
 
+  if (getlevel == foldlevelExpr) {
+    fold_expr_cache_stop(wp);
+  }
+
   invalid_top = (linenr_T)0;
 }
 
@@ -2718,6 +2753,10 @@ void foldMoveRange(win_T *const wp, garray_T *gap, const linenr_T line1, const l
   const linenr_T move_len = dest - line2;
   const bool at_start = foldFind(gap, line1 - 1, &fp);
 
+  if (gap == &wp->w_folds) {
+    fold_expr_cache_clear(wp);
+  }
+
   if (at_start) {
     if (FOLD_END(fp) > dest) {
       // Case 4 -- don't have to change this fold, but have to move nested
@@ -2890,7 +2929,7 @@ static void foldlevelDiff(fline_T *flp)
 
 // foldlevelExpr() {{{2
 /// Low level function to get the foldlevel for the "expr" method.
-/// Doesn't use any caching.
+/// The result of 'foldexpr' may come from "w_fold_expr_cache".
 ///
 /// @return  a level of -1 if the foldlevel depends on surrounding lines.
 static void foldlevelExpr(fline_T *flp)
@@ -2900,7 +2939,6 @@ static void foldlevelExpr(fline_T *flp)
   win_T *win = curwin;
   curwin = flp->wp;
   curbuf = flp->wp->w_buffer;
-  set_vim_var_nr(VV_LNUM, (varnumber_T)lnum);
 
   flp->start = 0;
   flp->had_end = flp->end;
@@ -2909,13 +2947,8 @@ static void foldlevelExpr(fline_T *flp)
     flp->lvl = 0;
   }
 
-  // KeyTyped may be reset to 0 when calling a function which invokes
-  // do_cmdline().  To make 'foldopen' work correctly restore KeyTyped.
-  const bool save_keytyped = KeyTyped;
-
   int c;
-  const int n = eval_foldexpr(flp->wp->w_p_fde, &c);
-  KeyTyped = save_keytyped;
+  const int n = fold_expr_get(flp->wp, lnum, &c);
 
   switch (c) {
   // "a1", "a2", .. : add to the fold level
@@ -2986,6 +3019,188 @@ static void foldlevelExpr(fline_T *flp)
   curbuf = curwin->w_buffer;
 }
 
+// fold_expr_get() {{{2
+/// Get the result of 'foldexpr' for line "lnum" of window "wp", which must be
+/// the current window.  When it is not cached, the expression is evaluated
+/// for a batch of lines from "lnum", but not past the lines being updated.
+/// A cached result just below a freshly evaluated line is checked by
+/// evaluating the expression again.
+///
+/// @param[out] cp  set to the character before the number, or NUL
+///
+/// @return  the number
+static int fold_expr_get(win_T *wp, linenr_T lnum, int *cp)
+{
+  foldexpr_cache_T *fc = &wp->w_fold_expr_cache;
+  if (fc->fc_lines == NULL || fc->fc_disabled || lnum < 1 || lnum > fc->fc_count) {
+    return fold_expr_eval(wp, lnum, cp, NULL);
+  }
+
+  foldexpr_line_T *fl = &fc->fc_lines[lnum - 1];
+  if (fl->fe_valid && lnum == fold_expr_check_lnum) {
+    int c;
+    bool used_foldlevel;
+    const int n = fold_expr_eval(wp, lnum, &c, &used_foldlevel);
+    if (used_foldlevel) {
+      fc->fc_disabled = true;
+      *cp = c;
+      return n;
+    }
+    if (n == fl->fe_level && (char)c == fl->fe_type) {
+      // Same as before the change, the lines below are still valid.
+      fold_expr_check_lnum = 0;
+    } else {
+      fl->fe_level = n;
+      fl->fe_type = (char)c;
+      fold_expr_check_lnum = lnum + 1;
+    }
+  } else if (!fl->fe_valid) {
+    const linenr_T last = MIN(MIN(lnum + FOLD_EXPR_BATCH - 1, MAX(invalid_bot, lnum)),
+                              fc->fc_count);
+    for (linenr_T l = lnum; l <= last && !fc->fc_lines[l - 1].fe_valid; l++) {
+      int c;
+      bool used_foldlevel;
+      const int n = fold_expr_eval(wp, l, &c, &used_foldlevel);
+      if (used_foldlevel) {
+        // The level of the previous line is only known for "lnum".
+        fc->fc_disabled = true;
+        if (l == lnum) {
+          *cp = c;
+          return n;
+        }
+        break;
+      }
+      fc->fc_lines[l - 1] = (foldexpr_line_T){ .fe_level = n, .fe_type = (char)c,
+                                               .fe_valid = true };
+      fold_expr_check_lnum = l + 1;
+    }
+  }
+  *cp = (uint8_t)fl->fe_type;
+  return fl->fe_level;
+}
+
+/// Evaluate 'foldexpr' of window "wp" for line "lnum".
+///
+/// @param[out] used_foldlevel  if not NULL, set when the expression called
+///                             foldlevel()
+static int fold_expr_eval(win_T *wp, linenr_T lnum, int *cp, bool *used_foldlevel)
+{
+  set_vim_var_nr(VV_LNUM, (varnumber_T)lnum);
+
+  // KeyTyped may be reset to 0 when calling a function which invokes
+  // do_cmdline().  To make 'foldopen' work correctly restore KeyTyped.
+  const bool save_keytyped = KeyTyped;
+  const bool save_evaluating = fold_expr_evaluating;
+  fold_expr_evaluating = true;
+  fold_expr_used_foldlevel = false;
+
+  const int n = eval_foldexpr(wp->w_p_fde, cp);
+
+  if (used_foldlevel != NULL) {
+    *used_foldlevel = fold_expr_used_foldlevel;
+  }
+  fold_expr_evaluating = save_evaluating;
+  KeyTyped = save_keytyped;
+  return n;
+}
+
+/// Make sure the 'foldexpr' cache of window "wp" is for the current text and
+/// expression, start a new one when it isn't.
+static void fold_expr_cache_check(win_T *wp)
+{
+  foldexpr_cache_T *fc = &wp->w_fold_expr_cache;
+  buf_T *const buf = wp->w_buffer;
+
+  if (fc->fc_expr != NULL
+      && (fc->fc_count != buf->b_ml.ml_line_count
+          || fc->fc_tick != buf_get_changedtick(buf)
+          || strcmp(fc->fc_expr, wp->w_p_fde) != 0)) {
+    fold_expr_cache_clear(wp);
+  }
+  if (fc->fc_expr == NULL) {
+    fc->fc_expr = xstrdup(wp->w_p_fde);
+    fc->fc_count = buf->b_ml.ml_line_count;
+    fc->fc_size = fc->fc_count;
+    fc->fc_lines = xcalloc((size_t)fc->fc_size, sizeof(*fc->fc_lines));
+    fc->fc_tick = buf_get_changedtick(buf);
+  }
+}
+
+/// Called when done updating the folds of window "wp".  A cached 'foldexpr'
+/// result that still had to be checked is evaluated the next time.
+static void fold_expr_cache_stop(win_T *wp)
+{
+  foldexpr_cache_T *fc = &wp->w_fold_expr_cache;
+  if (fc->fc_lines != NULL && fold_expr_check_lnum >= 1
+      && fold_expr_check_lnum <= fc->fc_count) {
+    fc->fc_lines[fold_expr_check_lnum - 1].fe_valid = false;
+  }
+  fold_expr_check_lnum = 0;
+}
+
+/// Free the 'foldexpr' cache of window "wp".
+static void fold_expr_cache_clear(win_T *wp)
+{
+  foldexpr_cache_T *fc = &wp->w_fold_expr_cache;
+  xfree(fc->fc_lines);
+  xfree(fc->fc_expr);
+  memset(fc, 0, sizeof(*fc));
+}
+
+/// Forget the cached 'foldexpr' results for the changed lines "top" to "bot"
+/// and the line above them, which may look at the changed lines.  The lines
+/// below are checked by fold_expr_get().
+static void fold_expr_cache_invalidate(win_T *wp, linenr_T top, linenr_T bot)
+{
+  foldexpr_cache_T *fc = &wp->w_fold_expr_cache;
+  if (fc->fc_lines == NULL) {
+    return;
+  }
+  if (top > bot) {
+    linenr_T tmp = top;
+    top = bot;
+    bot = tmp;
+  }
+  top = MAX(top - 1, 1);
+  bot = MIN(bot, fc->fc_count);
+  for (linenr_T lnum = top; lnum <= bot; lnum++) {
+    fc->fc_lines[lnum - 1].fe_valid = false;
+  }
+  fc->fc_tick = buf_get_changedtick(wp->w_buffer);
+}
+
+/// Move the cached 'foldexpr' results along with inserted or deleted lines.
+/// See foldMarkAdjust() for the arguments.  Other changes clear the cache.
+static void fold_expr_cache_mark_adjust(win_T *wp, linenr_T line1, linenr_T line2,
+                                        linenr_T amount, linenr_T amount_after)
+{
+  foldexpr_cache_T *fc = &wp->w_fold_expr_cache;
+  if (fc->fc_lines == NULL) {
+    return;
+  }
+
+  if (line2 == MAXLNUM && amount > 0 && amount != MAXLNUM && amount_after == 0
+      && line1 >= 1 && line1 <= fc->fc_count + 1) {
+    // "amount" lines inserted above "line1".
+    if (fc->fc_count + amount > fc->fc_size) {
+      fc->fc_size = MAX(fc->fc_size * 2, fc->fc_count + amount);
+      fc->fc_lines = xrealloc(fc->fc_lines, (size_t)fc->fc_size * sizeof(*fc->fc_lines));
+    }
+    memmove(fc->fc_lines + line1 - 1 + amount, fc->fc_lines + line1 - 1,
+            (size_t)(fc->fc_count - line1 + 1) * sizeof(*fc->fc_lines));
+    memset(fc->fc_lines + line1 - 1, 0, (size_t)amount * sizeof(*fc->fc_lines));
+    fc->fc_count += amount;
+  } else if (amount == MAXLNUM && line1 >= 1 && line2 >= line1 && line2 <= fc->fc_count
+             && amount_after == -(line2 - line1 + 1)) {
+    // Lines "line1" to "line2" deleted.
+    memmove(fc->fc_lines + line1 - 1, fc->fc_lines + line2,
+            (size_t)(fc->fc_count - line2) * sizeof(*fc->fc_lines));
+    fc->fc_count -= line2 - line1 + 1;
+  } else {
+    fold_expr_cache_clear(wp);
+  }
+}
+
 // parseMarker() {{{2
 /// Parse 'foldmarker' and set "foldendmarker", "foldstartmarkerlen" and
 /// "foldendmarkerlen".
@@ -262,6 +262,34 @@ static void add_buff(buffheader_T *const buf, const char *const s, ptrdiff_t sle
   }
 }
 
+/// Copy the contents of "from" into the empty buffer "to" as one block.
+static void copy_buff(buffheader_T *const to, const buffheader_T *const from)
+{
+  size_t slen = 0;
+  for (const buffblock_T *bp = from->bh_first.b_next; bp != NULL; bp = bp->b_next) {
+    slen += strlen(bp->b_str);
+  }
+  if (slen == 0) {
+    return;
+  }
+
+  size_t len = MAX(slen, MINIMAL_SIZE);
+  buffblock_T *p = xmalloc(sizeof(buffblock_T) + len);
+  char *str = p->b_str;
+  for (const buffblock_T *bp = from->bh_first.b_next; bp != NULL; bp = bp->b_next) {
+    size_t n = strlen(bp->b_str);
+    memcpy(str, bp->b_str, n);
+    str += n;
+  }
+  *str = NUL;
+  p->b_next = NULL;
+
+  to->bh_first.b_next = p;
+  to->bh_curr = p;
+  to->bh_index = 0;
+  to->bh_space = len - slen;
+}
+
 /// Delete "slen" bytes from the end of "buf".
 /// Only works when it was just added.
 static void delete_buff_tail(buffheader_T *buf, int slen)
@@ -469,11 +497,7 @@ void saveRedobuff(save_redo_T *save_redo)
   old_redobuff.bh_first.b_next = NULL;
 
   // Make a copy, so that ":normal ." in a function works.
-  char *const s = (char *)get_buffcont(&save_redo->sr_redobuff, false);
-  if (s != NULL) {
-    add_buff(&redobuff, s, -1L);
-    xfree(s);
-  }
+  copy_buff(&redobuff, &save_redo->sr_redobuff);
 }
 
 /// Restore redobuff and old_redobuff from save_redobuff and save_old_redobuff.
@@ -1341,7 +1365,7 @@ void before_blocking(void)
 {
   updatescript(0);
   if (may_garbage_collect) {
-    garbage_collect(false);
+    garbage_collect_idle();
   }
 }
 
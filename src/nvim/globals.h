@@ -310,6 +310,10 @@ EXTERN except_T *caught_stack INIT(= NULL);
 EXTERN bool may_garbage_collect INIT(= false);
 EXTERN int want_garbage_collect INIT(= false);
 EXTERN int garbage_collect_at_exit INIT(= false);
+/// Number of times a List, Dictionary, Partial or function call was
+/// unreferenced without being freed since the last garbage collection.  Only
+/// then something can have become an unreachable cycle.
+EXTERN size_t gc_candidates INIT(= 0);
 
 // Special values for current_SID.
 #define SID_MODELINE    (-1)      // when using a modeline
@@ -8,14 +8,14 @@
 /// Each item in a hashtable has a NUL terminated string key. A key can appear
 /// only once in the table.
 ///
-/// A hash number is computed from the key for quick lookup. When the hashes
-/// of two different keys point to the same entry an algorithm is used to
-/// iterate over other entries in the table until the right one is found.
-/// To make the iteration work removed keys are different from entries where a
-/// key was never present.
-///
-/// The mechanism has been partly based on how Python Dictionaries are
-/// implemented. The algorithm is from Knuth Vol. 3, Sec. 6.4.
+/// A hash number is computed from the key for quick lookup. The items are
+/// split in groups of HT_GROUP_SIZE and every item has a control byte, which
+/// tells whether the item is empty, removed or used, and for a used item holds
+/// seven bits of its hash. A lookup compares the control bytes of a whole
+/// group at once (with SSE2 or NEON when available) and only compares the keys
+/// of items whose bits match. When the key isn't in a group the next group is
+/// tried, until the key is found or a group has an item where a key was never
+/// present. This is the layout of "Swiss tables" used by Abseil.
 ///
 /// The hashtable grows to accommodate more entries when needed. At least 1/3
 /// of the entries is empty to keep the lookup efficient (at the cost of extra
@@ -26,14 +26,33 @@
 #include <stdbool.h>
 #include <string.h>
 
+#if defined(__SSE2__)
+# include <emmintrin.h>
+#elif defined(__ARM_NEON)
+# include <arm_neon.h>
+#endif
+
 #include "nvim/ascii.h"
 #include "nvim/hashtab.h"
+#include "nvim/math.h"
 #include "nvim/memory.h"
 #include "nvim/message.h"
 #include "nvim/vim.h"
 
-// Magic value for algorithm that walks through the array.
-#define PERTURB_SHIFT 5
+// Values of control bytes. A used item has CTRL_USED and seven bits of the
+// hash, so that zeroed memory is a table of empty items.
+#define CTRL_EMPTY 0x00
+#define CTRL_REMOVED 0x01
+#define CTRL_USED 0x80
+
+// A GroupMask has MASK_STRIDE bits for every item in a group, the lowest of
+// them is set for the items that match.
+#if defined(__ARM_NEON) && !defined(__SSE2__)
+# define MASK_STRIDE 4
+#else
+# define MASK_STRIDE 1
+#endif
+typedef uint64_t GroupMask;
 
 #ifdef INCLUDE_GENERATED_DECLARATIONS
 # include "hashtab.c.generated.h"
@@ -47,9 +66,70 @@ void hash_init(hashtab_T *ht)
   // This zeroes all "ht_" entries and all the "hi_key" in "ht_smallarray".
   CLEAR_POINTER(ht);
   ht->ht_array = ht->ht_smallarray;
+  ht->ht_ctrl = ht->ht_smallctrl;
   ht->ht_mask = HT_INIT_SIZE - 1;
 }
 
+/// Get the items in the group with control bytes "ctrl" whose control byte
+/// is "c".
+static inline GroupMask group_match(const uint8_t *ctrl, uint8_t c)
+{
+#if defined(__SSE2__)
+  __m128i group = _mm_loadu_si128((const __m128i *)ctrl);
+  return (GroupMask)(unsigned)_mm_movemask_epi8(_mm_cmpeq_epi8(group, _mm_set1_epi8((char)c)));
+#elif defined(__ARM_NEON)
+  uint8x16_t eq = vceqq_u8(vld1q_u8(ctrl), vdupq_n_u8(c));
+  uint8x8_t nibbles = vshrn_n_u16(vreinterpretq_u16_u8(eq), 4);
+  return vget_lane_u64(vreinterpret_u64_u8(nibbles), 0) & 0x1111111111111111ULL;
+#else
+  GroupMask mask = 0;
+  for (int i = 0; i < HT_GROUP_SIZE; i++) {
+    mask |= (GroupMask)(ctrl[i] == c) << i;
+  }
+  return mask;
+#endif
+}
+
+/// Get the items in the group with control bytes "ctrl" that are empty or
+/// removed.
+static inline GroupMask group_match_free(const uint8_t *ctrl)
+{
+#if defined(__SSE2__)
+  __m128i group = _mm_loadu_si128((const __m128i *)ctrl);
+  return (GroupMask)(~(unsigned)_mm_movemask_epi8(group) & 0xffff);
+#elif defined(__ARM_NEON)
+  uint8x16_t used = vtstq_u8(vld1q_u8(ctrl), vdupq_n_u8(CTRL_USED));
+  uint8x8_t nibbles = vshrn_n_u16(vreinterpretq_u16_u8(used), 4);
+  return ~vget_lane_u64(vreinterpret_u64_u8(nibbles), 0) & 0x1111111111111111ULL;
+#else
+  GroupMask mask = 0;
+  for (int i = 0; i < HT_GROUP_SIZE; i++) {
+    mask |= (GroupMask)((ctrl[i] & CTRL_USED) == 0) << i;
+  }
+  return mask;
+#endif
+}
+
+/// Get the index in a group of the first item in "mask", which is not zero.
+static inline size_t group_mask_first(GroupMask mask)
+{
+  return (size_t)xctz(mask) / MASK_STRIDE;
+}
+
+/// Mix the bits of a hash number, so that both the group index (low bits) and
+/// the control byte (high bits) depend on all bits of it.
+static inline uint64_t hash_mix(hash_T hash)
+{
+  uint64_t h = (uint64_t)hash * 0x9E3779B97F4A7C15ULL;
+  return h ^ (h >> 32);
+}
+
+/// Get the control byte of a used item with hash number "mixed".
+static inline uint8_t hash_ctrl(uint64_t mixed)
+{
+  return (uint8_t)(CTRL_USED | (mixed >> 57));
+}
+
 /// Free the array of a hash table without freeing contained values.
 ///
 /// If "ht" is not freed (after calling this) then you should call hash_init()
@@ -57,7 +137,7 @@ void hash_init(hashtab_T *ht)
 void hash_clear(hashtab_T *ht)
 {
   if (ht->ht_array != ht->ht_smallarray) {
-    xfree(ht->ht_array);
+    xfree(ht->ht_array);  // also frees "ht_ctrl"
   }
 }
 
@@ -125,55 +205,44 @@ hashitem_T *hash_lookup(const hashtab_T *const ht, const char *const key, const
   hash_count_lookup++;
 #endif  // ifdef HT_DEBUG
 
-  // Quickly handle the most common situations:
-  // - return if there is no item at all
-  // - skip over a removed item
-  // - return if the item matches
-  hash_T idx = hash & ht->ht_mask;
-  hashitem_T *hi = &ht->ht_array[idx];
-
-  if (hi->hi_key == NULL) {
-    return hi;
-  }
-
+  // Go through the groups of items until one has an item where a key was
+  // never present: then the key isn't in the table.  The groups are visited
+  // with steps of 1, 2, 3, ..., this goes through all of them in the end.
+  // Return the first available item found (can be a removed item).
+  const uint64_t mixed = hash_mix(hash);
+  const uint8_t c = hash_ctrl(mixed);
+  const size_t group_mask = ht->ht_mask / HT_GROUP_SIZE;
+  size_t group = (size_t)mixed & group_mask;
   hashitem_T *freeitem = NULL;
-  if (hi->hi_key == HI_KEY_REMOVED) {
-    freeitem = hi;
-  } else if ((hi->hi_hash == hash)
-             && (strncmp(hi->hi_key, key, key_len) == 0)
-             && hi->hi_key[key_len] == NUL) {
-    return hi;
-  }
 
-  // Need to search through the table to find the key. The algorithm
-  // to step through the table starts with large steps, gradually becoming
-  // smaller down to (1/4 table size + 1). This means it goes through all
-  // table entries in the end.
-  // When we run into a NULL key it's clear that the key isn't there.
-  // Return the first available slot found (can be a slot of a removed
-  // item).
-  for (hash_T perturb = hash;; perturb >>= PERTURB_SHIFT) {
-#ifdef HT_DEBUG
-    // count a "miss" for hashtab lookup
-    hash_count_perturb++;
-#endif  // ifdef HT_DEBUG
-    idx = 5 * idx + perturb + 1;
-    hi = &ht->ht_array[idx & ht->ht_mask];
+  for (size_t step = 1;; step++) {
+    const uint8_t *const ctrl = ht->ht_ctrl + group * HT_GROUP_SIZE;
+    hashitem_T *const items = ht->ht_array + group * HT_GROUP_SIZE;
 
-    if (hi->hi_key == NULL) {
-      return freeitem == NULL ? hi : freeitem;
+    for (GroupMask m = group_match(ctrl, c); m != 0; m &= m - 1) {
+      hashitem_T *hi = &items[group_mask_first(m)];
+      if (hi->hi_hash == hash
+          && strncmp(hi->hi_key, key, key_len) == 0
+          && hi->hi_key[key_len] == NUL) {
+        return hi;
+      }
     }
 
-    if ((hi->hi_hash == hash)
-        && (hi->hi_key != HI_KEY_REMOVED)
-        && (strncmp(hi->hi_key, key, key_len) == 0)
-        && hi->hi_key[key_len] == NUL) {
-      return hi;
+    if (freeitem == NULL) {
+      GroupMask m = group_match_free(ctrl);
+      if (m != 0) {
+        freeitem = &items[group_mask_first(m)];
+      }
     }
-
-    if ((hi->hi_key == HI_KEY_REMOVED) && (freeitem == NULL)) {
-      freeitem = hi;
+    if (group_match(ctrl, CTRL_EMPTY) != 0) {
+      return freeitem;
     }
+
+#ifdef HT_DEBUG
+    // count a "miss" for hashtab lookup
+    hash_count_perturb++;
+#endif  // ifdef HT_DEBUG
+    group = (group + step) & group_mask;
   }
 }
 
@@ -229,6 +298,7 @@ void hash_add_item(hashtab_T *ht, hashitem_T *hi, char_u *key, hash_T hash)
   }
   hi->hi_key = (char *)key;
   hi->hi_hash = hash;
+  ht->ht_ctrl[hi - ht->ht_array] = hash_ctrl(hash_mix(hash));
 
   // When the space gets low may resize the array.
   hash_may_resize(ht, 0);
@@ -244,7 +314,17 @@ void hash_remove(hashtab_T *ht, hashitem_T *hi)
 {
   ht->ht_used--;
   ht->ht_changed++;
-  hi->hi_key = HI_KEY_REMOVED;
+  // When the group has an empty item no lookup went on to the next group
+  // because of this item, then it can become empty instead of removed.
+  const size_t idx = (size_t)(hi - ht->ht_array);
+  if (group_match(ht->ht_ctrl + idx / HT_GROUP_SIZE * HT_GROUP_SIZE, CTRL_EMPTY) != 0) {
+    ht->ht_ctrl[idx] = CTRL_EMPTY;
+    hi->hi_key = NULL;
+    ht->ht_filled--;
+  } else {
+    ht->ht_ctrl[idx] = CTRL_REMOVED;
+    hi->hi_key = HI_KEY_REMOVED;
+  }
   hash_may_resize(ht, 0);
 }
 
@@ -354,36 +434,39 @@ static void hash_may_resize(hashtab_T *ht, size_t minitems)
 
   if (newarray_is_small) {
     CLEAR_FIELD(ht->ht_smallarray);
+    CLEAR_FIELD(ht->ht_smallctrl);
   }
+  // The control bytes are after the items in the same allocation.
   hashitem_T *newarray = newarray_is_small
     ? ht->ht_smallarray
-    : xcalloc(newsize, sizeof(hashitem_T));
+    : xcalloc(newsize, sizeof(hashitem_T) + 1);
+  uint8_t *newctrl = newarray_is_small
+    ? ht->ht_smallctrl
+    : (uint8_t *)(newarray + newsize);
 
   // Move all the items from the old array to the new one, placing them in
   // the right spot. The new array won't have any removed items, thus this
   // is also a cleanup action.
   hash_T newmask = newsize - 1;
+  const size_t group_mask = newsize / HT_GROUP_SIZE - 1;
   size_t todo = ht->ht_used;
 
   for (hashitem_T *olditem = oldarray; todo > 0; olditem++) {
     if (HASHITEM_EMPTY(olditem)) {
       continue;
     }
-    // The algorithm to find the spot to add the item is identical to
-    // the algorithm to find an item in hash_lookup(). But we only
-    // need to search for a NULL key, thus it's simpler.
-    hash_T newi = olditem->hi_hash & newmask;
-    hashitem_T *newitem = &newarray[newi];
-    if (newitem->hi_key != NULL) {
-      for (hash_T perturb = olditem->hi_hash;; perturb >>= PERTURB_SHIFT) {
-        newi = 5 * newi + perturb + 1;
-        newitem = &newarray[newi & newmask];
-        if (newitem->hi_key == NULL) {
-          break;
-        }
-      }
+    // The groups are visited like in hash_lookup(), but we only need to
+    // search for an empty item, thus it's simpler.
+    const uint64_t mixed = hash_mix(olditem->hi_hash);
+    size_t group = (size_t)mixed & group_mask;
+    GroupMask m;
+    for (size_t step = 1; (m = group_match(newctrl + group * HT_GROUP_SIZE, CTRL_EMPTY)) == 0;
+         step++) {
+      group = (group + step) & group_mask;
     }
-    *newitem = *olditem;
+    const size_t newi = group * HT_GROUP_SIZE + group_mask_first(m);
+    newarray[newi] = *olditem;
+    newctrl[newi] = hash_ctrl(mixed);
     todo--;
   }
 
@@ -391,6 +474,7 @@ static void hash_may_resize(hashtab_T *ht, size_t minitems)
     xfree(ht->ht_array);
   }
   ht->ht_array = newarray;
+  ht->ht_ctrl = newctrl;
   ht->ht_mask = newmask;
   ht->ht_filled = ht->ht_used;
   ht->ht_changed++;
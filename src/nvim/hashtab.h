@@ -2,6 +2,7 @@
 #define NVIM_HASHTAB_H
 
 #include <stddef.h>
+#include <stdint.h>
 
 #include "nvim/types.h"
 
@@ -50,10 +51,13 @@ typedef struct hashitem_S {
 
 /// Initial size for a hashtable.
 /// Our items are relatively small and growing is expensive, thus start with 16.
-/// Must be a power of 2.
+/// Must be a power of 2 and a multiple of HT_GROUP_SIZE.
 /// This allows for storing 10 items (2/3 of 16) before a resize is needed.
 #define HT_INIT_SIZE 16
 
+/// Number of items whose control bytes are checked at once.
+#define HT_GROUP_SIZE 16
+
 /// An array-based hashtable.
 ///
 /// Keys are NUL terminated strings. They cannot be repeated within a table.
@@ -69,7 +73,10 @@ typedef struct hashtable_S {
   int ht_locked;                ///< counter for hash_lock()
   hashitem_T *ht_array;         ///< points to the array, allocated when it's
                                 ///< not "ht_smallarray"
+  uint8_t *ht_ctrl;             ///< control byte for each item in "ht_array",
+                                ///< allocated together with it
   hashitem_T ht_smallarray[HT_INIT_SIZE];      ///< initial array
+  uint8_t ht_smallctrl[HT_INIT_SIZE];          ///< control bytes of "ht_smallarray"
 } hashtab_T;
 
 /// Iterate over a hashtab
@@ -0,0 +1,100 @@
+// This is an open source non-commercial project. Dear PVS-Studio, please check
+// it. PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+
+#include <stdint.h>
+#include <string.h>
+
+#include "nvim/func_attr.h"
+#include "nvim/histogram.h"
+#include "nvim/math.h"
+
+#ifdef INCLUDE_GENERATED_DECLARATIONS
+# include "histogram.c.generated.h"
+#endif
+
+#define SUB_COUNT (1 << HISTOGRAM_SUB_BITS)
+#define SUB_MASK ((uint64_t)SUB_COUNT - 1)
+
+/// Gets the bucket index that `value` is counted in.
+static inline int histogram_index(uint64_t value)
+  FUNC_ATTR_CONST
+{
+  if (value < SUB_COUNT) {
+    return (int)value;
+  }
+  int shift = xlog2(value) - HISTOGRAM_SUB_BITS;
+  return ((shift + 1) << HISTOGRAM_SUB_BITS) + (int)((value >> shift) & SUB_MASK);
+}
+
+/// Gets the largest value that is counted in bucket `idx`.
+static uint64_t histogram_bucket_max(int idx)
+  FUNC_ATTR_CONST
+{
+  if (idx < SUB_COUNT) {
+    return (uint64_t)idx;
+  }
+  int shift = (idx >> HISTOGRAM_SUB_BITS) - 1;
+  uint64_t lower = ((uint64_t)SUB_COUNT | ((uint64_t)idx & SUB_MASK)) << shift;
+  return lower + (((uint64_t)1 << shift) - 1);
+}
+
+void histogram_reset(Histogram *h)
+  FUNC_ATTR_NONNULL_ALL
+{
+  memset(h, 0, sizeof(*h));
+}
+
+void histogram_record(Histogram *h, uint64_t value)
+  FUNC_ATTR_NONNULL_ALL
+{
+  uint32_t *bucket = &h->buckets[histogram_index(value)];
+  if (*bucket < UINT32_MAX) {
+    (*bucket)++;
+  }
+  if (h->count == 0 || value < h->min) {
+    h->min = value;
+  }
+  if (value > h->max) {
+    h->max = value;
+  }
+  h->count++;
+  h->sum += value;
+}
+
+/// Gets the value below which `percent` of the recorded samples fall.
+///
+/// The result is the upper bound of the bucket containing the sample, clamped
+/// to the largest recorded value.
+///
+/// @param percent  Percentile in the range 0-100.
+/// @return percentile value, or 0 if nothing was recorded.
+uint64_t histogram_percentile(const Histogram *h, double percent)
+  FUNC_ATTR_NONNULL_ALL FUNC_ATTR_PURE
+{
+  if (h->count == 0) {
+    return 0;
+  }
+  if (percent >= 100.0) {
+    return h->max;
+  }
+  uint64_t wanted = (uint64_t)((double)h->count * (percent > 0 ? percent : 0) / 100.0);
+  if (wanted == 0) {
+    wanted = 1;
+  }
+  uint64_t seen = 0;
+  for (int i = 0; i < HISTOGRAM_BUCKETS; i++) {
+    seen += h->buckets[i];
+    if (seen >= wanted) {
+      uint64_t rv = histogram_bucket_max(i);
+      return rv < h->max ? rv : h->max;
+    }
+  }
+  return h->max;
+}
+
+/// Gets the arithmetic mean of the recorded samples.
+uint64_t histogram_mean(const Histogram *h)
+  FUNC_ATTR_NONNULL_ALL FUNC_ATTR_PURE
+{
+  return h->count ? h->sum / h->count : 0;
+}
@@ -0,0 +1,28 @@
+#ifndef NVIM_HISTOGRAM_H
+#define NVIM_HISTOGRAM_H
+
+#include <stdint.h>
+
+// Log-linear ("HDR style") histogram of non-negative integer samples.
+//
+// Values below 2^HISTOGRAM_SUB_BITS get a bucket each, larger values are
+// split into 2^HISTOGRAM_SUB_BITS linear sub-buckets per power of two, so the
+// relative error of a reported value is bounded by 2^-HISTOGRAM_SUB_BITS
+// regardless of magnitude. Recording is a handful of integer operations and
+// never allocates.
+
+#define HISTOGRAM_SUB_BITS 4
+#define HISTOGRAM_BUCKETS ((64 - HISTOGRAM_SUB_BITS + 1) << HISTOGRAM_SUB_BITS)
+
+typedef struct {
+  uint64_t count;
+  uint64_t sum;
+  uint64_t min;
+  uint64_t max;
+  uint32_t buckets[HISTOGRAM_BUCKETS];
+} Histogram;
+
+#ifdef INCLUDE_GENERATED_DECLARATIONS
+# include "histogram.h.generated.h"
+#endif
+#endif  // NVIM_HISTOGRAM_H
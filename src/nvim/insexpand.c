@@ -39,6 +39,7 @@
 #include "nvim/insexpand.h"
 #include "nvim/keycodes.h"
 #include "nvim/macros.h"
+#include "nvim/map.h"
 #include "nvim/mark.h"
 #include "nvim/mbyte.h"
 #include "nvim/memline.h"
@@ -171,8 +172,20 @@ typedef struct {
   bool found_all;         ///< found all matches of a certain type.
   char_u *dict;           ///< dictionary file to search
   int dict_f;             ///< "dict" is an exact file name or not
+  size_t word_idx;        ///< next word in the word index of "ins_buf"
 } ins_compl_next_state_T;
 
+/// Words of a buffer, used for ^N/^P in a buffer that isn't the current one
+/// instead of searching its text for every match.  Made when the buffer is
+/// scanned and kept until the text or 'iskeyword' changes.
+struct compl_index_S {
+  varnumber_T ci_changedtick;  ///< b:changedtick the index was made for
+  uint64_t ci_chartab[4];      ///< b_chartab the index was made with
+  char **ci_words;             ///< each word once, in order of appearance
+  uint32_t *ci_backward;       ///< "ci_words" indexes, last appearance first
+  size_t ci_count;             ///< number of words
+};
+
 #ifdef INCLUDE_GENERATED_DECLARATIONS
 # include "insexpand.c.generated.h"
 #endif
@@ -202,6 +215,10 @@ static compl_T *compl_curr_match = NULL;
 static compl_T *compl_shown_match = NULL;
 static compl_T *compl_old_match = NULL;
 
+/// Text of the matches in the list, to find duplicates without going through
+/// the whole list.  Keys are the "cp_str" of the matches.
+static Map(cstr_t, ptr_t) compl_match_strs = MAP_INIT;
+
 /// After using a cursor key <Enter> selects a match in the popup menu,
 /// otherwise it inserts a line break.
 static bool compl_enter_selects = false;
@@ -796,18 +813,12 @@ static int ins_compl_add(char *const str, int len, char *const fname, char *cons
     len = (int)strlen(str);
   }
 
+  char *cp_str = str[len] == NUL ? NULL : xstrnsave(str, (size_t)len);
   // If the same match is already present, don't add it.
-  if (compl_first_match != NULL && !adup) {
-    match = compl_first_match;
-    do {
-      if (!match_at_original_text(match)
-          && strncmp(match->cp_str, str, (size_t)len) == 0
-          && ((int)strlen(match->cp_str) <= len || match->cp_str[len] == NUL)) {
-        FREE_CPTEXT(cptext, cptext_allocated);
-        return NOTDONE;
-      }
-      match = match->cp_next;
-    } while (match != NULL && !is_first_match(match));
+  if (!adup && map_has(cstr_t, ptr_t)(&compl_match_strs, cp_str != NULL ? cp_str : str)) {
+    xfree(cp_str);
+    FREE_CPTEXT(cptext, cptext_allocated);
+    return NOTDONE;
   }
 
   // Remove any popup menu before changing the list of matches.
@@ -820,7 +831,10 @@ static int ins_compl_add(char *const str, int len, char *const fname, char *cons
   if (flags & CP_ORIGINAL_TEXT) {
     match->cp_number = 0;
   }
-  match->cp_str = xstrnsave(str, (size_t)len);
+  match->cp_str = cp_str != NULL ? cp_str : xstrnsave(str, (size_t)len);
+  if (!(flags & CP_ORIGINAL_TEXT)) {
+    map_put(cstr_t, ptr_t)(&compl_match_strs, match->cp_str, match);
+  }
 
   // match-fname is:
   // - compl_curr_match->cp_fname if it is a string equal to fname.
@@ -1556,6 +1570,7 @@ static void ins_compl_free(void)
 
   ins_compl_del_pum();
   pum_clear();
+  map_clear(cstr_t, ptr_t)(&compl_match_strs);
 
   compl_curr_match = compl_first_match;
   do {
@@ -2864,6 +2879,7 @@ static int process_next_cpt_value(ins_compl_next_state_T *st, int *compl_type_ar
     // Scan a buffer, but not the current one.
     if (st->ins_buf->b_ml.ml_mfp != NULL) {  // loaded buffer
       compl_started = true;
+      st->word_idx = 0;
       st->first_match_pos.col = st->last_match_pos.col = 0;
       st->first_match_pos.lnum = st->ins_buf->b_ml.ml_line_count + 1;
       st->last_match_pos.lnum = 0;
@@ -3152,6 +3168,12 @@ static int get_next_default_completion(ins_compl_next_state_T *st, pos_T *start_
   }
   bool looped_around = false;
   int found_new_match = FAIL;
+  if (ins_compl_can_use_index(st->ins_buf)) {
+    found_new_match = get_next_indexed_completion(st);
+    p_scs = save_p_scs;
+    p_ws = save_p_ws;
+    return found_new_match;
+  }
   for (;;) {
     bool cont_s_ipos = false;
 
@@ -3225,6 +3247,153 @@ static int get_next_default_completion(ins_compl_next_state_T *st, pos_T *start_
   return found_new_match;
 }
 
+/// Check whether keyword completion can use the word index of buffer "buf"
+/// instead of searching it.  The words in the index are what searching for
+/// "\<" followed by the completed text would find, when "buf" and the current
+/// buffer use the same 'iskeyword'.
+static bool ins_compl_can_use_index(buf_T *buf)
+{
+  return buf != curbuf
+         && ctrl_x_mode_normal()
+         && !compl_status_adding()
+         && (compl_cont_status & CONT_SOL) == 0
+         && compl_length >= 2
+         && compl_orig_text != NULL
+         && memcmp(buf->b_chartab, curbuf->b_chartab, sizeof(buf->b_chartab)) == 0;
+}
+
+/// Get the word index of buffer "buf", making it when needed.
+///
+/// @return  NULL when interrupted.
+static compl_index_T *ins_compl_get_index(buf_T *buf)
+{
+  compl_index_T *ci = buf->b_compl_index;
+  if (ci != NULL && ci->ci_changedtick == buf_get_changedtick(buf)
+      && memcmp(ci->ci_chartab, buf->b_chartab, sizeof(ci->ci_chartab)) == 0) {
+    return ci;
+  }
+  ins_compl_free_index(buf);
+
+  Map(cstr_t, int) seen = MAP_INIT;  // word -> its index + 1
+  garray_T words;                    // char * of each word
+  garray_T order;                    // word index of each occurrence
+  ga_init(&words, (int)sizeof(char *), 256);
+  ga_init(&order, (int)sizeof(uint32_t), 1024);
+  char *key = NULL;
+  size_t keysize = 0;
+
+  for (linenr_T lnum = 1; lnum <= buf->b_ml.ml_line_count && !got_int; lnum++) {
+    char_u *p = (char_u *)ml_get_buf(buf, lnum, false);
+    // A word is a sequence of characters of the same class, like what
+    // find_word_end() finds after a match of "\<".
+    while (*p != NUL) {
+      const int cls = mb_get_class_tab(p, buf->b_chartab);
+      char_u *start = p;
+      p += utfc_ptr2len((char *)p);
+      if (cls <= 1) {
+        continue;
+      }
+      while (*p != NUL && mb_get_class_tab(p, buf->b_chartab) == cls) {
+        p += utfc_ptr2len((char *)p);
+      }
+
+      const size_t len = (size_t)(p - start);
+      if (len >= keysize) {
+        keysize = len + 64;
+        key = xrealloc(key, keysize);
+      }
+      memcpy(key, start, len);
+      key[len] = NUL;
+      int idx = map_get(cstr_t, int)(&seen, key);
+      if (idx == 0) {
+        char *word = xmemdupz(start, len);
+        GA_APPEND(char *, &words, word);
+        idx = words.ga_len;
+        map_put(cstr_t, int)(&seen, word, idx);
+      }
+      GA_APPEND(uint32_t, &order, (uint32_t)idx - 1);
+    }
+    if ((lnum & 0xff) == 0) {
+      fast_breakcheck();
+    }
+  }
+  map_destroy(cstr_t, int)(&seen);
+  xfree(key);
+
+  if (got_int) {
+    ga_clear_strings(&words);
+    ga_clear(&order);
+    return NULL;
+  }
+
+  // Searching backward finds the last appearance of a word first.
+  ci = xmalloc(sizeof(*ci));
+  ci->ci_changedtick = buf_get_changedtick(buf);
+  memcpy(ci->ci_chartab, buf->b_chartab, sizeof(ci->ci_chartab));
+  ci->ci_count = (size_t)words.ga_len;
+  ci->ci_words = words.ga_data;
+  ci->ci_backward = xmalloc(MAX(ci->ci_count, 1) * sizeof(uint32_t));
+  bool *taken = xcalloc(MAX(ci->ci_count, 1), sizeof(bool));
+  size_t n = 0;
+  for (int i = order.ga_len - 1; i >= 0; i--) {
+    const uint32_t w = ((uint32_t *)order.ga_data)[i];
+    if (!taken[w]) {
+      taken[w] = true;
+      ci->ci_backward[n++] = w;
+    }
+  }
+  xfree(taken);
+  ga_clear(&order);
+
+  buf->b_compl_index = ci;
+  return ci;
+}
+
+/// Free the word index of buffer "buf".
+void ins_compl_free_index(buf_T *buf)
+  FUNC_ATTR_NONNULL_ALL
+{
+  compl_index_T *ci = buf->b_compl_index;
+  if (ci == NULL) {
+    return;
+  }
+  for (size_t i = 0; i < ci->ci_count; i++) {
+    xfree(ci->ci_words[i]);
+  }
+  xfree(ci->ci_words);
+  xfree(ci->ci_backward);
+  XFREE_CLEAR(buf->b_compl_index);
+}
+
+/// Get the next word from the word index of "st->ins_buf" that starts with
+/// the completed text.
+///
+/// @return  OK if a new match is found, otherwise FAIL.
+static int get_next_indexed_completion(ins_compl_next_state_T *st)
+{
+  compl_index_T *ci = ins_compl_get_index(st->ins_buf);
+  if (ci == NULL) {
+    return FAIL;
+  }
+  // Same as what searchit() uses for "compl_pattern".
+  const bool ic = ignorecase((char_u *)compl_pattern);
+  const size_t len = strlen(compl_orig_text);
+
+  while (st->word_idx < ci->ci_count) {
+    const size_t i = st->word_idx++;
+    char *word = ci->ci_words[compl_dir_forward() ? i : ci->ci_backward[i]];
+    if ((ic ? mb_strnicmp(word, compl_orig_text, len)
+         : strncmp(word, compl_orig_text, len)) != 0) {
+      continue;
+    }
+    if (ins_compl_add_infercase((char_u *)word, (int)strlen(word), p_ic,
+                                (char_u *)st->ins_buf->b_sfname, 0, false) != NOTDONE) {
+      return OK;
+    }
+  }
+  return FAIL;
+}
+
 /// get the next set of completion matches for "type".
 /// @return  true if a new match is found, otherwise false.
 static bool get_next_completion_match(int type, ins_compl_next_state_T *st, pos_T *ini)
@@ -4474,6 +4643,7 @@ static unsigned quote_meta(char_u *dest, char_u *src, int len)
 void free_insexpand_stuff(void)
 {
   XFREE_CLEAR(compl_orig_text);
+  map_destroy(cstr_t, ptr_t)(&compl_match_strs);
   callback_free(&cfu_cb);
   callback_free(&ofu_cb);
   callback_free(&tsrfu_cb);
@@ -0,0 +1,88 @@
+// This is an open source non-commercial project. Dear PVS-Studio, please check
+// it. PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+
+/// @file json_scan.c
+///
+/// Scanning of JSON strings, shared by json_decode()/json_encode() and the
+/// vim.json (lua-cjson) module.
+///
+/// Most bytes of a JSON string need no processing at all: they are neither an
+/// escape, a quote nor a control character. These runs are found 16 bytes at
+/// a time (with SSE2 or NEON when available), so that the callers only look
+/// at the remaining bytes one by one and copy the runs with a single memcpy().
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#if defined(__SSE2__)
+# include <emmintrin.h>
+#elif defined(__ARM_NEON)
+# include <arm_neon.h>
+#endif
+
+#include "nvim/json_scan.h"
+#include "nvim/math.h"
+
+#ifdef INCLUDE_GENERATED_DECLARATIONS
+# include "json_scan.c.generated.h"
+#endif
+
+/// Gets the number of bytes at the start of `s` that can be copied to or from
+/// a JSON string as they are: all bytes except control characters, DEL, '"'
+/// and '\'.
+///
+/// @param  s  Bytes to scan, need not be NUL-terminated.
+/// @param  len  Number of bytes at `s`.
+/// @param  ascii_only  Also stop at bytes above 0x7F, for callers that check
+///                     or convert multibyte characters themselves.
+///
+/// @return length of the run, `len` if it covers all of `s`.
+size_t json_plain_len(const char *s, size_t len, bool ascii_only)
+  FUNC_ATTR_NONNULL_ALL FUNC_ATTR_PURE
+{
+  size_t i = 0;
+#if defined(__SSE2__)
+  const __m128i quote = _mm_set1_epi8('"');
+  const __m128i backslash = _mm_set1_epi8('\\');
+  const __m128i del = _mm_set1_epi8(0x7F);
+  const __m128i ctrl_max = _mm_set1_epi8(0x1F);
+  for (; i + 16 <= len; i += 16) {
+    __m128i v = _mm_loadu_si128((const __m128i *)(s + i));
+    __m128i stop = _mm_or_si128(_mm_cmpeq_epi8(v, quote), _mm_cmpeq_epi8(v, backslash));
+    stop = _mm_or_si128(stop, _mm_cmpeq_epi8(v, del));
+    // There is no unsigned compare: a byte is at most 0x1F if it is its minimum with 0x1F.
+    stop = _mm_or_si128(stop, _mm_cmpeq_epi8(_mm_min_epu8(v, ctrl_max), v));
+    unsigned mask = (unsigned)_mm_movemask_epi8(stop);
+    if (ascii_only) {
+      mask |= (unsigned)_mm_movemask_epi8(v);
+    }
+    if (mask != 0) {
+      return i + (size_t)xctz(mask);
+    }
+  }
+#elif defined(__ARM_NEON)
+  for (; i + 16 <= len; i += 16) {
+    uint8x16_t v = vld1q_u8((const uint8_t *)s + i);
+    uint8x16_t stop = vorrq_u8(vceqq_u8(v, vdupq_n_u8('"')), vceqq_u8(v, vdupq_n_u8('\\')));
+    stop = vorrq_u8(stop, vceqq_u8(v, vdupq_n_u8(0x7F)));
+    stop = vorrq_u8(stop, vcltq_u8(v, vdupq_n_u8(0x20)));
+    if (ascii_only) {
+      stop = vorrq_u8(stop, vcgeq_u8(v, vdupq_n_u8(0x80)));
+    }
+    // Four bits for every byte, see group_match() in hashtab.c.
+    uint8x8_t nibbles = vshrn_n_u16(vreinterpretq_u16_u8(stop), 4);
+    uint64_t mask = vget_lane_u64(vreinterpret_u64_u8(nibbles), 0);
+    if (mask != 0) {
+      return i + (size_t)xctz(mask) / 4;
+    }
+  }
+#endif
+  for (; i < len; i++) {
+    const uint8_t c = (uint8_t)s[i];
+    if (c < 0x20 || c == '"' || c == '\\' || c == 0x7F || (ascii_only && c > 0x7F)) {
+      break;
+    }
+  }
+  return i;
+}
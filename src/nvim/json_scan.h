@@ -0,0 +1,10 @@
+#ifndef NVIM_JSON_SCAN_H
+#define NVIM_JSON_SCAN_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#ifdef INCLUDE_GENERATED_DECLARATIONS
+# include "json_scan.h.generated.h"
+#endif
+#endif  // NVIM_JSON_SCAN_H
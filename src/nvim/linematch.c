@@ -4,21 +4,58 @@
 #include <assert.h>
 #include <stdbool.h>
 #include <stddef.h>
+#include <stdint.h>
 #include <string.h>
 
+#include "klib/kvec.h"
 #include "nvim/linematch.h"
 #include "nvim/macros.h"
 #include "nvim/memory.h"
 #include "nvim/vim.h"
 
-// struct for running the diff linematch algorithm
+#define LN_MAX_BUFS 8
+#define MATCH_CHAR_MAX_LEN 800
+
+/// Lines of the diff block of one buffer.
 typedef struct {
-  int *df_decision;  // to keep track of this path traveled
-  int df_lev_score;  // to keep track of the total score of this path
-  size_t df_path_idx;   // current index of this path
-} diffcmppath_T;
+  const char **line;  ///< start of each line, not NUL terminated
+  int *len;  ///< length of each line
+  int count;  ///< number of lines
+  char *stripped;  ///< text of the lines without whitespace, when ignoring it
+} lmblock_T;
 
-#define LN_MAX_BUFS 8
+/// Cached result of matching_chars() for a pair of lines.
+typedef struct {
+  uint64_t key;  ///< 0 for an unused slot
+  int value;
+} lmcache_T;
+
+#define LM_CACHE_BITS 17
+
+/// State of one linematch_nbuffers() call.
+typedef struct {
+  size_t ndiffs;
+  lmblock_T blk[LN_MAX_BUFS];
+  int *memo[LN_MAX_BUFS][LN_MAX_BUFS];  ///< matches for every pair of lines, -1 if unknown
+  lmcache_T *cache;  ///< used instead of "memo" when that does not fit
+  size_t budget;
+  kvec_t(int) decisions;
+} linematch_T;
+
+/// Part of the tensor that is searched by one run of linematch_dp().
+///
+/// The block with the most lines is the "driving" dimension. For every line
+/// of it a slice of the tensor is stored, which only covers the cells within
+/// "band" lines of the diagonal for the other blocks.
+typedef struct {
+  int start[LN_MAX_BUFS];  ///< first line of the range, per block
+  int len[LN_MAX_BUFS];  ///< number of lines in the range, per block
+  size_t drv;  ///< the driving block
+  int band;
+  int width[LN_MAX_BUFS];  ///< cells of a slice along each block
+  size_t stride[LN_MAX_BUFS];
+  size_t slice;  ///< number of cells in a slice
+} lmrange_T;
 
 #ifdef INCLUDE_GENERATED_DECLARATIONS
 # include "linematch.c.generated.h"
@@ -33,60 +70,57 @@ static size_t line_len(const char *s)
   return strlen(s);
 }
 
-/// Same as matching_chars but ignore whitespace
+/// Find the lines of a diff block. When "iwhite" is set, the lines are copied
+/// without the white space characters, so it is only removed once per line.
 ///
-/// @param s1
-/// @param s2
-static int matching_chars_iwhite(const char *s1, const char *s2)
+/// @param b
+/// @param text  first line of the block
+/// @param count  number of lines in the block
+/// @param iwhite
+static void lmblock_init(lmblock_T *b, const char *text, int count, bool iwhite)
 {
-  // the newly processed strings that will be compared
-  // delete the white space characters, and/or replace all upper case with lower
-  char *strsproc[2];
-  const char *strsorig[2] = { s1, s2 };
-  for (int k = 0; k < 2; k++) {
-    size_t d = 0;
-    size_t i = 0;
-    size_t slen = line_len(strsorig[k]);
-    strsproc[k] = xmalloc((slen + 1) * sizeof(char));
-    while (d + i < slen) {
-      char e = strsorig[k][i + d];
-      if (e != ' ' && e != '\t') {
-        strsproc[k][i] = e;
-        i++;
-      } else {
-        d++;
+  b->line = xmalloc(((size_t)count + 1) * sizeof(*b->line));
+  b->len = xmalloc(((size_t)count + 1) * sizeof(*b->len));
+  b->stripped = NULL;
+  b->count = count;
+
+  const char *p = text;
+  size_t total = 0;
+  for (int i = 0; i < count; i++) {
+    size_t len = line_len(p);
+    b->line[i] = p;
+    b->len[i] = (int)MIN(len, MATCH_CHAR_MAX_LEN);
+    total += len;
+    p += len;
+    if (*p == '\n') {
+      p++;
+    }
+  }
+  if (!iwhite) {
+    return;
+  }
+
+  char *d = b->stripped = xmalloc(total + 1);
+  for (int i = 0; i < count; i++) {
+    const char *s = b->line[i];
+    const char *e = s + line_len(s);
+    b->line[i] = d;
+    for (; s < e; s++) {
+      if (*s != ' ' && *s != '\t') {
+        *d++ = *s;
       }
     }
-    strsproc[k][i] = '\0';
+    b->len[i] = (int)MIN((size_t)(d - b->line[i]), MATCH_CHAR_MAX_LEN);
   }
-  int matching = matching_chars(strsproc[0], strsproc[1]);
-  xfree(strsproc[0]);
-  xfree(strsproc[1]);
-  return matching;
 }
 
-/// update the path of a point in the diff linematch algorithm
-/// @param diffcmppath
-/// @param score
-/// @param to
-/// @param from
-/// @param choice
-static void update_path_flat(diffcmppath_T *diffcmppath, int score, size_t to, size_t from,
-                             const int choice)
+static void lmblock_free(lmblock_T *b)
 {
-  size_t path_idx = diffcmppath[from].df_path_idx;
-
-  for (size_t k = 0; k < path_idx; k++) {
-    diffcmppath[to].df_decision[k] = diffcmppath[from].df_decision[k];
-  }
-
-  diffcmppath[to].df_decision[path_idx] = choice;
-  diffcmppath[to].df_lev_score = score;
-  diffcmppath[to].df_path_idx = path_idx + 1;
+  xfree(b->line);
+  xfree(b->len);
+  xfree(b->stripped);
 }
 
-#define MATCH_CHAR_MAX_LEN 800
-
 /// Return matching characters between "s1" and "s2" whilst respecting sequence order.
 /// Consider the case of two strings 'AAACCC' and 'CCCAAA', the
 /// return value from this function will be 3, either to match
@@ -99,18 +133,24 @@ static void update_path_flat(diffcmppath_T *diffcmppath, int score, size_t to, s
 ///                                                      // but only at most 1 in sequence
 ///
 /// @param s1
+/// @param s1len  length of "s1", only the first MATCH_CHAR_MAX_LEN - 1 characters are used
 /// @param s2
-static int matching_chars(const char *s1, const char *s2)
+/// @param s2len
+static int matching_chars(const char *s1, int s1len, const char *s2, int s2len)
 {
-  size_t s1len = MIN(MATCH_CHAR_MAX_LEN - 1, line_len(s1));
-  size_t s2len = MIN(MATCH_CHAR_MAX_LEN - 1, line_len(s2));
-  int matrix[2][MATCH_CHAR_MAX_LEN] = { 0 };
+  s1len = MIN(MATCH_CHAR_MAX_LEN - 1, s1len);
+  s2len = MIN(MATCH_CHAR_MAX_LEN - 1, s2len);
+  int matrix[2][MATCH_CHAR_MAX_LEN];
+  // A row is only ever raised to the values of the row before it, so the
+  // stale values of two rows back do no harm and only the start is cleared.
+  memset(matrix[0], 0, ((size_t)s2len + 1) * sizeof(int));
+  memset(matrix[1], 0, ((size_t)s2len + 1) * sizeof(int));
   bool icur = 1;  // save space by storing only two rows for i axis
-  for (size_t i = 0; i < s1len; i++) {
+  for (int i = 0; i < s1len; i++) {
     icur = !icur;
     int *e1 = matrix[icur];
     int *e2 = matrix[!icur];
-    for (size_t j = 0; j < s2len; j++) {
+    for (int j = 0; j < s2len; j++) {
       // skip char in s1
       if (e2[j + 1] > e1[j + 1]) {
         e1[j + 1] = e2[j + 1];
@@ -128,23 +168,51 @@ static int matching_chars(const char *s1, const char *s2)
   return matrix[icur][s2len];
 }
 
-/// count the matching characters between a variable number of strings "sp"
-/// mark the strings that have already been compared to extract them later
-/// without re-running the character match counting.
-/// @param sp
-/// @param fomvals
-/// @param n
-static int count_n_matched_chars(const char **sp, const size_t n, bool iwhite)
+/// matching_chars() of line "i" of block "p" and line "j" of block "q",
+/// looked up in a cache first. Neighbouring cells of the tensor compare the
+/// same lines many times.
+static int lm_matching_chars(linematch_T *lm, size_t p, int i, size_t q, int j)
+{
+  int *m = lm->memo[p][q];
+  if (m != NULL) {
+    m += (size_t)i * (size_t)lm->blk[q].count + (size_t)j;
+    if (*m < 0) {
+      *m = matching_chars(lm->blk[p].line[i], lm->blk[p].len[i],
+                          lm->blk[q].line[j], lm->blk[q].len[j]);
+    }
+    return *m;
+  }
+
+  assert(i >= 0 && i < (1 << 28) && j >= 0 && j < (1 << 28));
+  uint64_t key = ((((uint64_t)p * LN_MAX_BUFS + q) << 56)
+                  | ((uint64_t)i << 28) | (uint64_t)j) + 1;
+  lmcache_T *c = &lm->cache[(key * 0x9E3779B97F4A7C15ULL) >> (64 - LM_CACHE_BITS)];
+  if (c->key != key) {
+    c->key = key;
+    c->value = matching_chars(lm->blk[p].line[i], lm->blk[p].len[i],
+                              lm->blk[q].line[j], lm->blk[q].len[j]);
+  }
+  return c->value;
+}
+
+/// count the matching characters between the lines that are compared by
+/// "choice", from the matches between every pair of lines in "pairs"
+/// @param pairs
+/// @param ndiffs
+/// @param choice
+static int count_n_matched_chars(int pairs[LN_MAX_BUFS][LN_MAX_BUFS], const size_t ndiffs,
+                                 int choice)
 {
   int matched_chars = 0;
   int matched = 0;
-  for (size_t i = 0; i < n; i++) {
-    for (size_t j = i + 1; j < n; j++) {
-      if (sp[i] != NULL && sp[j] != NULL) {
+  for (size_t i = 0; i < ndiffs; i++) {
+    if (!(choice & (1 << i))) {
+      continue;
+    }
+    for (size_t j = i + 1; j < ndiffs; j++) {
+      if (choice & (1 << j)) {
         matched++;
-        // TODO(lewis6991): handle whitespace ignoring higher up in the stack
-        matched_chars += iwhite ? matching_chars_iwhite(sp[i], sp[j])
-                                : matching_chars(sp[i], sp[j]);
+        matched_chars += pairs[i][j];
       }
     }
   }
@@ -166,126 +234,257 @@ void fastforward_buf_to_lnum(const char **s, long lnum)
   }
 }
 
-/// try all the different ways to compare these lines and use the one that
-/// results in the most matching characters
-/// @param df_iters
-/// @param paths
-/// @param npaths
-/// @param path_idx
-/// @param choice
-/// @param diffcmppath
-/// @param diff_len
-/// @param ndiffs
-/// @param diff_blk
-static void try_possible_paths(const int *df_iters, const size_t *paths, const int npaths,
-                               const int path_idx, int *choice, diffcmppath_T *diffcmppath,
-                               const int *diff_len, const size_t ndiffs, const char **diff_blk,
-                               bool iwhite)
+/// Set the band of "r" and compute the layout of a slice.
+///
+/// @return bytes needed by linematch_dp() for "r", SIZE_MAX on overflow
+static size_t lmrange_set_band(lmrange_T *r, size_t ndiffs, int band)
 {
-  if (path_idx == npaths) {
-    if ((*choice) > 0) {
-      int from_vals[LN_MAX_BUFS];
-      const int *to_vals = df_iters;
-      const char *current_lines[LN_MAX_BUFS];
+  r->band = band;
+  r->slice = 1;
+  for (size_t k = ndiffs; k-- > 0;) {
+    if (k == r->drv) {
+      r->width[k] = 1;
+      r->stride[k] = 0;
+      continue;
+    }
+    r->width[k] = MIN(2 * band + 1, r->len[k] + 1);
+    r->stride[k] = r->slice;
+    if (r->slice > SIZE_MAX / 8 / (size_t)r->width[k]) {
+      return SIZE_MAX;
+    }
+    r->slice *= (size_t)r->width[k];
+  }
+  size_t nslices = (size_t)r->len[r->drv] + 1;
+  if (r->slice > SIZE_MAX / 8 / nslices) {
+    return SIZE_MAX;
+  }
+  // one choice per cell, and two slices of scores
+  return nslices * r->slice + 2 * r->slice * sizeof(int);
+}
+
+/// First line of block "k" that is stored in the slice for line "i" of the
+/// driving block. The band follows the straight line between the corners.
+static int lmrange_base(const lmrange_T *r, size_t k, int i)
+{
+  const int maxlen = r->len[r->drv];
+  int center = (int)(((int64_t)i * r->len[k] + maxlen / 2) / maxlen);
+  return MAX(0, MIN(center - r->band, r->len[k] + 1 - r->width[k]));
+}
+
+/// Find the best path through the tensor of "r" and append its decisions to
+/// "lm->decisions".
+///
+/// The cells are computed one slice after another; a cell only depends on
+/// cells of its own and the previous slice, so only two slices of scores are
+/// kept. For every cell the choice that led to it is stored in a byte, which
+/// is enough to walk the best path back from the last cell.
+static void linematch_dp(linematch_T *lm, const lmrange_T *r)
+{
+  const size_t ndiffs = lm->ndiffs;
+  const size_t drv = r->drv;
+  const int maxlen = r->len[drv];
+  const int nchoices = 1 << ndiffs;
+  uint8_t *choices = xmalloc(((size_t)maxlen + 1) * r->slice);
+  int *scores[2] = { xmalloc(r->slice * sizeof(int)), xmalloc(r->slice * sizeof(int)) };
+  int bases[2][LN_MAX_BUFS] = { { 0 } };
+
+  // Where the cell that a choice comes from is, relative to the current cell,
+  // and which edges of the slice the current cell must not be on.
+  ptrdiff_t from_off[1 << LN_MAX_BUFS];
+  int low_edge[1 << LN_MAX_BUFS];
+  int high_edge[1 << LN_MAX_BUFS];
+
+  for (int i = 0; i <= maxlen; i++) {
+    int *cur = scores[i & 1];
+    const int *prev = scores[!(i & 1)];
+    int *base = bases[i & 1];
+    const int *prev_base = bases[!(i & 1)];
+    int shifted = 0;
+    for (size_t k = 0; k < ndiffs; k++) {
+      if (k != drv) {
+        base[k] = lmrange_base(r, k, i);
+        assert(i == 0 || base[k] - prev_base[k] <= 1);
+        if (i > 0 && base[k] != prev_base[k]) {
+          shifted |= 1 << k;
+        }
+      }
+    }
+    for (int choice = 1; choice < nchoices; choice++) {
+      const int moved = choice & ~(1 << drv);
+      const int shift = (choice & (1 << drv)) ? shifted : 0;
+      from_off[choice] = 0;
+      for (size_t k = 0; k < ndiffs; k++) {
+        from_off[choice] += (ptrdiff_t)(((shift >> k) & 1) - ((moved >> k) & 1))
+                            * (ptrdiff_t)r->stride[k];
+      }
+      low_edge[choice] = moved & ~shift;
+      high_edge[choice] = shift & ~moved;
+    }
+
+    int digits[LN_MAX_BUFS] = { 0 };
+    int low = (1 << ndiffs) - 1;  // blocks at the first cell of the slice
+    int high = 0;  // blocks at the last cell of the slice
+    for (size_t k = 0; k < ndiffs; k++) {
+      if (k != drv && r->width[k] == 1) {
+        high |= 1 << k;
+      }
+    }
+    for (size_t cell = 0; cell < r->slice; cell++) {
+      int iters[LN_MAX_BUFS];
+      size_t paths[LN_MAX_BUFS];
+      int npaths = 0;
       for (size_t k = 0; k < ndiffs; k++) {
-        from_vals[k] = df_iters[k];
-        // get the index at all of the places
-        if ((*choice) & (1 << k)) {
-          from_vals[k]--;
-          const char *p = diff_blk[k];
-          fastforward_buf_to_lnum(&p, df_iters[k]);
-          current_lines[k] = p;
-        } else {
-          current_lines[k] = NULL;
+        iters[k] = k == drv ? i : base[k] + digits[k];
+        if (iters[k] > 0) {
+          paths[npaths++] = k;
         }
       }
-      size_t unwrapped_idx_from = unwrap_indexes(from_vals, diff_len, ndiffs);
-      size_t unwrapped_idx_to = unwrap_indexes(to_vals, diff_len, ndiffs);
-      int matched_chars = count_n_matched_chars(current_lines, ndiffs, iwhite);
-      int score = diffcmppath[unwrapped_idx_from].df_lev_score + matched_chars;
-      if (score > diffcmppath[unwrapped_idx_to].df_lev_score) {
-        update_path_flat(diffcmppath, score, unwrapped_idx_to, unwrapped_idx_from, *choice);
+
+      int pairs[LN_MAX_BUFS][LN_MAX_BUFS];
+      for (int p = 0; p < npaths; p++) {
+        for (int q = p + 1; q < npaths; q++) {
+          size_t bp = paths[p];
+          size_t bq = paths[q];
+          pairs[bp][bq] = lm_matching_chars(lm, bp, r->start[bp] + iters[bp] - 1,
+                                            bq, r->start[bq] + iters[bq] - 1);
+        }
       }
-    } else {
-      // initialize the 0, 0, 0 ... choice
-      size_t i = 0;
-      while (i < ndiffs && df_iters[i] == 0) {
-        i++;
-        if (i == ndiffs) {
-          diffcmppath[0].df_lev_score = 0;
-          diffcmppath[0].df_path_idx = 0;
+
+      // Try the choices with the lines of the first blocks compared first,
+      // a later choice must be strictly better to be used.
+      int best = npaths == 0 ? 0 : -1;
+      int best_choice = 0;
+      for (int t = (1 << npaths) - 1; t > 0; t--) {
+        int choice = 0;
+        for (int j = 0; j < npaths; j++) {
+          if (t & (1 << (npaths - 1 - j))) {
+            choice |= 1 << paths[j];
+          }
+        }
+        if ((low_edge[choice] & low) || (high_edge[choice] & high)) {
+          continue;  // outside of the band
+        }
+        const int *from = (choice & (1 << drv)) ? prev : cur;
+        int from_score = from[(ptrdiff_t)cell + from_off[choice]];
+        if (from_score < 0) {
+          continue;
+        }
+        int score = from_score + count_n_matched_chars(pairs, ndiffs, choice);
+        if (score > best) {
+          best = score;
+          best_choice = choice;
+        }
+      }
+      cur[cell] = best;
+      choices[(size_t)i * r->slice + cell] = (uint8_t)best_choice;
+
+      for (size_t k = ndiffs; k-- > 0;) {
+        if (k != drv) {
+          low &= ~(1 << k);
+          if (++digits[k] < r->width[k]) {
+            if (digits[k] == r->width[k] - 1) {
+              high |= 1 << k;
+            }
+            break;
+          }
+          digits[k] = 0;
+          low |= 1 << k;
+          high &= ~(1 << k);
+          if (r->width[k] == 1) {
+            high |= 1 << k;
+          }
         }
       }
     }
-    return;
   }
-  size_t bit_place = paths[path_idx];
-  *(choice) |= (1 << bit_place);  // set it to 1
-  try_possible_paths(df_iters, paths, npaths, path_idx + 1, choice,
-                     diffcmppath, diff_len, ndiffs, diff_blk, iwhite);
-  *(choice) &= ~(1 << bit_place);  // set it to 0
-  try_possible_paths(df_iters, paths, npaths, path_idx + 1, choice,
-                     diffcmppath, diff_len, ndiffs, diff_blk, iwhite);
-}
 
-/// unwrap indexes to access n dimensional tensor
-/// @param values
-/// @param diff_len
-/// @param ndiffs
-static size_t unwrap_indexes(const int *values, const int *diff_len, const size_t ndiffs)
-{
-  size_t num_unwrap_scalar = 1;
+  // Walk back from the last cell, the decisions come out in reverse.
+  size_t npath = 0;
+  int iters[LN_MAX_BUFS];
   for (size_t k = 0; k < ndiffs; k++) {
-    num_unwrap_scalar *= (size_t)diff_len[k] + 1;
+    iters[k] = r->len[k];
+    npath += (size_t)r->len[k];
   }
-
-  size_t path_idx = 0;
-  for (size_t k = 0; k < ndiffs; k++) {
-    num_unwrap_scalar /= (size_t)diff_len[k] + 1;
-
-    // (k == 0) space optimization
-    int n = k == 0 ? values[k] % 2 : values[k];
-    path_idx += num_unwrap_scalar * (size_t)n;
+  int *path = xmalloc(npath * sizeof(int));
+  npath = 0;
+  while (true) {
+    size_t cell = (size_t)iters[drv] * r->slice;
+    bool origin = true;
+    for (size_t k = 0; k < ndiffs; k++) {
+      origin &= iters[k] == 0;
+      if (k != drv) {
+        cell += (size_t)(iters[k] - lmrange_base(r, k, iters[drv])) * r->stride[k];
+      }
+    }
+    if (origin) {
+      break;
+    }
+    int choice = choices[cell];
+    assert(choice != 0);
+    path[npath++] = choice;
+    for (size_t k = 0; k < ndiffs; k++) {
+      iters[k] -= (choice >> k) & 1;
+    }
+  }
+  while (npath > 0) {
+    kv_push(lm->decisions, path[--npath]);
   }
-  return path_idx;
+
+  xfree(path);
+  xfree(choices);
+  xfree(scores[0]);
+  xfree(scores[1]);
 }
 
-/// populate the values of the linematch algorithm tensor, and find the best
-/// decision for how to compare the relevant lines from each of the buffers at
-/// each point in the tensor
-/// @param df_iters
-/// @param ch_dim
-/// @param diffcmppath
-/// @param diff_len
-/// @param ndiffs
-/// @param diff_blk
-static void populate_tensor(int *df_iters, const size_t ch_dim, diffcmppath_T *diffcmppath,
-                            const int *diff_len, const size_t ndiffs, const char **diff_blk,
-                            bool iwhite)
+/// Align "len[k]" lines starting at "start[k]" of each block, using the widest
+/// band that fits in the memory budget. When not even the narrowest band
+/// fits, the ranges are split in the middle and the halves are aligned
+/// separately.
+static void linematch_range(linematch_T *lm, const int *start, const int *len)
 {
-  if (ch_dim == ndiffs) {
-    int npaths = 0;
-    size_t paths[LN_MAX_BUFS];
-
-    for (size_t j = 0; j < ndiffs; j++) {
-      if (df_iters[j] > 0) {
-        paths[npaths] = j;
-        npaths++;
-      }
+  const size_t ndiffs = lm->ndiffs;
+  lmrange_T r;
+  r.drv = 0;
+  for (size_t k = 0; k < ndiffs; k++) {
+    r.start[k] = start[k];
+    r.len[k] = len[k];
+    if (len[k] > len[r.drv]) {
+      r.drv = k;
     }
-    int choice = 0;
-    size_t unwrapper_idx_to = unwrap_indexes(df_iters, diff_len, ndiffs);
-    diffcmppath[unwrapper_idx_to].df_lev_score = -1;
-    try_possible_paths(df_iters, paths, npaths, 0, &choice, diffcmppath,
-                       diff_len, ndiffs, diff_blk, iwhite);
+  }
+  const int maxlen = r.len[r.drv];
+  if (maxlen == 0) {
     return;
   }
 
-  for (int i = 0; i <= diff_len[ch_dim]; i++) {
-    df_iters[ch_dim] = i;
-    populate_tensor(df_iters, ch_dim + 1, diffcmppath, diff_len,
-                    ndiffs, diff_blk, iwhite);
+  // A band as wide as the longest block covers the whole tensor.
+  if (lmrange_set_band(&r, ndiffs, maxlen) > lm->budget) {
+    int lo = 0;
+    int hi = maxlen;
+    while (hi - lo > 1) {
+      int mid = lo + (hi - lo) / 2;
+      if (lmrange_set_band(&r, ndiffs, mid) <= lm->budget) {
+        lo = mid;
+      } else {
+        hi = mid;
+      }
+    }
+    if (lo == 0 && maxlen > 1) {
+      int start2[LN_MAX_BUFS];
+      int len2[LN_MAX_BUFS];
+      int half[LN_MAX_BUFS];
+      for (size_t k = 0; k < ndiffs; k++) {
+        half[k] = len[k] / 2;
+        start2[k] = start[k] + half[k];
+        len2[k] = len[k] - half[k];
+      }
+      linematch_range(lm, start, half);
+      linematch_range(lm, start2, len2);
+      return;
+    }
+    lmrange_set_band(&r, ndiffs, MAX(lo, 1));
   }
+  linematch_dp(lm, &r);
 }
 
 /// algorithm to find an optimal alignment of lines of a diff block with 2 or
@@ -328,58 +527,73 @@ static void populate_tensor(int *df_iters, const size_t ch_dim, diffcmppath_T *d
 /// it may have came.
 ///
 /// Optimizations:
-/// As the function to calculate the cell of a tensor at point i,j,k is a
-/// function of the cells at i-1, j-1, k-1, the whole tensor doesn't need
-/// to be stored in memory at once. In the case of the 3d cube, only two
-/// slices (along k and j axis) are stored in memory. For the 2d matrix
-/// (for 2 files), only two rows are stored at a time. The next/previous
-/// slice (or row) is always calculated from the other, and they alternate
-/// at each iteration.
-/// In the 3d case, 3 arrays are populated to memorize the score (matched
-/// characters) of the 3 buffers, so a redundant calculation of the
-/// scores does not occur
+/// A cell only depends on the cells one step back along every axis, so the
+/// scores are only kept for two slices of the tensor, along the axis of the
+/// longest block. The path to every cell is not stored, only the choice
+/// that led to it, which is enough to walk the best path back from the
+/// opposite corner. The number of matching characters between two lines is
+/// cached, as neighbouring cells compare the same lines.
+///
+/// Memory is bounded by "budget": when the whole tensor does not fit, only
+/// the cells within a band around the diagonal between the two corners are
+/// searched, the widest band that fits. If not even that fits, the blocks are
+/// split in the middle and the halves are aligned separately. Both give an
+/// alignment that is close to, but not necessarily, the best one.
 /// @param diff_blk
 /// @param diff_len
 /// @param ndiffs
 /// @param [out] [allocated] decisions
+/// @param iwhite
+/// @param budget  number of bytes the tensor may use, see LINEMATCH_BUDGET
 /// @return the length of decisions
 size_t linematch_nbuffers(const char **diff_blk, const int *diff_len, const size_t ndiffs,
-                          int **decisions, bool iwhite)
+                          int **decisions, bool iwhite, size_t budget)
 {
   assert(ndiffs <= LN_MAX_BUFS);
 
-  size_t memsize = 1;
+  linematch_T lm = { .ndiffs = ndiffs };
+  int start[LN_MAX_BUFS] = { 0 };
   size_t memsize_decisions = 0;
   for (size_t i = 0; i < ndiffs; i++) {
     assert(diff_len[i] >= 0);
-    memsize *= i == 0 ? 2 : (size_t)(diff_len[i] + 1);
+    lmblock_init(&lm.blk[i], diff_blk[i], diff_len[i], iwhite);
     memsize_decisions += (size_t)diff_len[i];
   }
-
-  // create the flattened path matrix
-  diffcmppath_T *diffcmppath = xmalloc(sizeof(diffcmppath_T) * memsize);
-  // allocate memory here
-  for (size_t i = 0; i < memsize; i++) {
-    diffcmppath[i].df_decision = xmalloc(memsize_decisions * sizeof(int));
+  // Keep the matches of all pairs of lines when that takes a small part of
+  // the budget, otherwise use a fixed size cache.
+  size_t memo_size = 0;
+  for (size_t p = 0; p < ndiffs; p++) {
+    for (size_t q = p + 1; q < ndiffs; q++) {
+      memo_size += (size_t)diff_len[p] * (size_t)diff_len[q] * sizeof(int);
+    }
   }
+  if (memo_size <= budget / 4) {
+    for (size_t p = 0; p < ndiffs; p++) {
+      for (size_t q = p + 1; q < ndiffs; q++) {
+        size_t size = (size_t)diff_len[p] * (size_t)diff_len[q] * sizeof(int);
+        lm.memo[p][q] = xmalloc(size);
+        memset(lm.memo[p][q], -1, size);
+      }
+    }
+    budget -= memo_size;
+  } else {
+    lm.cache = xcalloc((size_t)1 << LM_CACHE_BITS, sizeof(*lm.cache));
+  }
+  lm.budget = budget;
+  kv_resize(lm.decisions, MAX(memsize_decisions, 1));
 
-  // memory for avoiding repetitive calculations of score
-  int df_iters[LN_MAX_BUFS];
-  populate_tensor(df_iters, 0, diffcmppath, diff_len, ndiffs, diff_blk, iwhite);
-
-  const size_t u = unwrap_indexes(diff_len, diff_len, ndiffs);
-  const size_t best_path_idx = diffcmppath[u].df_path_idx;
-  const int *best_path_decisions = diffcmppath[u].df_decision;
+  linematch_range(&lm, start, diff_len);
 
-  *decisions = xmalloc(sizeof(int) * best_path_idx);
-  for (size_t i = 0; i < best_path_idx; i++) {
-    (*decisions)[i] = best_path_decisions[i];
+  for (size_t i = 0; i < ndiffs; i++) {
+    lmblock_free(&lm.blk[i]);
   }
-
-  for (size_t i = 0; i < memsize; i++) {
-    xfree(diffcmppath[i].df_decision);
+  for (size_t p = 0; p < ndiffs; p++) {
+    for (size_t q = p + 1; q < ndiffs; q++) {
+      xfree(lm.memo[p][q]);
+    }
   }
-  xfree(diffcmppath);
+  xfree(lm.cache);
 
-  return best_path_idx;
+  *decisions = lm.decisions.items;
+  return kv_size(lm.decisions);
 }
@@ -3,6 +3,9 @@
 
 #include <stddef.h>
 
+/// Default memory budget of linematch_nbuffers(), in bytes.
+#define LINEMATCH_BUDGET ((size_t)8 * 1024 * 1024)
+
 #ifdef INCLUDE_GENERATED_DECLARATIONS
 # include "linematch.h.generated.h"
 #endif
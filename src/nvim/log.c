@@ -7,6 +7,11 @@
 // How Linux printk() handles recursion, buffering, etc:
 // https://lwn.net/Articles/780556/
 //
+// Each thread adds its messages as records (level, time, subsystem, channel,
+// source location and text) to its own buffer. A writer thread formats them
+// and appends them to the log file in batches, so logging doesn't wait for the
+// file system. Errors are written immediately.
+//
 
 #include <assert.h>
 #include <errno.h>
@@ -35,8 +40,90 @@
 static char log_file_path[MAXPATHL + 1] = { 0 };
 
 static bool did_log_init = false;
+/// Protects the log file, `log_buffers`, `free_buffers` and the `spare` blocks
+/// of the buffers.
 static uv_mutex_t mutex;
 
+/// Size of the record buffer of each thread. The writer thread is woken up
+/// when a buffer is half full, messages are dropped when it is full.
+#define LOG_BUF_SIZE (256 * 1024)
+/// How often the writer thread writes buffered records, in milliseconds.
+#define LOG_WRITE_INTERVAL 100
+
+/// A log message. Its text follows it in the buffer.
+typedef struct {
+  int64_t time;  ///< microseconds since the epoch
+  uint64_t channel_id;  ///< channel the message is about, or 0
+  const char *context;  ///< subsystem, or NULL
+  const char *func_name;  ///< function name, or NULL
+  int line_num;
+  int level;
+  int millis;
+  bool eol;
+  char date_time[20];
+  char name[16];
+  size_t len;  ///< length of the text
+} LogRecord;
+
+/// Records are aligned so that a LogRecord can be read in place.
+#define LOG_RECORD_SIZE(len) \
+  ((sizeof(LogRecord) + (len) + sizeof(int64_t) - 1) & ~(sizeof(int64_t) - 1))
+
+typedef struct log_buffer LogBuffer;
+
+/// Records logged by one thread. The thread only takes `buf_mutex` to append a
+/// record, which is only contended when the writer swaps `data` and `spare`.
+struct log_buffer {
+  uv_mutex_t buf_mutex;  ///< protects `data`, `size` and `dropped`
+  char *data;
+  size_t size;
+  size_t dropped;  ///< messages dropped because `data` was full
+  char *spare;  ///< records being written, protected by `mutex`
+  size_t spare_size;
+  size_t spare_pos;  ///< next record of `spare` to write
+  bool busy;  ///< logmsg() is running in this thread
+  bool woke_writer;  ///< woke up the writer for the current `data`
+  int64_t date_sec;  ///< second of `date_time`
+  char date_time[20];  ///< formatted local time, cached for the thread
+  LogBuffer *next;
+};
+
+static uv_key_t log_buf_key;
+/// Buffers of running threads.
+static LogBuffer *log_buffers = NULL;
+/// Buffers of finished threads, without `data` and `spare`, reused by the next
+/// thread that logs. See log_thread_exit().
+static LogBuffer *free_buffers = NULL;
+
+static uv_thread_t writer;
+static uv_mutex_t writer_mutex;
+static uv_cond_t writer_cond;
+static bool writer_stop = false;
+/// Messages are written by the writer thread, otherwise by the thread that
+/// logs them.
+static bool log_async = false;
+/// Protects `log_async` and `log_min_levels`, which are set on the main thread
+/// and read by any thread.
+static uv_rwlock_t config_lock;
+
+/// Name of this Nvim instance in messages, empty until it is known. Set on the
+/// main thread, see log_set_name(), read by any thread. Protected by
+/// `name_mutex`.
+static char log_name[16] = { 0 };
+static uv_mutex_t name_mutex;
+
+/// Subsystems with their own log level, see log_set_level(). Messages without
+/// one of these contexts use the level of "*".
+static const char *log_subsystems[] = { "*", "RPC", "UI" };
+static int log_min_levels[ARRAY_SIZE(log_subsystems)];
+
+static const char *log_level_names[] = {
+  [LOGLVL_DBG] = "DBG",
+  [LOGLVL_INF] = "INF",
+  [LOGLVL_WRN] = "WRN",
+  [LOGLVL_ERR] = "ERR",
+};
+
 #ifdef INCLUDE_GENERATED_DECLARATIONS
 # include "log.c.generated.h"
 #endif
@@ -104,9 +191,50 @@ static void log_path_init(void)
 void log_init(void)
 {
   uv_mutex_init_recursive(&mutex);
+  uv_mutex_init(&name_mutex);
+  uv_rwlock_init(&config_lock);
+  uv_key_create(&log_buf_key);
+  // Parent servername.
+  const char *parent = path_tail(os_getenv(ENV_NVIM));
+  if (parent[0] != NUL) {
+    snprintf(log_name, sizeof(log_name), "%s/c", parent);  // "/c" indicates child.
+  }
+  for (size_t i = 0; i < ARRAY_SIZE(log_min_levels); i++) {
+    log_min_levels[i] = MIN_LOG_LEVEL;
+  }
   // AFTER init_homedir ("~", XDG) and set_init_1 (env vars). 22b52dd462e5 #11501
   log_path_init();
+  log_levels_init(os_getenv(ENV_LOGLEVEL));
   did_log_init = true;
+
+  uv_mutex_init(&writer_mutex);
+  uv_cond_init(&writer_cond);
+  if (uv_thread_create(&writer, log_writer, NULL) == 0) {
+    uv_rwlock_wrlock(&config_lock);
+    log_async = true;
+    uv_rwlock_wrunlock(&config_lock);
+    atexit(log_teardown);
+  }
+}
+
+/// Stops the writer thread and writes the buffered messages. Messages logged
+/// after this are written synchronously.
+void log_teardown(void)
+{
+  uv_rwlock_wrlock(&config_lock);
+  bool async = log_async;
+  log_async = false;
+  uv_rwlock_wrunlock(&config_lock);
+  if (!async) {
+    return;
+  }
+  uv_mutex_lock(&writer_mutex);
+  writer_stop = true;
+  uv_cond_signal(&writer_cond);
+  uv_mutex_unlock(&writer_mutex);
+  // Not joined: the writer may wait for `mutex` if we are exiting because of a
+  // crash while logging. log_flush() waits for a write in progress.
+  log_flush();
 }
 
 void log_lock(void)
@@ -119,10 +247,93 @@ void log_unlock(void)
   uv_mutex_unlock(&mutex);
 }
 
+/// Sets log levels from $NVIM_LOG_LEVEL, a comma-separated list of items like
+/// "WRN" (all subsystems) or "RPC=DBG". Invalid items are ignored.
+static void log_levels_init(const char *spec)
+{
+  for (const char *p = spec; p != NULL && *p != NUL;) {
+    const char *end = strchr(p, ',');
+    size_t len = end != NULL ? (size_t)(end - p) : strlen(p);
+    char item[32];
+    if (len < sizeof(item)) {
+      xstrlcpy(item, p, len + 1);
+      char *eq = strchr(item, '=');
+      if (eq == NULL) {
+        for (size_t i = 0; i < ARRAY_SIZE(log_subsystems); i++) {
+          log_set_level(log_subsystems[i], item);
+        }
+      } else {
+        *eq = NUL;
+        log_set_level(item, eq + 1);
+      }
+    }
+    p += len + (end != NULL);
+  }
+}
+
+/// Sets the minimum level of the messages logged for a subsystem. Levels below
+/// MIN_LOG_LEVEL are compiled out, lowering the level to them has no effect.
+///
+/// @param subsystem  "RPC", "UI" or "*" for other messages
+/// @param level      "DBG", "INF", "WRN" or "ERR"
+///
+/// @return false if `subsystem` or `level` is invalid
+bool log_set_level(const char *subsystem, const char *level)
+  FUNC_ATTR_NONNULL_ALL
+{
+  int lvl = -1;
+  for (int i = LOGLVL_DBG; i <= LOGLVL_ERR; i++) {
+    if (STRICMP(level, log_level_names[i]) == 0) {
+      lvl = i;
+    }
+  }
+  if (lvl < 0) {
+    return false;
+  }
+  for (size_t i = 0; i < ARRAY_SIZE(log_subsystems); i++) {
+    if (STRICMP(subsystem, log_subsystems[i]) == 0) {
+      uv_rwlock_wrlock(&config_lock);
+      log_min_levels[i] = lvl;
+      uv_rwlock_wrunlock(&config_lock);
+      return true;
+    }
+  }
+  return false;
+}
+
+/// Checks whether messages of a level are logged for a subsystem. Use it to
+/// skip building expensive messages.
+///
+/// @param context  Subsystem, or NULL
+bool log_enabled(int log_level, const char *context)
+{
+  if (log_level < MIN_LOG_LEVEL || !did_log_init) {
+    return false;
+  }
+  size_t idx = 0;
+  if (context != NULL) {
+    for (size_t i = 1; i < ARRAY_SIZE(log_subsystems); i++) {
+      if (strequal(context, log_subsystems[i])) {
+        idx = i;
+        break;
+      }
+    }
+  }
+  uv_rwlock_rdlock(&config_lock);
+  bool enabled = log_level >= log_min_levels[idx];
+  uv_rwlock_rdunlock(&config_lock);
+  return enabled;
+}
+
 /// Logs a message to $NVIM_LOG_FILE.
 ///
+/// The message is added to a buffer of the calling thread and written by a
+/// writer thread, except for LOGLVL_ERR messages, which are written before
+/// returning.
+///
 /// @param log_level  Log level (see log.h)
-/// @param context    Description of a shared context or subsystem
+/// @param context    Subsystem, like "RPC" or "UI", or NULL. Must be a static
+///                   string, see log_set_level().
 /// @param func_name  Function name, or NULL
 /// @param line_num   Source line number, or -1
 /// @param eol        Append linefeed "\n"
@@ -133,7 +344,30 @@ bool logmsg(int log_level, const char *context, const char *func_name, int line_
             const char *fmt, ...)
   FUNC_ATTR_UNUSED FUNC_ATTR_PRINTF(6, 7)
 {
-  static bool recursive = false;
+  va_list args;
+  va_start(args, fmt);
+  bool ret = v_logmsg(log_level, context, 0, func_name, line_num, eol, fmt, args);
+  va_end(args);
+  return ret;
+}
+
+/// Like logmsg(), for a message about a channel.
+bool logmsg_channel(int log_level, const char *context, uint64_t channel_id,
+                    const char *func_name, int line_num, bool eol, const char *fmt, ...)
+  FUNC_ATTR_UNUSED FUNC_ATTR_PRINTF(7, 8)
+{
+  va_list args;
+  va_start(args, fmt);
+  bool ret = v_logmsg(log_level, context, channel_id, func_name, line_num, eol, fmt, args);
+  va_end(args);
+  return ret;
+}
+
+static bool v_logmsg(int log_level, const char *context, uint64_t channel_id,
+                     const char *func_name, int line_num, bool eol, const char *fmt,
+                     va_list args)
+  FUNC_ATTR_PRINTF(7, 0)
+{
   static bool did_msg = false;  // Showed recursion message?
   if (!did_log_init) {
     g_stats.log_skip++;
@@ -141,7 +375,7 @@ bool logmsg(int log_level, const char *context, const char *func_name, int line_
     return false;
   }
 
-  if (log_level < MIN_LOG_LEVEL) {
+  if (!log_enabled(log_level, context)) {
     return false;
   }
 
@@ -151,39 +385,290 @@ bool logmsg(int log_level, const char *context, const char *func_name, int line_
   assert(!entered_free_all_mem);
 #endif
 
-  log_lock();
-  if (recursive) {
+  LogBuffer *buf = log_buffer_get();
+  if (buf->busy) {
     if (!did_msg) {
       did_msg = true;
       msg_schedule_semsg("E5430: %s:%d: recursive log!", func_name ? func_name : context, line_num);
     }
     g_stats.log_skip++;
-    log_unlock();
     return false;
   }
-  recursive = true;
-  bool ret = false;
-  FILE *log_file = open_log_file();
+  buf->busy = true;
+
+  LogRecord rec;
+  log_record_init(&rec, buf, log_level, context, channel_id, func_name, line_num, eol);
+  uv_rwlock_rdlock(&config_lock);
+  bool sync = !log_async || log_level >= LOGLVL_ERR;
+  uv_rwlock_rdunlock(&config_lock);
+  bool added = false;
+  bool too_long = false;
+
+  uv_mutex_lock(&buf->buf_mutex);
+  if (buf->data == NULL) {
+    buf->data = xmalloc(LOG_BUF_SIZE);
+  }
+  if (buf->size + sizeof(LogRecord) < LOG_BUF_SIZE) {
+    size_t avail = LOG_BUF_SIZE - buf->size - sizeof(LogRecord);
+    va_list args_copy;
+    va_copy(args_copy, args);
+    int len = vsnprintf(buf->data + buf->size + sizeof(LogRecord), avail, fmt, args_copy);
+    va_end(args_copy);
+    if (len >= 0 && (size_t)len < avail) {
+      rec.len = (size_t)len;
+      memcpy(buf->data + buf->size, &rec, sizeof(rec));
+      buf->size += LOG_RECORD_SIZE(rec.len);
+      added = true;
+    } else if (len >= 0 && LOG_RECORD_SIZE((size_t)len) > LOG_BUF_SIZE / 2) {
+      rec.len = (size_t)len;
+      too_long = true;
+    }
+  }
+  if (!added && !too_long) {
+    buf->dropped++;
+  }
+  bool wake = !sync && !buf->woke_writer && (!added || buf->size > LOG_BUF_SIZE / 2);
+  if (wake) {
+    buf->woke_writer = true;
+  }
+  uv_mutex_unlock(&buf->buf_mutex);
+
+  bool ret = added;
+  if (too_long) {
+    // Would fill most of the buffer, write it now.
+    ret = log_write_long(&rec, fmt, args);
+  } else if (sync) {
+    log_flush();
+  } else if (wake) {
+    uv_cond_signal(&writer_cond);
+  }
+  buf->busy = false;
+  return ret;
+}
 
-  va_list args;
-  va_start(args, fmt);
-  ret = v_do_log_to_file(log_file, log_level, context, func_name, line_num,
-                         eol, fmt, args);
-  va_end(args);
+/// Gets the record buffer of the calling thread.
+static LogBuffer *log_buffer_get(void)
+{
+  LogBuffer *buf = uv_key_get(&log_buf_key);
+  if (buf == NULL) {
+    log_lock();
+    buf = free_buffers;
+    if (buf != NULL) {
+      free_buffers = buf->next;
+    } else {
+      buf = xcalloc(1, sizeof(*buf));
+      uv_mutex_init(&buf->buf_mutex);
+    }
+    buf->next = log_buffers;
+    log_buffers = buf;
+    log_unlock();
+    uv_key_set(&log_buf_key, buf);
+  }
+  return buf;
+}
+
+/// Releases the record buffer of the calling thread, if it logged. Call it
+/// before a thread other than the main thread ends. The records of the thread
+/// are written, and the buffer is kept for the next thread that logs.
+void log_thread_exit(void)
+{
+  if (!did_log_init) {
+    return;
+  }
+  LogBuffer *buf = uv_key_get(&log_buf_key);
+  if (buf == NULL) {
+    return;
+  }
+  uv_key_set(&log_buf_key, NULL);
+  log_lock();
+  log_flush();
+  LogBuffer **pp = &log_buffers;
+  while (*pp != buf) {
+    pp = &(*pp)->next;
+  }
+  *pp = buf->next;
+  // Both are empty after log_flush(), only the owner adds records.
+  XFREE_CLEAR(buf->data);
+  XFREE_CLEAR(buf->spare);
+  buf->woke_writer = false;
+  buf->next = free_buffers;
+  free_buffers = buf;
+  log_unlock();
+}
+
+/// Names this Nvim instance in messages after its server address, unless it
+/// already has a name. Called on the main thread when v:servername is set.
+void log_set_name(const char *servername)
+{
+  // TODO(justinmk): expose this as v:name ?
+  if (!did_log_init || servername == NULL) {
+    return;
+  }
+  uv_mutex_lock(&name_mutex);
+  if (log_name[0] == NUL) {
+    snprintf(log_name, sizeof(log_name), "%s", path_tail(servername));
+  }
+  uv_mutex_unlock(&name_mutex);
+}
+
+/// Gets a name for this Nvim instance.
+static void log_get_name(char *name, size_t size)
+{
+  if (did_log_init) {
+    uv_mutex_lock(&name_mutex);
+    xstrlcpy(name, log_name, size);
+    uv_mutex_unlock(&name_mutex);
+    if (name[0] != NUL) {
+      return;
+    }
+  }
+  // No v:servername yet.
+  int64_t pid = os_get_pid();
+  snprintf(name, size, "?.%-5" PRId64, pid);
+}
+
+static void log_record_init(LogRecord *rec, LogBuffer *buf, int log_level, const char *context,
+                            uint64_t channel_id, const char *func_name, int line_num, bool eol)
+{
+  *rec = (LogRecord) {
+    .level = log_level,
+    .context = context,
+    .channel_id = channel_id,
+    .func_name = func_name,
+    .line_num = line_num,
+    .eol = eol,
+  };
+  uv_timeval64_t curtime;
+  if (uv_gettimeofday(&curtime) == 0) {
+    rec->time = curtime.tv_sec * 1000000 + curtime.tv_usec;
+    rec->millis = (int)curtime.tv_usec / 1000;
+  } else {
+    rec->time = (int64_t)time(NULL) * 1000000;
+  }
+
+  // Format the timestamp, once per second.
+  int64_t sec = rec->time / 1000000;
+  if (buf->date_time[0] == NUL || sec != buf->date_sec) {
+    time_t clock = (time_t)sec;
+    struct tm local_time;
+    if (os_localtime_r(&clock, &local_time) == NULL
+        || strftime(buf->date_time, sizeof(buf->date_time), "%Y-%m-%dT%H:%M:%S",
+                    &local_time) == 0) {
+      buf->date_time[0] = NUL;
+    }
+    buf->date_sec = sec;
+  }
+  memcpy(rec->date_time, buf->date_time, sizeof(rec->date_time));
+  log_get_name(rec->name, sizeof(rec->name));
+}
 
+/// Writes a message that is too long for the buffer, after the buffered ones.
+static bool log_write_long(LogRecord *rec, const char *fmt, va_list args)
+  FUNC_ATTR_PRINTF(2, 0)
+{
+  char *text = xmalloc(rec->len + 1);
+  vsnprintf(text, rec->len + 1, fmt, args);
+  log_lock();
+  log_flush();
+  FILE *log_file = open_log_file();
+  bool ret = log_write_record(log_file, rec, text);
   if (log_file != stderr && log_file != stdout) {
     fclose(log_file);
   }
-
-  recursive = false;
   log_unlock();
+  xfree(text);
   return ret;
 }
 
+/// Writes buffered records every LOG_WRITE_INTERVAL, or when a buffer is half
+/// full.
+static void log_writer(void *arg)
+{
+  uv_mutex_lock(&writer_mutex);
+  while (!writer_stop) {
+    uv_cond_timedwait(&writer_cond, &writer_mutex, LOG_WRITE_INTERVAL * 1000000ULL);
+    uv_mutex_unlock(&writer_mutex);
+    log_flush();
+    uv_mutex_lock(&writer_mutex);
+  }
+  uv_mutex_unlock(&writer_mutex);
+}
+
+/// Writes the buffered records of all threads to the log file, oldest first.
+static void log_flush(void)
+{
+  log_lock();
+  bool pending = false;
+  size_t dropped = 0;
+  for (LogBuffer *b = log_buffers; b != NULL; b = b->next) {
+    uv_mutex_lock(&b->buf_mutex);
+    char *data = b->data;
+    b->data = b->spare;
+    b->spare = data;
+    b->spare_size = b->size;
+    b->size = 0;
+    dropped += b->dropped;
+    b->dropped = 0;
+    b->woke_writer = false;
+    uv_mutex_unlock(&b->buf_mutex);
+    pending |= b->spare_size > 0;
+  }
+  if (!pending) {
+    log_unlock();
+    return;
+  }
+
+  FILE *log_file = open_log_file();
+  LogRecord rec;
+  LogRecord last = { 0 };
+  while (true) {
+    LogBuffer *oldest = NULL;
+    for (LogBuffer *b = log_buffers; b != NULL; b = b->next) {
+      if (b->spare_pos < b->spare_size) {
+        memcpy(&rec, b->spare + b->spare_pos, sizeof(rec));
+        if (oldest == NULL || rec.time < last.time) {
+          oldest = b;
+          last = rec;
+        }
+      }
+    }
+    if (oldest == NULL) {
+      break;
+    }
+    log_write_record(log_file, &last, oldest->spare + oldest->spare_pos + sizeof(LogRecord));
+    oldest->spare_pos += LOG_RECORD_SIZE(last.len);
+  }
+  for (LogBuffer *b = log_buffers; b != NULL; b = b->next) {
+    b->spare_size = 0;
+    b->spare_pos = 0;
+  }
+
+  if (dropped > 0) {
+    // A buffer was full, so a record was written and `last` is set.
+    char text[64];
+    last.len = (size_t)snprintf(text, sizeof(text), "dropped %zu messages, buffer full", dropped);
+    last.level = LOGLVL_WRN;
+    last.context = NULL;
+    last.channel_id = 0;
+    last.func_name = __func__;
+    last.line_num = __LINE__;
+    last.eol = true;
+    log_write_record(log_file, &last, text);
+  }
+
+  if (log_file != stderr && log_file != stdout) {
+    fclose(log_file);
+  } else {
+    fflush(log_file);
+  }
+  log_unlock();
+}
+
 void log_uv_handles(void *loop)
 {
   uv_loop_t *l = loop;
   log_lock();
+  log_flush();
   FILE *log_file = open_log_file();
 
   uv_print_all_handles(l, log_file);
@@ -258,6 +743,7 @@ void log_callstack_to_file(FILE *log_file, const char *const func_name, const in
 void log_callstack(const char *const func_name, const int line_num)
 {
   log_lock();
+  log_flush();
   FILE *log_file = open_log_file();
   log_callstack_to_file(log_file, func_name, line_num);
   log_unlock();
@@ -282,76 +768,58 @@ static bool v_do_log_to_file(FILE *log_file, int log_level, const char *context,
                              va_list args)
   FUNC_ATTR_PRINTF(7, 0)
 {
-  // Name of the Nvim instance that produced the log.
-  static char name[16] = { 0 };
-
-  static const char *log_levels[] = {
-    [LOGLVL_DBG] = "DBG",
-    [LOGLVL_INF] = "INF",
-    [LOGLVL_WRN] = "WRN",
-    [LOGLVL_ERR] = "ERR",
-  };
-  assert(log_level >= LOGLVL_DBG && log_level <= LOGLVL_ERR);
-
-  // Format the timestamp.
-  struct tm local_time;
-  if (os_localtime(&local_time) == NULL) {
+  LogRecord rec;
+  log_record_init(&rec, log_buffer_get(), log_level, context, 0, func_name, line_num, eol);
+  if (!log_write_header(log_file, &rec)) {
     return false;
   }
-  char date_time[20];
-  if (strftime(date_time, sizeof(date_time), "%Y-%m-%dT%H:%M:%S", &local_time) == 0) {
+  if (vfprintf(log_file, fmt, args) < 0) {
     return false;
   }
-
-  int millis = 0;
-  uv_timeval64_t curtime;
-  if (uv_gettimeofday(&curtime) == 0) {
-    millis = (int)curtime.tv_usec / 1000;
+  if (eol) {
+    fputc('\n', log_file);
+  }
+  if (fflush(log_file) == EOF) {
+    return false;
   }
 
-  // Get a name for this Nvim instance.
-  // TODO(justinmk): expose this as v:name ?
-  if (name[0] == '\0') {
-    // Parent servername.
-    const char *parent = path_tail(os_getenv(ENV_NVIM));
-    // Servername. Empty until starting=false.
-    const char *serv = path_tail(get_vim_var_str(VV_SEND_SERVER));
-    if (parent[0] != NUL) {
-      snprintf(name, sizeof(name), "%s/c", parent);  // "/c" indicates child.
-    } else if (serv[0] != NUL) {
-      snprintf(name, sizeof(name), "%s", serv);
-    } else {
-      int64_t pid = os_get_pid();
-      snprintf(name, sizeof(name), "?.%-5" PRId64, pid);
-    }
+  return true;
+}
+
+/// Writes the level, time, instance name, subsystem and source location of a
+/// message.
+static bool log_write_header(FILE *log_file, const LogRecord *rec)
+{
+  assert(rec->level >= LOGLVL_DBG && rec->level <= LOGLVL_ERR);
+  char context[64];
+  if (rec->context == NULL) {
+    xstrlcpy(context, rec->line_num == -1 || rec->func_name == NULL ? "?:" : "", sizeof(context));
+  } else if (rec->channel_id != 0) {
+    snprintf(context, sizeof(context), "%s ch %" PRIu64 ": ", rec->context, rec->channel_id);
+  } else {
+    snprintf(context, sizeof(context), "%s: ", rec->context);
   }
 
-  // Print the log message.
-  int rv = (line_num == -1 || func_name == NULL)
+  int rv = (rec->line_num == -1 || rec->func_name == NULL)
     ? fprintf(log_file, "%s %s.%03d %-10s %s",
-              log_levels[log_level], date_time, millis, name,
-              (context == NULL ? "?:" : context))
-                               : fprintf(log_file, "%s %s.%03d %-10s %s%s:%d: ",
-                                         log_levels[log_level], date_time, millis, name,
-                                         (context == NULL ? "" : context),
-                                         func_name, line_num);
-  if (name[0] == '?') {
-    // No v:servername yet. Clear `name` so that the next log can try again.
-    name[0] = '\0';
-  }
-
-  if (rv < 0) {
+              log_level_names[rec->level], rec->date_time, rec->millis, rec->name, context)
+    : fprintf(log_file, "%s %s.%03d %-10s %s%s:%d: ",
+              log_level_names[rec->level], rec->date_time, rec->millis, rec->name, context,
+              rec->func_name, rec->line_num);
+  return rv >= 0;
+}
+
+/// Writes a record and its text.
+static bool log_write_record(FILE *log_file, const LogRecord *rec, const char *text)
+{
+  if (!log_write_header(log_file, rec)) {
     return false;
   }
-  if (vfprintf(log_file, fmt, args) < 0) {
+  if (fwrite(text, 1, rec->len, log_file) != rec->len) {
     return false;
   }
-  if (eol) {
+  if (rec->eol) {
     fputc('\n', log_file);
   }
-  if (fflush(log_file) == EOF) {
-    return false;
-  }
-
   return true;
 }
@@ -2,6 +2,7 @@
 #define NVIM_LOG_H
 
 #include <stdbool.h>
+#include <stdint.h>
 #include <stdio.h>
 
 #include "auto/config.h"
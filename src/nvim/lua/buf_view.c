@@ -0,0 +1,359 @@
+// This is an open source non-commercial project. Dear PVS-Studio, please check
+// it. PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+
+// Read-only views of buffer text for Lua (vim.buf_view()).
+//
+// A view reads the lines directly from the memline, so reading a range of
+// text or searching the buffer doesn't create a Lua string for every line
+// like nvim_buf_get_lines() does. A view is only valid as long as the buffer
+// is not changed: every method fails once the changedtick of the buffer is
+// different from when the view was created.
+
+#include <lauxlib.h>
+#include <lua.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "nvim/api/private/defs.h"
+#include "nvim/api/private/helpers.h"
+#include "nvim/ascii.h"
+#include "nvim/buffer.h"
+#include "nvim/buffer_defs.h"
+#include "nvim/globals.h"
+#include "nvim/lua/buf_view.h"
+#include "nvim/lua/stdlib.h"
+#include "nvim/macros.h"
+#include "nvim/memline.h"
+#include "nvim/memory.h"
+#include "nvim/pos.h"
+#include "nvim/regexp.h"
+#include "nvim/types.h"
+
+#define BUF_VIEW_META "nvim_buf_view"
+
+typedef struct {
+  handle_T handle;
+  varnumber_T changedtick;
+} BufView;
+
+#ifdef INCLUDE_GENERATED_DECLARATIONS
+# include "lua/buf_view.c.generated.h"
+#endif
+
+/// Gets the buffer of the view at index 1, raises an error if the view is no
+/// longer valid.
+static buf_T *buf_view_check(lua_State *lstate)
+{
+  BufView *view = luaL_checkudata(lstate, 1, BUF_VIEW_META);
+  buf_T *buf = buf_view_buf(view);
+  if (buf == NULL) {
+    luaL_error(lstate, "buffer view is outdated");
+  }
+  return buf;
+}
+
+static buf_T *buf_view_buf(const BufView *view)
+{
+  buf_T *buf = handle_get_buffer(view->handle);
+  if (buf == NULL || buf->b_ml.ml_mfp == NULL
+      || buf_get_changedtick(buf) != view->changedtick) {
+    return NULL;
+  }
+  return buf;
+}
+
+/// Checks the 0-based row at `index`. With `allow_end` the row after the last
+/// line is accepted too.
+static linenr_T buf_view_check_row(lua_State *lstate, buf_T *buf, int index, bool allow_end)
+{
+  lua_Integer row = luaL_checkinteger(lstate, index);
+  if (row < 0 || row > buf->b_ml.ml_line_count
+      || (!allow_end && row == buf->b_ml.ml_line_count)) {
+    luaL_error(lstate, "invalid row");
+  }
+  return (linenr_T)row;
+}
+
+/// Pushes `len` bytes of a line as a Lua string. Vim represents NULs as NLs,
+/// these are turned back into NULs like nvim_buf_get_lines() does.
+static void buf_view_push_text(lua_State *lstate, const char *s, size_t len)
+{
+  if (memchr(s, NL, len) == NULL) {
+    lua_pushlstring(lstate, s, len);
+    return;
+  }
+  char *tmp = xmemdupz(s, len);
+  memchrsub(tmp, NL, NUL, len);
+  lua_pushlstring(lstate, tmp, len);
+  xfree(tmp);
+}
+
+/// Returns whether the view can still be used.
+///
+/// view:valid()
+static int buf_view_valid(lua_State *lstate)
+{
+  BufView *view = luaL_checkudata(lstate, 1, BUF_VIEW_META);
+  lua_pushboolean(lstate, buf_view_buf(view) != NULL);
+  return 1;
+}
+
+/// view:line_count()
+static int buf_view_line_count(lua_State *lstate)
+{
+  buf_T *buf = buf_view_check(lstate);
+  lua_pushinteger(lstate, buf->b_ml.ml_line_count);
+  return 1;
+}
+
+/// Gets line `row` (0-based).
+///
+/// view:line(row)
+static int buf_view_line(lua_State *lstate)
+{
+  buf_T *buf = buf_view_check(lstate);
+  linenr_T row = buf_view_check_row(lstate, buf, 2, false);
+  char *line = ml_get_buf(buf, row + 1, false);
+  buf_view_push_text(lstate, line, strlen(line));
+  return 1;
+}
+
+/// Gets the length in bytes of line `row` (0-based).
+///
+/// view:line_len(row)
+static int buf_view_line_len(lua_State *lstate)
+{
+  buf_T *buf = buf_view_check(lstate);
+  linenr_T row = buf_view_check_row(lstate, buf, 2, false);
+  lua_pushinteger(lstate, (lua_Integer)strlen(ml_get_buf(buf, row + 1, false)));
+  return 1;
+}
+
+/// Gets the text from (start_row, start_col) up to (end_row, end_col), with
+/// lines separated by "\n". Like nvim_buf_get_text(), positions are 0-based
+/// and the end column is exclusive.
+///
+/// view:text(start_row, start_col, end_row, end_col)
+static int buf_view_text(lua_State *lstate)
+{
+  buf_T *buf = buf_view_check(lstate);
+  linenr_T start_row = buf_view_check_row(lstate, buf, 2, false);
+  lua_Integer start_col = luaL_checkinteger(lstate, 3);
+  linenr_T end_row = buf_view_check_row(lstate, buf, 4, false);
+  lua_Integer end_col = luaL_checkinteger(lstate, 5);
+  if (end_row < start_row || (end_row == start_row && end_col < start_col)) {
+    return luaL_error(lstate, "start is higher than end");
+  }
+
+  luaL_Buffer b;
+  luaL_buffinit(lstate, &b);
+  for (linenr_T row = start_row; row <= end_row; row++) {
+    char *line = ml_get_buf(buf, row + 1, false);
+    size_t len = strlen(line);
+    size_t from = 0;
+    size_t to = len;
+    if (row == start_row) {
+      if (start_col < 0 || (size_t)start_col > len) {
+        return luaL_error(lstate, "invalid start_col");
+      }
+      from = (size_t)start_col;
+    }
+    if (row == end_row) {
+      if (end_col < 0 || (size_t)end_col > len) {
+        return luaL_error(lstate, "invalid end_col");
+      }
+      to = (size_t)end_col;
+    }
+    while (from < to) {
+      const char *nl = memchr(line + from, NL, to - from);
+      size_t run = nl ? (size_t)(nl - line) - from : to - from;
+      luaL_addlstring(&b, line + from, run);
+      from += run;
+      if (nl) {
+        luaL_addchar(&b, NUL);
+        from++;
+      }
+    }
+    if (row < end_row) {
+      luaL_addchar(&b, '\n');
+    }
+  }
+  luaL_pushresult(&b);
+  return 1;
+}
+
+static int buf_view_lines_next(lua_State *lstate)
+{
+  BufView *view = lua_touserdata(lstate, lua_upvalueindex(1));
+  linenr_T row = (linenr_T)lua_tointeger(lstate, lua_upvalueindex(2));
+  linenr_T end_row = (linenr_T)lua_tointeger(lstate, lua_upvalueindex(3));
+  buf_T *buf = buf_view_buf(view);
+  if (buf == NULL) {
+    return luaL_error(lstate, "buffer view is outdated");
+  }
+  if (row >= end_row) {
+    return 0;
+  }
+  lua_pushinteger(lstate, row + 1);
+  lua_replace(lstate, lua_upvalueindex(2));
+
+  lua_pushinteger(lstate, row);
+  char *line = ml_get_buf(buf, row + 1, false);
+  buf_view_push_text(lstate, line, strlen(line));
+  return 2;
+}
+
+/// Iterates over the lines from `start_row` up to `end_row` (exclusive),
+/// returning the row and the line. Defaults to all lines.
+///
+/// for row, line in view:lines([start_row, end_row]) do ... end
+static int buf_view_lines(lua_State *lstate)
+{
+  buf_T *buf = buf_view_check(lstate);
+  linenr_T start_row = 0;
+  linenr_T end_row = buf->b_ml.ml_line_count;
+  if (!lua_isnoneornil(lstate, 2)) {
+    start_row = buf_view_check_row(lstate, buf, 2, true);
+  }
+  if (!lua_isnoneornil(lstate, 3)) {
+    end_row = buf_view_check_row(lstate, buf, 3, true);
+  }
+  lua_pushvalue(lstate, 1);
+  lua_pushinteger(lstate, start_row);
+  lua_pushinteger(lstate, end_row);
+  lua_pushcclosure(lstate, buf_view_lines_next, 3);
+  return 1;
+}
+
+/// Finds the first match of `pattern` at or after (start_row, start_col),
+/// before `end_row`. `pattern` is a Vim regex (see vim.regex()), which is
+/// matched within a single line, or a literal string if `plain` is true.
+///
+/// Returns the row, start column and end column (exclusive) of the match, or
+/// nil.
+///
+/// view:find(pattern [, start_row, start_col, end_row, plain])
+static int buf_view_find(lua_State *lstate)
+{
+  buf_T *buf = buf_view_check(lstate);
+  const char *pattern = luaL_checkstring(lstate, 2);
+  linenr_T start_row = 0;
+  lua_Integer start_col = 0;
+  linenr_T end_row = buf->b_ml.ml_line_count;
+  if (!lua_isnoneornil(lstate, 3)) {
+    start_row = buf_view_check_row(lstate, buf, 3, true);
+  }
+  if (!lua_isnoneornil(lstate, 4)) {
+    start_col = luaL_checkinteger(lstate, 4);
+  }
+  if (!lua_isnoneornil(lstate, 5)) {
+    end_row = buf_view_check_row(lstate, buf, 5, true);
+  }
+  bool plain = lua_toboolean(lstate, 6);
+
+  regmatch_T rm = { .regprog = NULL, .rm_ic = false };
+  if (!plain) {
+    Error err = ERROR_INIT;
+    TRY_WRAP({
+      try_start();
+      rm.regprog = vim_regcomp((char *)pattern, RE_AUTO | RE_MAGIC | RE_STRICT);
+      try_end(&err);
+    });
+    if (ERROR_SET(&err)) {
+      vim_regfree(rm.regprog);
+      nlua_push_errstr(lstate, "couldn't parse regex: %s", err.msg);
+      api_clear_error(&err);
+      return lua_error(lstate);
+    } else if (rm.regprog == NULL) {
+      return luaL_error(lstate, "couldn't parse regex");
+    }
+  }
+
+  int nret = 0;
+  for (linenr_T row = start_row; row < end_row; row++) {
+    char *line = ml_get_buf(buf, row + 1, false);
+    size_t col = 0;
+    if (row == start_row && start_col > 0) {
+      if ((size_t)start_col > strlen(line)) {
+        continue;
+      }
+      col = (size_t)start_col;
+    }
+    const char *start = NULL;
+    const char *end = NULL;
+    if (plain) {
+      start = strstr(line + col, pattern);
+      end = start ? start + strlen(pattern) : NULL;
+    } else if (vim_regexec(&rm, line, (colnr_T)col)) {
+      start = rm.startp[0];
+      end = rm.endp[0];
+    }
+    if (!plain && rm.regprog == NULL) {
+      return luaL_error(lstate, "regex: internal error");
+    }
+    if (start != NULL) {
+      lua_pushinteger(lstate, row);
+      lua_pushinteger(lstate, start - line);
+      lua_pushinteger(lstate, end - line);
+      nret = 3;
+      break;
+    }
+  }
+  vim_regfree(rm.regprog);
+  return nret;
+}
+
+static int buf_view_tostring(lua_State *lstate)
+{
+  BufView *view = luaL_checkudata(lstate, 1, BUF_VIEW_META);
+  lua_pushfstring(lstate, "<buf_view: buffer %d>", view->handle);
+  return 1;
+}
+
+static struct luaL_Reg buf_view_meta[] = {
+  { "__tostring", buf_view_tostring },
+  { "valid", buf_view_valid },
+  { "line_count", buf_view_line_count },
+  { "line", buf_view_line },
+  { "line_len", buf_view_line_len },
+  { "text", buf_view_text },
+  { "lines", buf_view_lines },
+  { "find", buf_view_find },
+  { NULL, NULL }
+};
+
+/// Creates a read-only view of a loaded buffer.
+///
+/// vim.buf_view(bufnr)
+static int nlua_buf_view(lua_State *lstate)
+  FUNC_ATTR_NONNULL_ALL
+{
+  lua_Integer bufnr = luaL_optinteger(lstate, 1, 0);
+  buf_T *buf = bufnr ? handle_get_buffer((handle_T)bufnr) : curbuf;
+  if (buf == NULL || buf->b_ml.ml_mfp == NULL) {
+    return luaL_error(lstate, "invalid buffer");
+  }
+
+  BufView *view = lua_newuserdata(lstate, sizeof(*view));
+  view->handle = buf->handle;
+  view->changedtick = buf_get_changedtick(buf);
+  luaL_getmetatable(lstate, BUF_VIEW_META);
+  lua_setmetatable(lstate, -2);
+  return 1;
+}
+
+/// Adds vim.buf_view() to the table on top of the stack.
+void nlua_buf_view_init(lua_State *const lstate)
+  FUNC_ATTR_NONNULL_ALL
+{
+  luaL_newmetatable(lstate, BUF_VIEW_META);
+  luaL_register(lstate, NULL, buf_view_meta);
+  lua_pushvalue(lstate, -1);  // [meta, meta]
+  lua_setfield(lstate, -2, "__index");  // [meta]
+  lua_pop(lstate, 1);
+
+  lua_pushcfunction(lstate, &nlua_buf_view);
+  lua_setfield(lstate, -2, "buf_view");
+}
@@ -0,0 +1,9 @@
+#ifndef NVIM_LUA_BUF_VIEW_H
+#define NVIM_LUA_BUF_VIEW_H
+
+#include <lua.h>
+
+#ifdef INCLUDE_GENERATED_DECLARATIONS
+# include "lua/buf_view.h.generated.h"
+#endif
+#endif  // NVIM_LUA_BUF_VIEW_H
@@ -26,6 +26,7 @@
 #include "nvim/gettext.h"
 #include "nvim/lua/converter.h"
 #include "nvim/lua/executor.h"
+#include "nvim/lua/lazy.h"
 #include "nvim/macros.h"
 #include "nvim/message.h"
 #include "nvim/types.h"
@@ -724,6 +725,7 @@ void nlua_push_Boolean(lua_State *lstate, const Boolean b, bool special)
 void nlua_push_Dictionary(lua_State *lstate, const Dictionary dict, bool special)
   FUNC_ATTR_NONNULL_ALL
 {
+  nlua_lazy_results_clear(lstate);
   if (dict.size == 0 && special) {
     nlua_create_typed_table(lstate, 0, 0, kObjectTypeDictionary);
   } else {
@@ -742,10 +744,16 @@ void nlua_push_Dictionary(lua_State *lstate, const Dictionary dict, bool special
 
 /// Convert given Array to lua table
 ///
-/// Leaves converted table on top of the stack.
+/// Leaves converted table on top of the stack. If a lazy result was requested
+/// (see nlua_lazy_results()) a lazy array with a copy of the items is pushed
+/// instead.
 void nlua_push_Array(lua_State *lstate, const Array array, bool special)
   FUNC_ATTR_NONNULL_ALL
 {
+  if (nlua_lazy_results(lstate)) {
+    nlua_push_lazy_Array(lstate, copy_array(array, NULL), special);
+    return;
+  }
   lua_createtable(lstate, (int)array.size, 0);
   for (size_t i = 0; i < array.size; i++) {
     nlua_push_Object(lstate, array.items[i], special);
@@ -956,6 +964,11 @@ static Array nlua_pop_Array_unchecked(lua_State *const lstate, const LuaTablePro
 Array nlua_pop_Array(lua_State *lstate, Error *err)
   FUNC_ATTR_NONNULL_ALL FUNC_ATTR_WARN_UNUSED_RESULT
 {
+  Array lazy;
+  if (nlua_lazy_array_copy(lstate, -1, &lazy)) {
+    lua_pop(lstate, 1);
+    return lazy;
+  }
   const LuaTableProps table_props = nlua_check_type(lstate, err,
                                                     kObjectTypeArray);
   if (table_props.type != kObjectTypeArray) {
@@ -1191,8 +1204,11 @@ Object nlua_pop_Object(lua_State *const lstate, bool ref, Error *const err)
       nlua_pushref(lstate, nlua_global_refs->nil_ref);
       bool is_nil = lua_rawequal(lstate, -2, -1);
       lua_pop(lstate, 1);
+      Array lazy;
       if (is_nil) {
         *cur.obj = NIL;
+      } else if (nlua_lazy_array_copy(lstate, -1, &lazy)) {
+        *cur.obj = ARRAY_OBJ(lazy);
       } else {
         api_set_error(err, kErrorTypeValidation,
                       "Cannot convert userdata");
@@ -29,6 +29,7 @@
 #include "nvim/event/defs.h"
 #include "nvim/event/loop.h"
 #include "nvim/event/multiqueue.h"
+#include "nvim/event/pool.h"
 #include "nvim/event/time.h"
 #include "nvim/ex_cmds.h"
 #include "nvim/ex_cmds_defs.h"
@@ -38,10 +39,14 @@
 #include "nvim/gettext.h"
 #include "nvim/globals.h"
 #include "nvim/keycodes.h"
+#include "nvim/lua/buf_view.h"
 #include "nvim/lua/converter.h"
 #include "nvim/lua/executor.h"
+#include "nvim/lua/json_rpc.h"
+#include "nvim/lua/lazy.h"
 #include "nvim/lua/stdlib.h"
 #include "nvim/lua/treesitter.h"
+#include "nvim/log.h"
 #include "nvim/macros.h"
 #include "nvim/main.h"
 #include "nvim/memline.h"
@@ -72,6 +77,11 @@ static LuaRef require_ref = LUA_REFNIL;
 
 static uv_thread_t main_thread;
 
+// Lua states of vim.pool workers, created on first use by each worker.
+static uv_key_t pool_lstate_key;
+static uv_mutex_t pool_lstates_mutex;
+static kvec_t(lua_State *) pool_lstates = KV_INITIAL_VALUE;
+
 typedef struct {
   Error err;
   String lua_err_str;
@@ -83,6 +93,16 @@ typedef struct {
   size_t size;
 } ModuleDef;
 
+/// Task submitted with vim.pool.submit(). Values cross the thread boundary as
+/// strings, so that no Lua object is shared between states.
+typedef struct {
+  String code;  ///< function dumped with lua_dump()
+  String args;  ///< arguments encoded with vim.mpack
+  String result;  ///< results encoded with vim.mpack, or the error message
+  bool failed;
+  LuaRef cb;
+} LuaPoolTask;
+
 #ifdef INCLUDE_GENERATED_DECLARATIONS
 # include "lua/executor.c.generated.h"
 # include "lua/vim_module.generated.h"
@@ -112,7 +132,7 @@ typedef enum luv_err_type {
 ///
 /// @param  lstate  Lua interpreter state.
 /// @param[in]  msg  Message base, must contain one `%s`.
-static void nlua_error(lua_State *const lstate, const char *const msg)
+void nlua_error(lua_State *const lstate, const char *const msg)
   FUNC_ATTR_NONNULL_ALL
 {
   size_t len;
@@ -144,7 +164,7 @@ static void nlua_error(lua_State *const lstate, const char *const msg)
 /// @param lstate Lua interpreter state
 /// @param[in] nargs Number of arguments expected by the function being called.
 /// @param[in] nresults Number of results the function returns.
-static int nlua_pcall(lua_State *lstate, int nargs, int nresults)
+int nlua_pcall(lua_State *lstate, int nargs, int nresults)
 {
   lua_getglobal(lstate, "debug");
   lua_getfield(lstate, -1, "traceback");
@@ -352,6 +372,219 @@ static int nlua_schedule(lua_State *const lstate)
   return 0;
 }
 
+static int nlua_dump_writer(lua_State *lstate, const void *p, size_t sz, void *ud)
+{
+  ga_concat_len((garray_T *)ud, p, sz);
+  return 0;
+}
+
+/// Calls vim.mpack.{name} on the value at the top of the stack, replacing it
+/// with the result or the error message.
+///
+/// @return 0 on success, non-zero if the call failed.
+static int nlua_mpack_call(lua_State *lstate, const char *name)
+  FUNC_ATTR_NONNULL_ALL
+{
+  lua_getglobal(lstate, "vim");
+  lua_getfield(lstate, -1, "mpack");
+  lua_getfield(lstate, -1, name);
+  lua_remove(lstate, -2);
+  lua_remove(lstate, -2);
+  lua_insert(lstate, -2);
+  return lua_pcall(lstate, 1, 1, 0);
+}
+
+/// Encodes the values at `first`..top as a table with an `n` field and pops
+/// them.
+///
+/// @return 0 on success, non-zero with the error message on the stack.
+static int nlua_pool_encode(lua_State *lstate, int first, String *out)
+  FUNC_ATTR_NONNULL_ALL
+{
+  int n = lua_gettop(lstate) - first + 1;
+  lua_createtable(lstate, n, 1);
+  lua_insert(lstate, first);
+  for (int i = n; i >= 1; i--) {
+    lua_rawseti(lstate, first, i);
+  }
+  lua_pushinteger(lstate, n);
+  lua_setfield(lstate, -2, "n");
+  if (nlua_mpack_call(lstate, "encode")) {
+    return 1;
+  }
+  size_t len;
+  const char *str = lua_tolstring(lstate, -1, &len);
+  *out = cbuf_to_string(str, len);
+  lua_pop(lstate, 1);
+  return 0;
+}
+
+/// Decodes a string produced by nlua_pool_encode() and pushes its values.
+///
+/// @return number of pushed values, or -1 with the error message on the stack.
+static int nlua_pool_decode(lua_State *lstate, String str)
+  FUNC_ATTR_NONNULL_ALL
+{
+  lua_pushlstring(lstate, str.data, str.size);
+  if (nlua_mpack_call(lstate, "decode")) {
+    return -1;
+  }
+  lua_getfield(lstate, -1, "n");
+  int n = (int)lua_tointeger(lstate, -1);
+  lua_pop(lstate, 1);
+  luaL_checkstack(lstate, n, "vim.pool: too many values");
+  int t = lua_gettop(lstate);
+  for (int i = 1; i <= n; i++) {
+    lua_rawgeti(lstate, t, i);
+  }
+  lua_remove(lstate, t);
+  return n;
+}
+
+/// Gets the Lua state of the current vim.pool worker, creating it if needed.
+static lua_State *nlua_pool_lstate(void)
+{
+  lua_State *lstate = uv_key_get(&pool_lstate_key);
+  if (lstate == NULL) {
+    lstate = nlua_thread_acquire_vm();
+    uv_key_set(&pool_lstate_key, lstate);
+    uv_mutex_lock(&pool_lstates_mutex);
+    kv_push(pool_lstates, lstate);
+    uv_mutex_unlock(&pool_lstates_mutex);
+  }
+  return lstate;
+}
+
+/// Runs a vim.pool task on a worker thread.
+static void nlua_pool_work(void *data)
+{
+  LuaPoolTask *task = data;
+  lua_State *const lstate = nlua_pool_lstate();
+  int base = lua_gettop(lstate);
+
+  // Like nlua_pcall(), but the number of results is not known.
+  lua_getglobal(lstate, "debug");
+  lua_getfield(lstate, -1, "traceback");
+  lua_remove(lstate, -2);
+  int errfunc = lua_gettop(lstate);
+
+  int status = luaL_loadbuffer(lstate, task->code.data, task->code.size, "=vim.pool");
+  int nargs = 0;
+  if (status == 0) {
+    nargs = nlua_pool_decode(lstate, task->args);
+    status = nargs < 0;
+  }
+  if (status == 0) {
+    status = lua_pcall(lstate, nargs, LUA_MULTRET, errfunc);
+  }
+  if (status == 0) {
+    status = nlua_pool_encode(lstate, errfunc + 1, &task->result);
+  }
+  if (status) {
+    size_t len;
+    const char *str = lua_tolstring(lstate, -1, &len);
+    task->result = str ? cbuf_to_string(str, len) : cstr_to_string("(error object is not a string)");
+    task->failed = true;
+  }
+  lua_settop(lstate, base);
+}
+
+/// Calls the vim.pool.submit() callback on the main loop.
+static void nlua_pool_done(void *data)
+{
+  LuaPoolTask *task = data;
+  lua_State *const lstate = global_lstate;
+  if (task->cb != LUA_NOREF) {
+    nlua_pushref(lstate, task->cb);
+    nlua_unref_global(lstate, task->cb);
+    int nargs;
+    if (task->failed) {
+      lua_pushlstring(lstate, task->result.data, task->result.size);
+      nargs = 1;
+    } else {
+      lua_pushnil(lstate);
+      nargs = nlua_pool_decode(lstate, task->result);
+      if (nargs < 0) {
+        lua_remove(lstate, -2);
+        nargs = 1;
+      } else {
+        nargs++;
+      }
+    }
+    if (nlua_pcall(lstate, nargs, 0)) {
+      nlua_error(lstate, _("Error executing vim.pool callback: %.*s"));
+    }
+  }
+  nlua_pool_task_free(task);
+}
+
+/// Frees a vim.pool task that is not run, without calling the callback.
+static void nlua_pool_cancel(void *data)
+{
+  LuaPoolTask *task = data;
+  nlua_unref_global(global_lstate, task->cb);
+  nlua_pool_task_free(task);
+}
+
+static void nlua_pool_task_free(LuaPoolTask *task)
+{
+  api_free_string(task->code);
+  api_free_string(task->args);
+  api_free_string(task->result);
+  xfree(task);
+}
+
+/// Runs a Lua function on the thread pool.
+///
+/// vim.pool.submit(fn, ...[, callback])
+///
+/// @param  lstate  Lua interpreter state.
+static int nlua_pool_submit(lua_State *const lstate)
+  FUNC_ATTR_NONNULL_ALL
+{
+  if (lua_type(lstate, 1) != LUA_TFUNCTION || lua_iscfunction(lstate, 1)) {
+    lua_pushliteral(lstate, "vim.pool.submit: expected Lua function");
+    return lua_error(lstate);
+  }
+
+  garray_T code;
+  ga_init(&code, 1, 1024);
+  lua_pushvalue(lstate, 1);
+  lua_dump(lstate, nlua_dump_writer, &code);
+  lua_pop(lstate, 1);
+
+  LuaRef cb = LUA_NOREF;
+  if (lua_gettop(lstate) > 1 && lua_type(lstate, -1) == LUA_TFUNCTION) {
+    cb = nlua_ref_global(lstate, -1);
+    lua_pop(lstate, 1);
+  }
+
+  String args;
+  if (nlua_pool_encode(lstate, 2, &args)) {
+    ga_clear(&code);
+    nlua_unref_global(lstate, cb);
+    return luaL_error(lstate, "vim.pool.submit: %s", lua_tostring(lstate, -1));
+  }
+
+  LuaPoolTask *task = xcalloc(1, sizeof(*task));
+  task->code = cbuf_to_string(code.ga_data, (size_t)code.ga_len);
+  task->args = args;
+  task->cb = cb;
+  ga_clear(&code);
+  pool_submit(nlua_pool_work, nlua_pool_done, nlua_pool_cancel, task);
+  return 0;
+}
+
+/// Gets the number of vim.pool workers.
+///
+/// @param  lstate  Lua interpreter state.
+static int nlua_pool_size(lua_State *const lstate)
+  FUNC_ATTR_NONNULL_ALL
+{
+  lua_pushinteger(lstate, (lua_Integer)pool_size());
+  return 1;
+}
+
 // Dummy timer callback. Used by f_wait().
 static void dummy_timer_due_cb(TimeWatcher *tw, void *data)
 {}
@@ -739,6 +972,23 @@ static bool nlua_state_init(lua_State *const lstate) FUNC_ATTR_NONNULL_ALL
   lua_pushcfunction(lstate, &nlua_ui_detach);
   lua_setfield(lstate, -2, "ui_detach");
 
+  // pool
+  lua_createtable(lstate, 0, 2);
+  lua_pushcfunction(lstate, &nlua_pool_submit);
+  lua_setfield(lstate, -2, "submit");
+  lua_pushcfunction(lstate, &nlua_pool_size);
+  lua_setfield(lstate, -2, "size");
+  lua_setfield(lstate, -2, "pool");
+
+  // _json_rpc_reader
+  nlua_json_rpc_init(lstate);
+
+  // _lazy
+  nlua_lazy_init(lstate);
+
+  // buf_view
+  nlua_buf_view_init(lstate);
+
   nlua_common_vim_init(lstate, false);
 
   // patch require() (only for --startuptime)
@@ -788,13 +1038,23 @@ void nlua_init(void)
     os_exit(1);
   }
 
-  luv_set_thread_cb(nlua_thread_acquire_vm, nlua_common_free_all_mem);
+  luv_set_thread_cb(nlua_thread_acquire_vm, nlua_thread_release_vm);
+  uv_key_create(&pool_lstate_key);
+  uv_mutex_init(&pool_lstates_mutex);
 
   global_lstate = lstate;
 
   main_thread = uv_thread_self();
 }
 
+/// Frees the VM of a vim.loop thread, called on the thread before it ends.
+static void nlua_thread_release_vm(lua_State *lstate)
+  FUNC_ATTR_NONNULL_ALL
+{
+  nlua_common_free_all_mem(lstate);
+  log_thread_exit();
+}
+
 static lua_State *nlua_thread_acquire_vm(void)
 {
   // If it is called from the main thread, it will attempt to rebuild the cache.
@@ -840,6 +1100,89 @@ static lua_State *nlua_thread_acquire_vm(void)
   return lstate;
 }
 
+/// Lua state the ":profile sample" hook was called in, can be a coroutine.
+static lua_State *sample_lstate = NULL;
+
+/// Hook that was set (e.g. with debug.sethook()) when the ":profile sample"
+/// hook was armed, it is set again when the sample is taken.
+static struct {
+  lua_Hook func;
+  int mask;
+  int count;
+} sample_saved_hook;
+
+/// Arms the ":profile sample" hook, which takes the pending sample when the
+/// next Lua instruction is executed. Called from a signal handler.
+///
+/// With LuaJIT the hook is shared by all coroutines. With PUC Lua it is only
+/// set for the main Lua thread, a sample that is due while a coroutine runs
+/// is taken when it yields.
+void nlua_sample_arm(void)
+{
+  if (global_lstate == NULL || lua_gethook(global_lstate) == nlua_sample_hook) {
+    return;
+  }
+  sample_saved_hook.func = lua_gethook(global_lstate);
+  sample_saved_hook.mask = lua_gethookmask(global_lstate);
+  sample_saved_hook.count = lua_gethookcount(global_lstate);
+  lua_sethook(global_lstate, nlua_sample_hook, LUA_MASKCOUNT, 1);
+}
+
+/// Disarms the ":profile sample" hook, the previous hook is set again.
+void nlua_sample_disarm(void)
+{
+  if (global_lstate == NULL || lua_gethook(global_lstate) != nlua_sample_hook) {
+    return;
+  }
+  lua_sethook(global_lstate, sample_saved_hook.func, sample_saved_hook.mask,
+              sample_saved_hook.count);
+}
+
+static void nlua_sample_hook(lua_State *lstate, lua_Debug *ar)
+{
+  lua_sethook(lstate, sample_saved_hook.func, sample_saved_hook.mask, sample_saved_hook.count);
+  if (profile_sample_pending) {
+    sample_lstate = lstate;
+    profile_sample_take(true);
+    sample_lstate = NULL;
+  }
+  // Pass on the event if the previous hook wants it.
+  if (sample_saved_hook.func != NULL && (sample_saved_hook.mask & LUA_MASKCOUNT)
+      && sample_saved_hook.count == 1) {
+    sample_saved_hook.func(lstate, ar);
+  }
+}
+
+/// Adds the Lua functions that are being executed to a ":profile sample"
+/// stack, outermost first.
+void nlua_sample_stack(StringBuilder *stack)
+  FUNC_ATTR_NONNULL_ALL
+{
+  lua_State *lstate = sample_lstate ? sample_lstate : global_lstate;
+  if (lstate == NULL) {
+    return;
+  }
+  lua_Debug ar;
+  int depth = 0;
+  while (lua_getstack(lstate, depth, &ar)) {
+    depth++;
+  }
+  for (int level = depth - 1; level >= 0; level--) {
+    if (!lua_getstack(lstate, level, &ar) || !lua_getinfo(lstate, "Sn", &ar)) {
+      continue;
+    }
+    char frame[IOSIZE];
+    int len;
+    if (*ar.what == 'C') {
+      len = snprintf(frame, sizeof(frame), "%s [C]", ar.name ? ar.name : "?");
+    } else {
+      len = snprintf(frame, sizeof(frame), "%s %s:%d", ar.name ? ar.name : "?", ar.short_src,
+                     ar.linedefined);
+    }
+    profile_sample_add_frame(stack, frame, MIN((size_t)len, sizeof(frame) - 1));
+  }
+}
+
 void nlua_free_all_mem(void)
 {
   if (!global_lstate) {
@@ -848,6 +1191,12 @@ void nlua_free_all_mem(void)
   lua_State *lstate = global_lstate;
   nlua_unref_global(lstate, require_ref);
   nlua_common_free_all_mem(lstate);
+
+  // The pool was stopped by event_teardown().
+  for (size_t i = 0; i < kv_size(pool_lstates); i++) {
+    nlua_common_free_all_mem(kv_A(pool_lstates, i));
+  }
+  kv_destroy(pool_lstates);
 }
 
 static void nlua_common_free_all_mem(lua_State *lstate)
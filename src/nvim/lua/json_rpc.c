@@ -0,0 +1,764 @@
+// This is an open source non-commercial project. Dear PVS-Studio, please check
+// it. PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+
+// Reader for JSON-RPC streams with Content-Length headers, like the Language
+// Server Protocol (vim._json_rpc_reader()).
+//
+// The received data is split into messages and their JSON is parsed on the
+// thread pool. A parsed message is a flat list of nodes, where an array or
+// object node is followed by its items, and all strings are already unescaped.
+// The main thread only turns these nodes into Lua values, which needs no
+// scanning of the JSON text.
+//
+// At most one batch of data is processed at a time, so that the messages are
+// passed to the callback in the order they were received. Data fed while a
+// batch is processed is kept in `pending` and processed after it.
+
+#include <assert.h>
+#include <lauxlib.h>
+#include <lua.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "klib/kvec.h"
+#include "nvim/ascii.h"
+#include "nvim/charset.h"
+#include "nvim/eval/encode.h"
+#include "nvim/event/pool.h"
+#include "nvim/gettext.h"
+#include "nvim/globals.h"
+#include "nvim/json_scan.h"
+#include "nvim/lua/executor.h"
+#include "nvim/lua/json_rpc.h"
+#include "nvim/macros.h"
+#include "nvim/mbyte.h"
+#include "nvim/memory.h"
+#include "nvim/vim.h"
+
+#define JSON_RPC_READER_META "nvim_json_rpc_reader"
+
+// Same limit as vim.json.decode().
+#define JSON_MAX_DEPTH 1000
+
+typedef enum {
+  kJsonNodeNull,
+  kJsonNodeFalse,
+  kJsonNodeTrue,
+  kJsonNodeNumber,
+  kJsonNodeString,
+  kJsonNodeArray,
+  kJsonNodeObject,
+} JsonNodeType;
+
+typedef struct {
+  uint8_t type;  ///< JsonNodeType
+  uint32_t size;  ///< bytes of a string, items of an array, pairs of an object
+  union {
+    double number;
+    size_t offset;  ///< of a string in JsonRpcReader.strings
+  } data;
+} JsonNode;
+
+typedef struct {
+  size_t node;  ///< first node of the message
+  char *error;  ///< NULL if the message was parsed
+  bool header_error;
+} JsonRpcMessage;
+
+typedef struct {
+  lua_State *lstate;
+  LuaRef on_message;
+  LuaRef on_error;
+  LuaRef on_closed;
+  kvec_t(char) buf;  ///< received data that is not consumed yet
+  kvec_t(char) pending;  ///< data received while `busy`
+  size_t need;  ///< bytes `buf` needs before another message can be complete
+  bool busy;  ///< `buf` is processed, or the results are passed to callbacks
+  bool closing;
+  bool collected;  ///< the userdata was garbage collected
+  // Results of the processed batch, written by the worker.
+  size_t consumed;
+  kvec_t(JsonRpcMessage) messages;
+  kvec_t(JsonNode) nodes;
+  kvec_t(char) strings;
+} JsonRpcReader;
+
+typedef struct {
+  JsonRpcReader *r;
+  const char *p;
+  const char *end;
+  int depth;
+  const char *error;
+} JsonParser;
+
+#ifdef INCLUDE_GENERATED_DECLARATIONS
+# include "lua/json_rpc.c.generated.h"
+#endif
+
+static bool json_fail(JsonParser *jp, const char *error)
+{
+  jp->error = error;
+  return false;
+}
+
+static void json_skip_white(JsonParser *jp)
+{
+  while (jp->p < jp->end
+         && (*jp->p == ' ' || *jp->p == TAB || *jp->p == NL || *jp->p == CAR)) {
+    jp->p++;
+  }
+}
+
+static bool json_parse_value(JsonParser *jp)
+{
+  json_skip_white(jp);
+  if (jp->p == jp->end) {
+    return json_fail(jp, "unexpected end of input");
+  }
+  switch (*jp->p) {
+  case '{':
+    return json_parse_container(jp, kJsonNodeObject, '}');
+  case '[':
+    return json_parse_container(jp, kJsonNodeArray, ']');
+  case '"':
+    return json_parse_string(jp);
+  case 't':
+    return json_parse_literal(jp, "true", kJsonNodeTrue);
+  case 'f':
+    return json_parse_literal(jp, "false", kJsonNodeFalse);
+  case 'n':
+    return json_parse_literal(jp, "null", kJsonNodeNull);
+  default:
+    return json_parse_number(jp);
+  }
+}
+
+static bool json_parse_literal(JsonParser *jp, const char *word, JsonNodeType type)
+{
+  size_t len = strlen(word);
+  if ((size_t)(jp->end - jp->p) < len || memcmp(jp->p, word, len) != 0) {
+    return json_fail(jp, "invalid token");
+  }
+  jp->p += len;
+  kv_push(jp->r->nodes, ((JsonNode){ .type = (uint8_t)type }));
+  return true;
+}
+
+static bool json_parse_number(JsonParser *jp)
+{
+  const char *const s = jp->p;
+  const char *p = s;
+  const char *const e = jp->end;
+  if (*p == '-') {
+    p++;
+  }
+  if (p == e || !ascii_isdigit(*p)) {
+    return json_fail(jp, "invalid token");
+  }
+  const char *const ints = p;
+  if (*p == '0') {
+    p++;
+  } else {
+    while (p < e && ascii_isdigit(*p)) {
+      p++;
+    }
+  }
+  const char *const ints_end = p;
+  bool is_int = true;
+  if (p < e && *p == '.') {
+    is_int = false;
+    p++;
+    if (p == e || !ascii_isdigit(*p)) {
+      return json_fail(jp, "invalid number");
+    }
+    while (p < e && ascii_isdigit(*p)) {
+      p++;
+    }
+  }
+  if (p < e && (*p == 'e' || *p == 'E')) {
+    is_int = false;
+    p++;
+    if (p < e && (*p == '-' || *p == '+')) {
+      p++;
+    }
+    if (p == e || !ascii_isdigit(*p)) {
+      return json_fail(jp, "invalid number");
+    }
+    while (p < e && ascii_isdigit(*p)) {
+      p++;
+    }
+  }
+
+  double number;
+  if (is_int && ints_end - ints <= 18) {
+    // Exact as an int64_t, and rounded only once when converted.
+    int64_t n = 0;
+    for (const char *d = ints; d < ints_end; d++) {
+      n = n * 10 + (*d - '0');
+    }
+    number = (double)(*s == '-' ? -n : n);
+  } else {
+    char buf[64];
+    size_t len = (size_t)(p - s);
+    char *str = len < sizeof(buf) ? buf : xmalloc(len + 1);
+    memcpy(str, s, len);
+    str[len] = NUL;
+    number = strtod(str, NULL);
+    if (str != buf) {
+      xfree(str);
+    }
+  }
+  jp->p = p;
+  kv_push(jp->r->nodes, ((JsonNode){ .type = kJsonNodeNumber, .data.number = number }));
+  return true;
+}
+
+/// Parses the four hex digits of a "\u" escape at `p`.
+///
+/// @return the code unit, or -1 if they are not hex digits.
+static int json_parse_hex4(const char *p, const char *end)
+{
+  if (end - p < 4) {
+    return -1;
+  }
+  int n = 0;
+  for (int i = 0; i < 4; i++) {
+    if (!ascii_isxdigit(p[i])) {
+      return -1;
+    }
+    n = (n << 4) + hex2nr(p[i]);
+  }
+  return n;
+}
+
+static bool json_parse_string(JsonParser *jp)
+{
+  JsonRpcReader *const r = jp->r;
+  const size_t offset = kv_size(r->strings);
+  const char *p = jp->p + 1;
+  const char *const e = jp->end;
+  while (true) {
+    const size_t run = json_plain_len(p, (size_t)(e - p), false);
+    kv_concat_len(r->strings, p, run);
+    p += run;
+    if (p == e) {
+      jp->p = p;
+      return json_fail(jp, "unexpected end of string");
+    }
+    if (*p == '"') {
+      break;
+    } else if (*p != '\\') {
+      // Control characters are accepted, like vim.json.decode() does.
+      kv_push(r->strings, *p);
+      p++;
+      continue;
+    }
+
+    jp->p = p;
+    if (p + 1 == e) {
+      return json_fail(jp, "unexpected end of string");
+    }
+    char c;
+    switch (p[1]) {
+    case '"':
+    case '\\':
+    case '/':
+      c = p[1];
+      break;
+    case 'b':
+      c = BS;
+      break;
+    case 'f':
+      c = FF;
+      break;
+    case 'n':
+      c = NL;
+      break;
+    case 'r':
+      c = CAR;
+      break;
+    case 't':
+      c = TAB;
+      break;
+    case 'u': {
+      int ch = json_parse_hex4(p + 2, e);
+      size_t len = 6;
+      if (ch >= SURROGATE_HI_START && ch <= SURROGATE_HI_END) {
+        int lo = (e - p >= 8 && p[6] == '\\' && p[7] == 'u') ? json_parse_hex4(p + 8, e) : -1;
+        if (lo < SURROGATE_LO_START || lo > SURROGATE_LO_END) {
+          return json_fail(jp, "invalid unicode escape code");
+        }
+        ch = ((ch - SURROGATE_HI_START) << 10) + (lo - SURROGATE_LO_START) + SURROGATE_FIRST_CHAR;
+        len = 12;
+      } else if (ch < 0 || (ch >= SURROGATE_LO_START && ch <= SURROGATE_LO_END)) {
+        return json_fail(jp, "invalid unicode escape code");
+      }
+      char utf8[MB_MAXBYTES];
+      int utf8_len = utf_char2bytes(ch, utf8);
+      kv_concat_len(r->strings, utf8, (size_t)utf8_len);
+      p += len;
+      continue;
+    }
+    default:
+      return json_fail(jp, "invalid escape code");
+    }
+    kv_push(r->strings, c);
+    p += 2;
+  }
+
+  const size_t len = kv_size(r->strings) - offset;
+  if (len > UINT32_MAX) {
+    return json_fail(jp, "string too long");
+  }
+  kv_push(r->nodes, ((JsonNode){
+    .type = kJsonNodeString,
+    .size = (uint32_t)len,
+    .data.offset = offset,
+  }));
+  jp->p = p + 1;
+  return true;
+}
+
+static bool json_parse_container(JsonParser *jp, JsonNodeType type, char close)
+{
+  if (++jp->depth > JSON_MAX_DEPTH) {
+    return json_fail(jp, "too many nested arrays or objects");
+  }
+  const size_t idx = kv_size(jp->r->nodes);
+  kv_push(jp->r->nodes, ((JsonNode){ .type = (uint8_t)type }));
+  jp->p++;
+  json_skip_white(jp);
+  uint32_t size = 0;
+  if (jp->p < jp->end && *jp->p == close) {
+    jp->p++;
+  } else {
+    while (true) {
+      if (type == kJsonNodeObject) {
+        json_skip_white(jp);
+        if (jp->p == jp->end || *jp->p != '"') {
+          return json_fail(jp, "expected object key string");
+        } else if (!json_parse_string(jp)) {
+          return false;
+        }
+        json_skip_white(jp);
+        if (jp->p == jp->end || *jp->p != ':') {
+          return json_fail(jp, "expected colon");
+        }
+        jp->p++;
+      }
+      if (!json_parse_value(jp)) {
+        return false;
+      }
+      size++;
+      json_skip_white(jp);
+      if (jp->p < jp->end && *jp->p == ',') {
+        jp->p++;
+      } else if (jp->p < jp->end && *jp->p == close) {
+        jp->p++;
+        break;
+      } else {
+        return json_fail(jp, (type == kJsonNodeObject
+                              ? "expected comma or object end"
+                              : "expected comma or array end"));
+      }
+    }
+  }
+  kv_A(jp->r->nodes, idx).size = size;
+  jp->depth--;
+  return true;
+}
+
+/// Parses one message body and appends it to the results of the batch.
+static void json_rpc_parse_body(JsonRpcReader *r, const char *body, size_t len)
+{
+  JsonRpcMessage msg = { .node = kv_size(r->nodes) };
+  JsonParser jp = {
+    .r = r,
+    .p = body,
+    .end = body + len,
+  };
+  if (json_parse_value(&jp)) {
+    json_skip_white(&jp);
+    if (jp.p != jp.end) {
+      json_fail(&jp, "expected the end");
+    }
+  }
+  if (jp.error != NULL) {
+    size_t size = strlen(jp.error) + 40;
+    msg.error = xmalloc(size);
+    snprintf(msg.error, size, "%s at character %zu", jp.error, (size_t)(jp.p - body) + 1);
+    kv_size(r->nodes) = msg.node;
+  }
+  kv_push(r->messages, msg);
+}
+
+/// Gets the Content-Length of a message with headers `hdr`.
+///
+/// @return the length, or -1 if it is missing or not a number.
+static int64_t json_rpc_content_length(const char *hdr, size_t len, const char **error)
+{
+  int64_t content_length = -1;
+  const char *const end = hdr + len;
+  const char *line = hdr;
+  while (line < end) {
+    const char *line_end = xmemscan(line, CAR, (size_t)(end - line));
+    const char *p = skipwhite_len(line, (size_t)(line_end - line));
+    const char *key = p;
+    while (p < line_end && *p != ':' && !ascii_iswhite(*p)) {
+      p++;
+    }
+    const char *key_end = p;
+    p = skipwhite_len(p, (size_t)(line_end - p));
+    if (key == key_end || p == line_end || *p != ':') {
+      *error = "invalid header line";
+      return -1;
+    }
+    p = skipwhite_len(p + 1, (size_t)(line_end - p - 1));
+    if ((size_t)(key_end - key) == sizeof("content-length") - 1
+        && (STRNICMP(key, "content-length", key_end - key) == 0
+            || STRNICMP(key, "content_length", key_end - key) == 0)) {
+      content_length = 0;
+      const char *digits = p;
+      while (p < line_end && ascii_isdigit(*p) && content_length <= UINT32_MAX) {
+        content_length = content_length * 10 + (*p++ - '0');
+      }
+      if (p == digits || content_length > UINT32_MAX
+          || skipwhite_len(p, (size_t)(line_end - p)) != line_end) {
+        *error = "invalid Content-Length";
+        return -1;
+      }
+    }
+    line = line_end + 2;
+  }
+  if (content_length < 0) {
+    *error = "Content-Length not found in headers";
+  }
+  return content_length;
+}
+
+/// Splits the data in `buf` into messages and parses them. Runs on a worker
+/// thread.
+static void json_rpc_work(void *data)
+{
+  JsonRpcReader *r = data;
+  const char *const buf = r->buf.items;
+  const size_t size = kv_size(r->buf);
+  size_t pos = 0;
+  r->need = 0;
+  while (pos < size) {
+    const char *const s = buf + pos;
+    const size_t avail = size - pos;
+    // Servers may write other things before the headers, which all start with
+    // "Content-".
+    const char *hdr_end = NULL;
+    for (const char *p = s; (p = memchr(p, CAR, avail - (size_t)(p - s))) != NULL; p++) {
+      if (avail - (size_t)(p - s) >= 4 && memcmp(p, "\r\n\r\n", 4) == 0) {
+        hdr_end = p;
+        break;
+      }
+    }
+    if (hdr_end == NULL) {
+      r->need = avail + 1;
+      break;
+    }
+    const size_t hdr_len = (size_t)(hdr_end - s) + 4;
+    const char *hdr = s;
+    while (hdr < hdr_end && STRNICMP(hdr, "content", MIN(7, hdr_end - hdr)) != 0) {
+      hdr++;
+    }
+    const char *error = NULL;
+    int64_t content_length = hdr + 7 <= hdr_end
+                             ? json_rpc_content_length(hdr, (size_t)(hdr_end - hdr), &error)
+                             : (error = "Content-Length not found in headers", -1);
+    if (content_length < 0) {
+      size_t len = strlen(error) + (size_t)(hdr_end - s) + 4;
+      JsonRpcMessage msg = { .error = xmalloc(len), .header_error = true };
+      snprintf(msg.error, len, "%s: %.*s", error, (int)(hdr_end - s), s);
+      kv_push(r->messages, msg);
+      pos += hdr_len;
+      continue;
+    }
+    if (avail - hdr_len < (size_t)content_length) {
+      r->need = hdr_len + (size_t)content_length;
+      break;
+    }
+    json_rpc_parse_body(r, s + hdr_len, (size_t)content_length);
+    pos += hdr_len + (size_t)content_length;
+  }
+  r->consumed = pos;
+}
+
+/// Pushes the Lua value of node `idx` and gets the index of the node after it.
+///
+/// @param  luanil  Push `nil` for null, otherwise vim.NIL.
+static size_t json_rpc_push_node(lua_State *lstate, JsonRpcReader *r, size_t idx, bool luanil)
+{
+  const JsonNode node = kv_A(r->nodes, idx++);
+  switch ((JsonNodeType)node.type) {
+  case kJsonNodeNull:
+    if (luanil) {
+      lua_pushnil(lstate);
+    } else {
+      nlua_pushref(lstate, nlua_get_nil_ref(lstate));
+    }
+    break;
+  case kJsonNodeFalse:
+  case kJsonNodeTrue:
+    lua_pushboolean(lstate, node.type == kJsonNodeTrue);
+    break;
+  case kJsonNodeNumber:
+    lua_pushnumber(lstate, node.data.number);
+    break;
+  case kJsonNodeString:
+    lua_pushlstring(lstate, r->strings.items + node.data.offset, node.size);
+    break;
+  case kJsonNodeArray:
+    luaL_checkstack(lstate, 2, "too many nested arrays or objects");
+    lua_createtable(lstate, (int)node.size, 0);
+    for (uint32_t i = 1; i <= node.size; i++) {
+      idx = json_rpc_push_node(lstate, r, idx, false);
+      lua_rawseti(lstate, -2, (int)i);
+    }
+    break;
+  case kJsonNodeObject:
+    luaL_checkstack(lstate, 3, "too many nested arrays or objects");
+    lua_createtable(lstate, 0, (int)node.size);
+    if (node.size == 0) {
+      nlua_pushref(lstate, nlua_get_empty_dict_ref(lstate));
+      lua_setmetatable(lstate, -2);
+    }
+    for (uint32_t i = 0; i < node.size; i++) {
+      idx = json_rpc_push_node(lstate, r, idx, false);
+      // Like vim.json.decode() with luanil.object: a null value is no entry.
+      idx = json_rpc_push_node(lstate, r, idx, true);
+      lua_rawset(lstate, -3);
+    }
+    break;
+  }
+  return idx;
+}
+
+/// Passes the results of a batch to the callbacks on the main loop.
+static void json_rpc_done(void *data)
+{
+  JsonRpcReader *r = data;
+  lua_State *const lstate = r->lstate;
+
+  if (exiting) {
+    // Don't call plugins or start another batch while Nvim exits.
+    json_rpc_cancel(r);
+    return;
+  }
+
+  for (size_t i = 0; i < kv_size(r->messages) && !r->collected; i++) {
+    JsonRpcMessage *msg = &kv_A(r->messages, i);
+    if (msg->error != NULL) {
+      nlua_pushref(lstate, r->on_error);
+      lua_pushstring(lstate, msg->error);
+      lua_pushstring(lstate, msg->header_error ? "header" : "body");
+    } else {
+      nlua_pushref(lstate, r->on_message);
+      json_rpc_push_node(lstate, r, msg->node, true);
+      lua_pushnil(lstate);
+    }
+    if (nlua_pcall(lstate, 2, 0)) {
+      nlua_error(lstate, _("Error executing vim._json_rpc_reader callback: %.*s"));
+    }
+  }
+  json_rpc_clear_results(r);
+  r->busy = false;
+  if (r->collected) {
+    json_rpc_reader_free(r);
+    return;
+  }
+
+  // Drop what was consumed and add what was received in the meantime.
+  size_t rest = kv_size(r->buf) - r->consumed;
+  memmove(r->buf.items, r->buf.items + r->consumed, rest);
+  kv_size(r->buf) = rest;
+  if (kv_size(r->pending) > 0) {
+    kv_concat_len(r->buf, r->pending.items, kv_size(r->pending));
+    kv_size(r->pending) = 0;
+  }
+  r->consumed = 0;
+
+  if (!json_rpc_process(r) && r->closing) {
+    json_rpc_call_on_closed(r);
+  }
+}
+
+/// Ends a batch without passing its results to the callbacks: when Nvim exits,
+/// or when the thread pool discards the batch. Frees the reader if it was
+/// garbage collected meanwhile.
+static void json_rpc_cancel(void *data)
+{
+  JsonRpcReader *r = data;
+  json_rpc_clear_results(r);
+  r->busy = false;
+  if (r->collected) {
+    json_rpc_reader_free(r);
+  }
+}
+
+static void json_rpc_clear_results(JsonRpcReader *r)
+{
+  for (size_t i = 0; i < kv_size(r->messages); i++) {
+    xfree(kv_A(r->messages, i).error);
+  }
+  kv_size(r->messages) = 0;
+  kv_size(r->nodes) = 0;
+  kv_size(r->strings) = 0;
+}
+
+/// Starts processing `buf` if it may contain another message.
+///
+/// @return true if processing was started.
+static bool json_rpc_process(JsonRpcReader *r)
+{
+  if (kv_size(r->buf) == 0 || kv_size(r->buf) < r->need) {
+    return false;
+  }
+  r->busy = true;
+  pool_submit(json_rpc_work, json_rpc_done, json_rpc_cancel, r);
+  return true;
+}
+
+static void json_rpc_call_on_closed(JsonRpcReader *r)
+{
+  LuaRef cb = r->on_closed;
+  r->on_closed = LUA_NOREF;
+  if (cb != LUA_NOREF) {
+    nlua_pushref(r->lstate, cb);
+    nlua_unref_global(r->lstate, cb);
+    if (nlua_pcall(r->lstate, 0, 0)) {
+      nlua_error(r->lstate, _("Error executing vim._json_rpc_reader callback: %.*s"));
+    }
+  }
+}
+
+static void json_rpc_reader_free(JsonRpcReader *r)
+{
+  nlua_unref_global(r->lstate, r->on_message);
+  nlua_unref_global(r->lstate, r->on_error);
+  nlua_unref_global(r->lstate, r->on_closed);
+  json_rpc_clear_results(r);
+  kv_destroy(r->buf);
+  kv_destroy(r->pending);
+  kv_destroy(r->messages);
+  kv_destroy(r->nodes);
+  kv_destroy(r->strings);
+  xfree(r);
+}
+
+static JsonRpcReader *json_rpc_reader_check(lua_State *lstate)
+{
+  JsonRpcReader **rp = luaL_checkudata(lstate, 1, JSON_RPC_READER_META);
+  return *rp;
+}
+
+/// reader:feed(data): processes received data.
+static int json_rpc_reader_feed(lua_State *lstate)
+{
+  JsonRpcReader *r = json_rpc_reader_check(lstate);
+  size_t len;
+  const char *data = luaL_checklstring(lstate, 2, &len);
+  if (r->closing) {
+    return luaL_error(lstate, "reader is closed");
+  }
+  if (r->busy) {
+    kv_concat_len(r->pending, data, len);
+  } else {
+    kv_concat_len(r->buf, data, len);
+    json_rpc_process(r);
+  }
+  return 0;
+}
+
+/// reader:close([callback]): stops accepting data. `callback` is called after
+/// the messages in the data fed before were passed to `on_message`.
+static int json_rpc_reader_close(lua_State *lstate)
+{
+  JsonRpcReader *r = json_rpc_reader_check(lstate);
+  if (r->closing) {
+    return 0;
+  }
+  r->closing = true;
+  if (lua_isfunction(lstate, 2)) {
+    r->on_closed = nlua_ref_global(lstate, 2);
+    if (!r->busy) {
+      json_rpc_call_on_closed(r);
+    }
+  }
+  return 0;
+}
+
+static int json_rpc_reader_gc(lua_State *lstate)
+{
+  JsonRpcReader *r = json_rpc_reader_check(lstate);
+  if (r->busy) {
+    // Freed when the batch is done.
+    r->collected = true;
+  } else {
+    json_rpc_reader_free(r);
+  }
+  return 0;
+}
+
+static int json_rpc_reader_tostring(lua_State *lstate)
+{
+  lua_pushstring(lstate, "<json_rpc_reader>");
+  return 1;
+}
+
+static struct luaL_Reg json_rpc_reader_meta[] = {
+  { "__gc", json_rpc_reader_gc },
+  { "__tostring", json_rpc_reader_tostring },
+  { "feed", json_rpc_reader_feed },
+  { "close", json_rpc_reader_close },
+  { NULL, NULL }
+};
+
+/// Creates a reader of a JSON-RPC stream with Content-Length headers.
+///
+/// vim._json_rpc_reader(on_message, on_error)
+///
+/// `on_message(msg)` is called with each message, decoded like
+/// `vim.json.decode(body, { luanil = { object = true } })`.
+/// `on_error(err, kind)` is called for a message that could not be read,
+/// `kind` is "header" or "body".
+static int nlua_json_rpc_reader(lua_State *lstate)
+  FUNC_ATTR_NONNULL_ALL
+{
+  luaL_checktype(lstate, 1, LUA_TFUNCTION);
+  luaL_checktype(lstate, 2, LUA_TFUNCTION);
+
+  JsonRpcReader *r = xcalloc(1, sizeof(*r));
+  r->lstate = lstate;
+  r->on_message = nlua_ref_global(lstate, 1);
+  r->on_error = nlua_ref_global(lstate, 2);
+  r->on_closed = LUA_NOREF;
+
+  JsonRpcReader **rp = lua_newuserdata(lstate, sizeof(*rp));
+  *rp = r;
+  luaL_getmetatable(lstate, JSON_RPC_READER_META);
+  lua_setmetatable(lstate, -2);
+  return 1;
+}
+
+/// Adds vim._json_rpc_reader() to the table on top of the stack.
+void nlua_json_rpc_init(lua_State *const lstate)
+  FUNC_ATTR_NONNULL_ALL
+{
+  luaL_newmetatable(lstate, JSON_RPC_READER_META);
+  luaL_register(lstate, NULL, json_rpc_reader_meta);
+  lua_pushvalue(lstate, -1);  // [meta, meta]
+  lua_setfield(lstate, -2, "__index");  // [meta]
+  lua_pop(lstate, 1);
+
+  lua_pushcfunction(lstate, &nlua_json_rpc_reader);
+  lua_setfield(lstate, -2, "_json_rpc_reader");
+}
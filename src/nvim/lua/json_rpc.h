@@ -0,0 +1,9 @@
+#ifndef NVIM_LUA_JSON_RPC_H
+#define NVIM_LUA_JSON_RPC_H
+
+#include <lua.h>
+
+#ifdef INCLUDE_GENERATED_DECLARATIONS
+# include "lua/json_rpc.h.generated.h"
+#endif
+#endif  // NVIM_LUA_JSON_RPC_H
@@ -0,0 +1,313 @@
+// This is an open source non-commercial project. Dear PVS-Studio, please check
+// it. PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+
+// Lazy arrays: API results that are only converted to Lua values when they
+// are indexed (vim._lazy()).
+//
+// A lazy array is a userdata that owns either an API Array or, for buffer
+// lines, all the lines in one block of text. Indexing it pushes the Lua value
+// of a single item, so getting many lines or extmarks and looking at a few of
+// them doesn't create a Lua string or table for each of them. API functions
+// taking an Array accept a lazy array and copy its items without going through
+// Lua values at all.
+
+#include <assert.h>
+#include <lauxlib.h>
+#include <lua.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+
+#include "klib/kvec.h"
+#include "nvim/api/private/defs.h"
+#include "nvim/api/private/helpers.h"
+#include "nvim/lua/converter.h"
+#include "nvim/lua/lazy.h"
+#include "nvim/macros.h"
+#include "nvim/memory.h"
+
+#define LAZY_ARRAY_META "nvim_lazy_array"
+
+typedef struct {
+  bool lines;  ///< items are in `text`, not in `items`
+  bool special;  ///< passed to nlua_push_Object()
+  Array items;
+  kvec_t(char) text;  ///< all lines, not NUL-terminated
+  kvec_t(size_t) offsets;  ///< line i is text[offsets[i]] up to offsets[i + 1]
+} LazyArray;
+
+/// Whether API results are pushed as lazy arrays, see nlua_lazy().
+static bool lazy_results = false;
+/// State and call depth of the function called by vim._lazy(). Only its own
+/// result can be lazy, not the results of API functions that it calls.
+static lua_State *lazy_lstate = NULL;
+static int lazy_depth = 0;
+
+#ifdef INCLUDE_GENERATED_DECLARATIONS
+# include "lua/lazy.c.generated.h"
+#endif
+
+/// Gets the number of functions on the call stack of `lstate`.
+static int lazy_call_depth(lua_State *lstate)
+{
+  lua_Debug ar;
+  int depth = 0;
+  while (lua_getstack(lstate, depth, &ar)) {
+    depth++;
+  }
+  return depth;
+}
+
+/// Checks whether a result is being converted for the function called by
+/// vim._lazy() itself.
+static bool lazy_results_here(lua_State *lstate)
+{
+  return lazy_results && lstate == lazy_lstate && lazy_call_depth(lstate) == lazy_depth;
+}
+
+/// Checks whether the next array result should be a lazy array. Only the first
+/// array result of the function called by vim._lazy() is, the flag is cleared
+/// by this. Arrays converted by functions it calls are never lazy.
+bool nlua_lazy_results(lua_State *lstate)
+  FUNC_ATTR_NONNULL_ALL
+{
+  if (!lazy_results_here(lstate)) {
+    return false;
+  }
+  lazy_results = false;
+  return true;
+}
+
+/// Clears the flag checked by nlua_lazy_results() if it applies to the
+/// function converting a result. Used for results that contain arrays, which
+/// are never lazy.
+void nlua_lazy_results_clear(lua_State *lstate)
+  FUNC_ATTR_NONNULL_ALL
+{
+  if (lazy_results_here(lstate)) {
+    lazy_results = false;
+  }
+}
+
+static LazyArray *lazy_array_new(lua_State *lstate)
+{
+  LazyArray *la = lua_newuserdata(lstate, sizeof(*la));
+  *la = (LazyArray) { .lines = false };
+  luaL_getmetatable(lstate, LAZY_ARRAY_META);
+  lua_setmetatable(lstate, -2);
+  return la;
+}
+
+/// Pushes a lazy array with the items of `array`.
+///
+/// @param array  Array, owned by the lazy array.
+/// @param special  Passed to nlua_push_Object() for the items.
+void nlua_push_lazy_Array(lua_State *lstate, Array array, bool special)
+  FUNC_ATTR_NONNULL_ALL
+{
+  LazyArray *la = lazy_array_new(lstate);
+  la->items = array;
+  la->special = special;
+}
+
+/// Pushes an empty lazy array of lines, see nlua_lazy_lines_add().
+///
+/// @param size  Expected number of lines.
+void nlua_push_lazy_lines(lua_State *lstate, size_t size)
+  FUNC_ATTR_NONNULL_ALL
+{
+  LazyArray *la = lazy_array_new(lstate);
+  la->lines = true;
+  kv_resize(la->offsets, size + 1);
+  kv_push(la->offsets, 0);
+}
+
+/// Adds a line to the lazy array of lines on top of the stack.
+///
+/// @param replace_nl  Replace newlines ('\n') with NUL.
+void nlua_lazy_lines_add(lua_State *lstate, const char *s, size_t len, bool replace_nl)
+  FUNC_ATTR_NONNULL_ARG(1)
+{
+  LazyArray *la = lua_touserdata(lstate, -1);
+  assert(la != NULL && la->lines);
+  if (len > 0) {
+    size_t start = kv_size(la->text);
+    kv_concat_len(la->text, s, len);
+    if (replace_nl) {
+      memchrsub(&kv_A(la->text, start), '\n', '\0', len);
+    }
+  }
+  kv_push(la->offsets, kv_size(la->text));
+}
+
+static size_t lazy_array_size(const LazyArray *la)
+{
+  return la->lines ? kv_size(la->offsets) - 1 : la->items.size;
+}
+
+/// Gets the lazy array at `index`, or NULL if the value is something else.
+static LazyArray *lazy_array_get(lua_State *lstate, int index)
+{
+  if (lua_type(lstate, index) != LUA_TUSERDATA || !lua_getmetatable(lstate, index)) {
+    return NULL;
+  }
+  luaL_getmetatable(lstate, LAZY_ARRAY_META);
+  bool is_lazy = lua_rawequal(lstate, -1, -2);
+  lua_pop(lstate, 2);
+  return is_lazy ? lua_touserdata(lstate, index) : NULL;
+}
+
+/// Copies the items of a lazy array to an API Array.
+///
+/// @param  index  Stack index of the value, which is not popped.
+/// @param[out]  ret  Allocated copy of the items.
+///
+/// @return false if the value is not a lazy array.
+bool nlua_lazy_array_copy(lua_State *lstate, int index, Array *ret)
+  FUNC_ATTR_NONNULL_ALL FUNC_ATTR_WARN_UNUSED_RESULT
+{
+  LazyArray *la = lazy_array_get(lstate, index);
+  if (la == NULL) {
+    return false;
+  }
+  if (!la->lines) {
+    *ret = copy_array(la->items, NULL);
+    return true;
+  }
+  size_t size = lazy_array_size(la);
+  *ret = (Array) { .size = size, .capacity = size };
+  ret->items = size ? xmalloc(size * sizeof(*ret->items)) : NULL;
+  for (size_t i = 0; i < size; i++) {
+    size_t start = kv_A(la->offsets, i);
+    ret->items[i] = STRING_OBJ(cbuf_to_string(kv_size(la->text) ? &kv_A(la->text, start) : "",
+                                              kv_A(la->offsets, i + 1) - start));
+  }
+  return true;
+}
+
+/// Pushes item `idx` (0-based) of a lazy array.
+static void lazy_array_push_item(lua_State *lstate, const LazyArray *la, size_t idx)
+{
+  if (la->lines) {
+    size_t start = kv_A(la->offsets, idx);
+    lua_pushlstring(lstate, kv_size(la->text) ? &kv_A(la->text, start) : "",
+                    kv_A(la->offsets, idx + 1) - start);
+  } else {
+    // Arrays in the items are converted to tables.
+    bool save = lazy_results;
+    lazy_results = false;
+    nlua_push_Object(lstate, la->items.items[idx], la->special);
+    lazy_results = save;
+  }
+}
+
+static int lazy_array_index(lua_State *lstate)
+{
+  LazyArray *la = luaL_checkudata(lstate, 1, LAZY_ARRAY_META);
+  if (lua_type(lstate, 2) != LUA_TNUMBER) {
+    // Methods.
+    lua_getmetatable(lstate, 1);
+    lua_pushvalue(lstate, 2);
+    lua_rawget(lstate, -2);
+    return 1;
+  }
+  lua_Number n = lua_tonumber(lstate, 2);
+  if (n < 1 || n > (lua_Number)lazy_array_size(la) || n != (lua_Number)(size_t)n) {
+    lua_pushnil(lstate);
+    return 1;
+  }
+  lazy_array_push_item(lstate, la, (size_t)n - 1);
+  return 1;
+}
+
+static int lazy_array_len(lua_State *lstate)
+{
+  LazyArray *la = luaL_checkudata(lstate, 1, LAZY_ARRAY_META);
+  lua_pushnumber(lstate, (lua_Number)lazy_array_size(la));
+  return 1;
+}
+
+/// Converts the lazy array to a table.
+///
+/// array:totable()
+static int lazy_array_totable(lua_State *lstate)
+{
+  LazyArray *la = luaL_checkudata(lstate, 1, LAZY_ARRAY_META);
+  size_t size = lazy_array_size(la);
+  lua_createtable(lstate, (int)size, 0);
+  for (size_t i = 0; i < size; i++) {
+    lazy_array_push_item(lstate, la, i);
+    lua_rawseti(lstate, -2, (int)i + 1);
+  }
+  return 1;
+}
+
+static int lazy_array_gc(lua_State *lstate)
+{
+  LazyArray *la = luaL_checkudata(lstate, 1, LAZY_ARRAY_META);
+  api_free_array(la->items);
+  kv_destroy(la->text);
+  kv_destroy(la->offsets);
+  *la = (LazyArray) { .lines = false };
+  return 0;
+}
+
+static int lazy_array_tostring(lua_State *lstate)
+{
+  LazyArray *la = luaL_checkudata(lstate, 1, LAZY_ARRAY_META);
+  lua_pushfstring(lstate, "<lazy_array: %d items>", (int)lazy_array_size(la));
+  return 1;
+}
+
+static struct luaL_Reg lazy_array_meta[] = {
+  { "__index", lazy_array_index },
+  { "__len", lazy_array_len },
+  { "__gc", lazy_array_gc },
+  { "__tostring", lazy_array_tostring },
+  { "totable", lazy_array_totable },
+  { NULL, NULL }
+};
+
+/// Calls an API function and returns its result as a lazy array.
+///
+/// vim._lazy(fn, ...)
+///
+/// If `fn` returns an array, like nvim_buf_get_lines() or
+/// nvim_buf_get_extmarks(), it is returned as a userdata that supports `#`
+/// and indexing, and converts an item to a Lua value only when it is indexed.
+/// `:totable()` converts all of it. Other results are returned unchanged.
+/// Only the result of `fn` itself can be lazy, so `fn` must be the API
+/// function and not a Lua function calling it.
+static int nlua_lazy(lua_State *lstate)
+  FUNC_ATTR_NONNULL_ALL
+{
+  luaL_checktype(lstate, 1, LUA_TFUNCTION);
+  // vim._lazy() may be used by a function that `fn` calls.
+  const bool save_results = lazy_results;
+  lua_State *const save_lstate = lazy_lstate;
+  const int save_depth = lazy_depth;
+  lazy_results = true;
+  lazy_lstate = lstate;
+  // `fn` is called right above this function.
+  lazy_depth = lazy_call_depth(lstate) + 1;
+  int status = lua_pcall(lstate, lua_gettop(lstate) - 1, LUA_MULTRET, 0);
+  lazy_results = save_results;
+  lazy_lstate = save_lstate;
+  lazy_depth = save_depth;
+  if (status != 0) {
+    return lua_error(lstate);
+  }
+  return lua_gettop(lstate);
+}
+
+/// Adds vim._lazy() to the table on top of the stack.
+void nlua_lazy_init(lua_State *const lstate)
+  FUNC_ATTR_NONNULL_ALL
+{
+  luaL_newmetatable(lstate, LAZY_ARRAY_META);
+  luaL_register(lstate, NULL, lazy_array_meta);
+  lua_pop(lstate, 1);
+
+  lua_pushcfunction(lstate, &nlua_lazy);
+  lua_setfield(lstate, -2, "_lazy");
+}
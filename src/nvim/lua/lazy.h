@@ -0,0 +1,9 @@
+#ifndef NVIM_LUA_LAZY_H
+#define NVIM_LUA_LAZY_H
+
+#include <lua.h>
+
+#ifdef INCLUDE_GENERATED_DECLARATIONS
+# include "lua/lazy.h.generated.h"
+#endif
+#endif  // NVIM_LUA_LAZY_H
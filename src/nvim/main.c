@@ -27,6 +27,7 @@
 #include "nvim/eval/typval.h"
 #include "nvim/eval/typval_defs.h"
 #include "nvim/event/multiqueue.h"
+#include "nvim/event/pool.h"
 #include "nvim/event/stream.h"
 #include "nvim/ex_cmds.h"
 #include "nvim/ex_docmd.h"
@@ -133,7 +134,11 @@ static const char *err_extra_cmd =
 void event_init(void)
 {
   loop_init(&main_loop, NULL);
+  multiqueue_set_kind(main_loop.events, kMultiQueueMain);
+  multiqueue_set_kind(main_loop.fast_events, kMultiQueueFast);
   resize_events = multiqueue_new_child(main_loop.events);
+  multiqueue_set_kind(resize_events, kMultiQueueUI);
+  pool_init(&main_loop);
 
   // early msgpack-rpc initialization
   msgpack_rpc_helpers_init();
@@ -154,6 +159,10 @@ bool event_teardown(void)
     return true;
   }
 
+  // Wait for running tasks, workers may schedule events. Tasks that did not
+  // start are cancelled, so are tasks submitted by the callbacks below.
+  pool_teardown();
+  loop_poll_events(&main_loop, 0);  // Move their callbacks to main_loop.events.
   multiqueue_process_events(main_loop.events);
   loop_poll_events(&main_loop, 0);  // Drain thread_events, fast_events.
   input_stop();
@@ -619,6 +628,7 @@ void os_exit(int r)
   }
 
   ILOG("Nvim exit: %d", r);
+  log_teardown();
 
 #ifdef EXITFREE
   free_all_mem();
@@ -722,6 +732,7 @@ void getout(int exitval)
   }
 
   profile_dump();
+  profile_sample_stop();
 
   if (did_emsg) {
     // give the user a chance to read the (error) message
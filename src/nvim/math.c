@@ -4,9 +4,11 @@
 // uncrustify:off
 #include <math.h>
 // uncrustify:on
+#include <assert.h>
 #include <stdint.h>
 #include <string.h>
 
+#include "nvim/func_attr.h"
 #include "nvim/math.h"
 
 #ifdef INCLUDE_GENERATED_DECLARATIONS
@@ -41,3 +43,42 @@ int xisnan(double d)
 {
   return FP_NAN == xfpclassify(d);
 }
+
+/// Floor of the base-2 logarithm of `x`, i.e. the index of its most
+/// significant set bit.
+///
+/// @param x  Value, must be non-zero.
+int xlog2(uint64_t x)
+  FUNC_ATTR_CONST
+{
+  assert(x != 0);
+#ifdef __GNUC__
+  return 63 - __builtin_clzll(x);
+#else
+  int rv = 0;
+  while (x >>= 1) {
+    rv++;
+  }
+  return rv;
+#endif
+}
+
+/// Number of trailing zero bits in `x`, i.e. the index of its least
+/// significant set bit.
+///
+/// @param x  Value, must be non-zero.
+int xctz(uint64_t x)
+  FUNC_ATTR_CONST
+{
+  assert(x != 0);
+#ifdef __GNUC__
+  return __builtin_ctzll(x);
+#else
+  int rv = 0;
+  while ((x & 1) == 0) {
+    x >>= 1;
+    rv++;
+  }
+  return rv;
+#endif
+}
@@ -1,6 +1,8 @@
 #ifndef NVIM_MATH_H
 #define NVIM_MATH_H
 
+#include <stdint.h>
+
 #ifdef INCLUDE_GENERATED_DECLARATIONS
 # include "math.h.generated.h"
 #endif
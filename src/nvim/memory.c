@@ -86,6 +86,7 @@ void try_to_free_memory(void)
 void *try_malloc(size_t size) FUNC_ATTR_MALLOC FUNC_ATTR_ALLOC_SIZE(1)
 {
   size_t allocated_size = size ? size : 1;
+  alloc_count++;
   void *ret = malloc(allocated_size);
   if (!ret) {
     try_to_free_memory();
@@ -148,6 +149,7 @@ void *xcalloc(size_t count, size_t size)
 {
   size_t allocated_count = count && size ? count : 1;
   size_t allocated_size = count && size ? size : 1;
+  alloc_count++;
   void *ret = calloc(allocated_count, allocated_size);
   if (!ret) {
     try_to_free_memory();
@@ -170,6 +172,7 @@ void *xrealloc(void *ptr, size_t size)
   FUNC_ATTR_WARN_UNUSED_RESULT FUNC_ATTR_ALLOC_SIZE(2) FUNC_ATTR_NONNULL_RET
 {
   size_t allocated_size = size ? size : 1;
+  alloc_count++;
   void *ret = realloc(ptr, allocated_size);
   if (!ret) {
     try_to_free_memory();
@@ -540,6 +543,8 @@ void time_to_bytes(time_t time_, uint8_t buf[8])
 
 #define ARENA_BLOCK_SIZE 4096
 #define REUSE_MAX 4
+/// Written over memory freed by arena_reset() in debug builds.
+#define ARENA_POISON 0xDB
 
 static struct consumed_blk *arena_reuse_blk;
 static size_t arena_reuse_blk_count = 0;
@@ -563,7 +568,9 @@ static void arena_free_reuse_blks(void)
 ArenaMem arena_finish(Arena *arena)
 {
   struct consumed_blk *res = (struct consumed_blk *)arena->cur_blk;
+  ArenaStats *stats = arena->stats;
   *arena = (Arena)ARENA_EMPTY;
+  arena->stats = stats;
   return res;
 }
 
@@ -576,6 +583,9 @@ void alloc_block(Arena *arena)
     arena_reuse_blk_count--;
   } else {
     arena_alloc_count++;
+    if (arena->stats) {
+      arena->stats->malloc_count++;
+    }
     arena->cur_blk = xmalloc(ARENA_BLOCK_SIZE);
   }
   arena->pos = 0;
@@ -596,6 +606,10 @@ void *arena_alloc(Arena *arena, size_t size, bool align)
   if (!arena) {
     return xmalloc(size);
   }
+  if (arena->stats) {
+    arena->stats->alloc_count++;
+    arena->stats->alloc_bytes += size;
+  }
   if (!arena->cur_blk) {
     alloc_block(arena);
   }
@@ -607,6 +621,9 @@ void *arena_alloc(Arena *arena, size_t size, bool align)
       // arena->size / 2, as there likely is space left for the next
       // small allocation in the current block.
       arena_alloc_count++;
+      if (arena->stats) {
+        arena->stats->malloc_count++;
+      }
       size_t hdr_size = sizeof(struct consumed_blk);
       size_t aligned_hdr_size = (align ? arena_align_offset(hdr_size) : hdr_size);
       char *alloc = xmalloc(size + aligned_hdr_size);
@@ -649,6 +666,85 @@ void arena_mem_free(ArenaMem mem)
   }
 }
 
+/// Gets the current position in an arena, to free what is allocated after it
+/// with arena_reset().
+ArenaMark arena_mark(const Arena *arena)
+  FUNC_ATTR_NONNULL_ALL FUNC_ATTR_PURE
+{
+  return (ArenaMark) {
+    .blk = arena->cur_blk,
+    .prev = arena->cur_blk ? ((struct consumed_blk *)arena->cur_blk)->prev : NULL,
+    .pos = arena->pos,
+  };
+}
+
+/// Frees the memory allocated from an arena since `mark` was taken. Other
+/// allocations stay valid.
+///
+/// In debug builds the freed part of the current block is overwritten, so that
+/// a use after the reset is likely to be noticed.
+void arena_reset(Arena *arena, ArenaMark mark)
+  FUNC_ATTR_NONNULL_ALL
+{
+  if (mark.blk == NULL) {
+    arena_mem_free(arena_finish(arena));
+    return;
+  }
+  // Blocks added after the mark, and large allocations linked after them.
+  struct consumed_blk *mark_blk = (struct consumed_blk *)mark.blk;
+  struct consumed_blk *b = (struct consumed_blk *)arena->cur_blk;
+  while (b != mark_blk) {
+    struct consumed_blk *prev = b->prev;
+    xfree(b);
+    b = prev;
+  }
+  // Large allocations made while the marked block was the current one.
+  b = mark_blk->prev;
+  while (b != mark.prev) {
+    struct consumed_blk *prev = b->prev;
+    xfree(b);
+    b = prev;
+  }
+  mark_blk->prev = mark.prev;
+#ifndef NDEBUG
+  memset(mark.blk + mark.pos, ARENA_POISON, ARENA_BLOCK_SIZE - mark.pos);
+#endif
+  arena->cur_blk = mark.blk;
+  arena->pos = mark.pos;
+  arena->size = ARENA_BLOCK_SIZE;
+}
+
+/// Enters a scope, see ArenaScope. Every call must be matched by a call to
+/// arena_scope_leave() with the returned mark.
+ArenaMark arena_scope_enter(ArenaScope *scope)
+  FUNC_ATTR_NONNULL_ALL
+{
+  scope->arena.stats = &scope->stats;
+  scope->stats.scope_count++;
+  scope->depth++;
+  return arena_mark(&scope->arena);
+}
+
+/// Leaves a scope and frees the memory allocated in it.
+void arena_scope_leave(ArenaScope *scope, ArenaMark mark)
+  FUNC_ATTR_NONNULL_ALL
+{
+  assert(scope->depth > 0);
+  scope->depth--;
+  arena_reset(&scope->arena, mark);
+}
+
+/// Gets the arena of a scope, to allocate memory that is not used after the
+/// scope ends.
+///
+/// @return the arena, or NULL when not in the scope: arena_alloc() then uses
+///         xmalloc() and the caller must free the memory.
+Arena *arena_scope_get(ArenaScope *scope)
+  FUNC_ATTR_NONNULL_ALL FUNC_ATTR_PURE
+{
+  return scope->depth > 0 ? &scope->arena : NULL;
+}
+
 char *arena_memdupz(Arena *arena, const char *buf, size_t size)
 {
   char *mem = arena_alloc(arena, size + 1, false);
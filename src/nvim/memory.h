@@ -41,19 +41,52 @@ extern bool entered_free_all_mem;
 
 EXTERN size_t arena_alloc_count INIT(= 0);
 
+/// Number of malloc(), calloc() and realloc() calls.  Not synchronized, only
+/// exact while no other thread allocates.
+EXTERN size_t alloc_count INIT(= 0);
+
 typedef struct consumed_blk {
   struct consumed_blk *prev;
 } *ArenaMem;
 
 #define ARENA_ALIGN MAX(sizeof(void *), sizeof(double))
 
+/// Counters of an arena, see nvim__stats().
+typedef struct {
+  size_t alloc_count;  ///< arena_alloc() calls
+  size_t alloc_bytes;  ///< bytes requested by arena_alloc()
+  size_t malloc_count;  ///< blocks allocated with malloc(), not reused
+  size_t scope_count;  ///< scopes entered, see arena_scope_enter()
+} ArenaStats;
+
 typedef struct {
   char *cur_blk;
   size_t pos, size;
+  ArenaStats *stats;  ///< counters, or NULL
 } Arena;
 
 // inits an empty arena.
-#define ARENA_EMPTY { .cur_blk = NULL, .pos = 0, .size = 0 }
+#define ARENA_EMPTY { .cur_blk = NULL, .pos = 0, .size = 0, .stats = NULL }
+
+/// Position in an arena, see arena_mark().
+typedef struct {
+  char *blk;
+  struct consumed_blk *prev;
+  size_t pos;
+} ArenaMark;
+
+/// Arena for memory that is only used until the end of a scope. Scopes can be
+/// nested, leaving one frees what was allocated since it was entered.
+typedef struct {
+  Arena arena;
+  int depth;  ///< scopes entered and not left
+  ArenaStats stats;
+} ArenaScope;
+
+/// Scope of update_screen(): memory used while drawing the screen.
+EXTERN ArenaScope redraw_scope INIT(= { .depth = 0 });
+/// Scope of do_one_cmd(): memory used while executing an Ex command.
+EXTERN ArenaScope cmd_scope INIT(= { .depth = 0 });
 
 #define kv_fixsize_arena(a, v, s) \
   ((v).capacity = (s), \
@@ -334,7 +334,8 @@ bool msg_attr_keep(const char *s, int attr, bool keep, bool multiline)
 
   // Truncate the message if needed.
   msg_start();
-  buf = msg_strtrunc((char *)s, false);
+  Arena *arena = arena_scope_get(&cmd_scope);
+  buf = msg_strtrunc(arena, (char *)s, false);
   if (buf != NULL) {
     s = buf;
   }
@@ -356,7 +357,9 @@ bool msg_attr_keep(const char *s, int attr, bool keep, bool multiline)
 
   need_fileinfo = false;
 
-  xfree(buf);
+  if (arena == NULL) {
+    xfree(buf);
+  }
   entered--;
   return retval;
 }
@@ -365,8 +368,9 @@ bool msg_attr_keep(const char *s, int attr, bool keep, bool multiline)
 ///
 /// @return  an allocated string or NULL when no truncating is done.
 ///
+/// @param arena  if NULL, the caller must free the result
 /// @param force  always truncate
-char *msg_strtrunc(char *s, int force)
+char *msg_strtrunc(Arena *arena, char *s, int force)
 {
   char *buf = NULL;
   int len;
@@ -388,7 +392,7 @@ char *msg_strtrunc(char *s, int force)
       // may have up to 18 bytes per cell (6 per char, up to two
       // composing chars)
       len = (room + 2) * 18;
-      buf = xmalloc((size_t)len);
+      buf = arena_alloc(arena, (size_t)len, false);
       trunc_string(s, buf, room, len);
     }
   }
@@ -2469,10 +2473,14 @@ static void inc_msg_scrolled(void)
       p = _("Unknown");
     } else {
       size_t len = strlen(p) + 40;
-      tofree = xmalloc(len);
+      Arena *arena = arena_scope_get(&cmd_scope);
+      tofree = arena_alloc(arena, len, false);
       vim_snprintf(tofree, len, _("%s line %" PRId64),
                    p, (int64_t)SOURCING_LNUM);
       p = tofree;
+      if (arena != NULL) {
+        tofree = NULL;
+      }
     }
     set_vim_var_string(VV_SCROLLSTART, p, -1);
     xfree(tofree);
@@ -9,6 +9,7 @@
 #include "nvim/api/private/defs.h"
 #include "nvim/grid_defs.h"
 #include "nvim/macros.h"
+#include "nvim/memory.h"
 #include "nvim/types.h"
 
 // Types of dialogs passed to do_dialog().
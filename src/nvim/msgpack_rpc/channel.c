@@ -34,6 +34,7 @@
 #include "nvim/msgpack_rpc/unpacker.h"
 #include "nvim/os/input.h"
 #include "nvim/rbuffer.h"
+#include "nvim/strings.h"
 #include "nvim/types.h"
 #include "nvim/ui.h"
 #include "nvim/ui_client.h"
@@ -688,50 +689,98 @@ static const char *const msgpack_error_messages[] = {
 
 static void log_server_msg(uint64_t channel_id, msgpack_sbuffer *packed)
 {
+  if (!log_enabled(LOGLVL_DBG, "RPC")) {
+    return;
+  }
   msgpack_unpacked unpacked;
   msgpack_unpacked_init(&unpacked);
-  DLOGN("RPC ->ch %" PRIu64 ": ", channel_id);
   const msgpack_unpack_return result =
     msgpack_unpack_next(&unpacked, packed->data, packed->size, NULL);
+  StringBuilder msg = KV_INITIAL_VALUE;
   switch (result) {
   case MSGPACK_UNPACK_SUCCESS: {
     uint64_t type = unpacked.data.via.array.ptr[0].via.u64;
-    log_lock();
-    FILE *f = open_log_file();
-    fprintf(f, type ? (type == 1 ? RES : NOT) : REQ);
-    msgpack_object_print(f, unpacked.data);
-    log_close(f);
+    kv_concat(msg, type ? (type == 1 ? RES : NOT) : REQ);
+    log_msgpack_object(&msg, unpacked.data);
     msgpack_unpacked_destroy(&unpacked);
     break;
   }
   case MSGPACK_UNPACK_EXTRA_BYTES:
   case MSGPACK_UNPACK_CONTINUE:
   case MSGPACK_UNPACK_PARSE_ERROR:
-  case MSGPACK_UNPACK_NOMEM_ERROR: {
-    log_lock();
-    FILE *f = open_log_file();
-    fprintf(f, ERR);
-    fprintf(f, "%s", msgpack_error_messages[result + MUR_OFF]);
-    log_close(f);
+  case MSGPACK_UNPACK_NOMEM_ERROR:
+    kv_concat(msg, ERR);
+    kv_concat(msg, msgpack_error_messages[result + MUR_OFF]);
     break;
   }
-  }
+  logmsg_channel(LOGLVL_DBG, "RPC", channel_id, __func__, __LINE__, true, "-> %.*s",
+                 (int)kv_size(msg), msg.items);
+  kv_destroy(msg);
 }
 
 static void log_client_msg(uint64_t channel_id, bool is_request, const char *name)
 {
-  DLOGN("RPC <-ch %" PRIu64 ": ", channel_id);
-  log_lock();
-  FILE *f = open_log_file();
-  fprintf(f, "%s: %s", is_request ? REQ : RES, name);
-  log_close(f);
+  logmsg_channel(LOGLVL_DBG, "RPC", channel_id, __func__, __LINE__, true, "<- %s: %s",
+                 is_request ? REQ : RES, name);
 }
 
-static void log_close(FILE *f)
+/// Appends a msgpack object to a log message, like msgpack_object_print().
+static void log_msgpack_object(StringBuilder *msg, msgpack_object o)
 {
-  fputc('\n', f);
-  fflush(f);
-  fclose(f);
-  log_unlock();
+  switch (o.type) {
+  case MSGPACK_OBJECT_NIL:
+    kv_concat(*msg, "nil");
+    break;
+  case MSGPACK_OBJECT_BOOLEAN:
+    kv_concat(*msg, o.via.boolean ? "true" : "false");
+    break;
+  case MSGPACK_OBJECT_POSITIVE_INTEGER:
+    kv_printf(*msg, "%" PRIu64, o.via.u64);
+    break;
+  case MSGPACK_OBJECT_NEGATIVE_INTEGER:
+    kv_printf(*msg, "%" PRIi64, o.via.i64);
+    break;
+#ifdef NVIM_MSGPACK_HAS_FLOAT32
+  case MSGPACK_OBJECT_FLOAT32:
+  case MSGPACK_OBJECT_FLOAT64:
+#else
+  case MSGPACK_OBJECT_FLOAT:
+#endif
+    kv_printf(*msg, "%f", o.via.f64);
+    break;
+  case MSGPACK_OBJECT_STR:
+    kv_push(*msg, '"');
+    kv_concat_len(*msg, o.via.str.ptr, o.via.str.size);
+    kv_push(*msg, '"');
+    break;
+  case MSGPACK_OBJECT_BIN:
+    kv_printf(*msg, "<bin %" PRIu32 ">", o.via.bin.size);
+    break;
+  case MSGPACK_OBJECT_EXT:
+    kv_printf(*msg, "<ext %d, %" PRIu32 " bytes>", (int)o.via.ext.type, o.via.ext.size);
+    break;
+  case MSGPACK_OBJECT_ARRAY:
+    kv_push(*msg, '[');
+    for (uint32_t i = 0; i < o.via.array.size; i++) {
+      if (i > 0) {
+        kv_concat(*msg, ", ");
+      }
+      log_msgpack_object(msg, o.via.array.ptr[i]);
+    }
+    kv_push(*msg, ']');
+    break;
+  case MSGPACK_OBJECT_MAP:
+    kv_push(*msg, '{');
+    for (uint32_t i = 0; i < o.via.map.size; i++) {
+      if (i > 0) {
+        kv_concat(*msg, ", ");
+      }
+      log_msgpack_object(msg, o.via.map.ptr[i].key);
+      kv_concat(*msg, "=>");
+      log_msgpack_object(msg, o.via.map.ptr[i].val);
+    }
+    kv_push(*msg, '}');
+    break;
+  }
 }
 #endif
@@ -74,6 +74,7 @@ static void set_vservername(garray_T *srvs)
     ? ((SocketWatcher **)srvs->ga_data)[0]->addr
     : NULL;
   set_vim_var_string(VV_SEND_SERVER, default_server, -1);
+  log_set_name(default_server);
 }
 
 /// Teardown the server module
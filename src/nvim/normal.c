@@ -1374,7 +1374,7 @@ static int normal_check(VimState *state)
     // esp. updating folds.  Do an update just before redrawing if
     // needed.
     if (curtab->tp_diff_update || curtab->tp_diff_invalid) {
-      ex_diffupdate(NULL);
+      diff_update_async();
       curtab->tp_diff_update = false;
     }
 
@@ -586,6 +586,7 @@ void free_all_options(void)
   }
   free_operatorfunc_option();
   free_tagfunc_option();
+  free_optstr_table();
 }
 #endif
 
@@ -4063,10 +4064,7 @@ void win_copy_options(win_T *wp_from, win_T *wp_to)
 
 static char *copy_option_val(const char *val)
 {
-  if (val == empty_option) {
-    return empty_option;  // no need to allocate memory
-  }
-  return xstrdup(val);
+  return optstr_copy(val);
 }
 
 /// Copy the options from one winopt_T to another.
@@ -4108,7 +4106,7 @@ void copy_winopt(winopt_T *from, winopt_T *to)
   to->wo_cocu = copy_option_val(from->wo_cocu);
   to->wo_cole = from->wo_cole;
   to->wo_fdc = copy_option_val(from->wo_fdc);
-  to->wo_fdc_save = from->wo_diff_saved ? xstrdup(from->wo_fdc_save) : empty_option;
+  to->wo_fdc_save = from->wo_diff_saved ? copy_option_val(from->wo_fdc_save) : empty_option;
   to->wo_fen = from->wo_fen;
   to->wo_fen_save = from->wo_fen_save;
   to->wo_fdi = copy_option_val(from->wo_fdi);
@@ -4116,7 +4114,7 @@ void copy_winopt(winopt_T *from, winopt_T *to)
   to->wo_fdl = from->wo_fdl;
   to->wo_fdl_save = from->wo_fdl_save;
   to->wo_fdm = copy_option_val(from->wo_fdm);
-  to->wo_fdm_save = from->wo_diff_saved ? xstrdup(from->wo_fdm_save) : empty_option;
+  to->wo_fdm_save = from->wo_diff_saved ? copy_option_val(from->wo_fdm_save) : empty_option;
   to->wo_fdn = from->wo_fdn;
   to->wo_fde = copy_option_val(from->wo_fde);
   to->wo_fdt = copy_option_val(from->wo_fdt);
@@ -4273,19 +4271,19 @@ void buf_copy_options(buf_T *buf, int flags)
       if (!buf->b_p_initialized) {
         free_buf_options(buf, true);
         buf->b_p_ro = false;                    // don't copy readonly
-        buf->b_p_fenc = xstrdup(p_fenc);
+        buf->b_p_fenc = copy_option_val(p_fenc);
         switch (*p_ffs) {
         case 'm':
-          buf->b_p_ff = xstrdup(FF_MAC);
+          buf->b_p_ff = copy_option_val(FF_MAC);
           break;
         case 'd':
-          buf->b_p_ff = xstrdup(FF_DOS);
+          buf->b_p_ff = copy_option_val(FF_DOS);
           break;
         case 'u':
-          buf->b_p_ff = xstrdup(FF_UNIX);
+          buf->b_p_ff = copy_option_val(FF_UNIX);
           break;
         default:
-          buf->b_p_ff = xstrdup(p_ff);
+          buf->b_p_ff = copy_option_val(p_ff);
           break;
         }
         buf->b_p_bh = empty_option;
@@ -4330,25 +4328,25 @@ void buf_copy_options(buf_T *buf, int flags)
         buf->b_p_swf = p_swf;
         COPY_OPT_SCTX(buf, BV_SWF);
       }
-      buf->b_p_cpt = xstrdup(p_cpt);
+      buf->b_p_cpt = copy_option_val(p_cpt);
       COPY_OPT_SCTX(buf, BV_CPT);
 #ifdef BACKSLASH_IN_FILENAME
-      buf->b_p_csl = xstrdup(p_csl);
+      buf->b_p_csl = copy_option_val(p_csl);
       COPY_OPT_SCTX(buf, BV_CSL);
 #endif
-      buf->b_p_cfu = xstrdup(p_cfu);
+      buf->b_p_cfu = copy_option_val(p_cfu);
       COPY_OPT_SCTX(buf, BV_CFU);
       set_buflocal_cfu_callback(buf);
-      buf->b_p_ofu = xstrdup(p_ofu);
+      buf->b_p_ofu = copy_option_val(p_ofu);
       COPY_OPT_SCTX(buf, BV_OFU);
       set_buflocal_ofu_callback(buf);
-      buf->b_p_tfu = xstrdup(p_tfu);
+      buf->b_p_tfu = copy_option_val(p_tfu);
       COPY_OPT_SCTX(buf, BV_TFU);
       set_buflocal_tfu_callback(buf);
       buf->b_p_sts = p_sts;
       COPY_OPT_SCTX(buf, BV_STS);
       buf->b_p_sts_nopaste = p_sts_nopaste;
-      buf->b_p_vsts = xstrdup(p_vsts);
+      buf->b_p_vsts = copy_option_val(p_vsts);
       COPY_OPT_SCTX(buf, BV_VSTS);
       if (p_vsts && p_vsts != empty_option) {
         (void)tabstop_set(p_vsts, &buf->b_p_vsts_array);
@@ -4356,17 +4354,17 @@ void buf_copy_options(buf_T *buf, int flags)
         buf->b_p_vsts_array = NULL;
       }
       buf->b_p_vsts_nopaste = p_vsts_nopaste ? xstrdup(p_vsts_nopaste) : NULL;
-      buf->b_p_com = xstrdup(p_com);
+      buf->b_p_com = copy_option_val(p_com);
       COPY_OPT_SCTX(buf, BV_COM);
-      buf->b_p_cms = xstrdup(p_cms);
+      buf->b_p_cms = copy_option_val(p_cms);
       COPY_OPT_SCTX(buf, BV_CMS);
-      buf->b_p_fo = xstrdup(p_fo);
+      buf->b_p_fo = copy_option_val(p_fo);
       COPY_OPT_SCTX(buf, BV_FO);
-      buf->b_p_flp = xstrdup(p_flp);
+      buf->b_p_flp = copy_option_val(p_flp);
       COPY_OPT_SCTX(buf, BV_FLP);
-      buf->b_p_nf = xstrdup(p_nf);
+      buf->b_p_nf = copy_option_val(p_nf);
       COPY_OPT_SCTX(buf, BV_NF);
-      buf->b_p_mps = xstrdup(p_mps);
+      buf->b_p_mps = copy_option_val(p_mps);
       COPY_OPT_SCTX(buf, BV_MPS);
       buf->b_p_si = p_si;
       COPY_OPT_SCTX(buf, BV_SI);
@@ -4376,20 +4374,20 @@ void buf_copy_options(buf_T *buf, int flags)
       COPY_OPT_SCTX(buf, BV_CI);
       buf->b_p_cin = p_cin;
       COPY_OPT_SCTX(buf, BV_CIN);
-      buf->b_p_cink = xstrdup(p_cink);
+      buf->b_p_cink = copy_option_val(p_cink);
       COPY_OPT_SCTX(buf, BV_CINK);
-      buf->b_p_cino = xstrdup(p_cino);
+      buf->b_p_cino = copy_option_val(p_cino);
       COPY_OPT_SCTX(buf, BV_CINO);
-      buf->b_p_cinsd = xstrdup(p_cinsd);
+      buf->b_p_cinsd = copy_option_val(p_cinsd);
       COPY_OPT_SCTX(buf, BV_CINSD);
-      buf->b_p_lop = xstrdup(p_lop);
+      buf->b_p_lop = copy_option_val(p_lop);
       COPY_OPT_SCTX(buf, BV_LOP);
 
       // Don't copy 'filetype', it must be detected
       buf->b_p_ft = empty_option;
       buf->b_p_pi = p_pi;
       COPY_OPT_SCTX(buf, BV_PI);
-      buf->b_p_cinw = xstrdup(p_cinw);
+      buf->b_p_cinw = copy_option_val(p_cinw);
       COPY_OPT_SCTX(buf, BV_CINW);
       buf->b_p_lisp = p_lisp;
       COPY_OPT_SCTX(buf, BV_LISP);
@@ -4398,25 +4396,25 @@ void buf_copy_options(buf_T *buf, int flags)
       buf->b_p_smc = p_smc;
       COPY_OPT_SCTX(buf, BV_SMC);
       buf->b_s.b_syn_isk = empty_option;
-      buf->b_s.b_p_spc = xstrdup(p_spc);
+      buf->b_s.b_p_spc = copy_option_val(p_spc);
       COPY_OPT_SCTX(buf, BV_SPC);
       (void)compile_cap_prog(&buf->b_s);
-      buf->b_s.b_p_spf = xstrdup(p_spf);
+      buf->b_s.b_p_spf = copy_option_val(p_spf);
       COPY_OPT_SCTX(buf, BV_SPF);
-      buf->b_s.b_p_spl = xstrdup(p_spl);
+      buf->b_s.b_p_spl = copy_option_val(p_spl);
       COPY_OPT_SCTX(buf, BV_SPL);
-      buf->b_s.b_p_spo = xstrdup(p_spo);
+      buf->b_s.b_p_spo = copy_option_val(p_spo);
       COPY_OPT_SCTX(buf, BV_SPO);
-      buf->b_p_inde = xstrdup(p_inde);
+      buf->b_p_inde = copy_option_val(p_inde);
       COPY_OPT_SCTX(buf, BV_INDE);
-      buf->b_p_indk = xstrdup(p_indk);
+      buf->b_p_indk = copy_option_val(p_indk);
       COPY_OPT_SCTX(buf, BV_INDK);
       buf->b_p_fp = empty_option;
-      buf->b_p_fex = xstrdup(p_fex);
+      buf->b_p_fex = copy_option_val(p_fex);
       COPY_OPT_SCTX(buf, BV_FEX);
-      buf->b_p_sua = xstrdup(p_sua);
+      buf->b_p_sua = copy_option_val(p_sua);
       COPY_OPT_SCTX(buf, BV_SUA);
-      buf->b_p_keymap = xstrdup(p_keymap);
+      buf->b_p_keymap = copy_option_val(p_keymap);
       COPY_OPT_SCTX(buf, BV_KMAP);
       buf->b_kmap_state |= KEYMAP_INIT;
       // This isn't really an option, but copying the langmap and IME
@@ -4443,12 +4441,12 @@ void buf_copy_options(buf_T *buf, int flags)
       buf->b_tc_flags = 0;
       buf->b_p_def = empty_option;
       buf->b_p_inc = empty_option;
-      buf->b_p_inex = xstrdup(p_inex);
+      buf->b_p_inex = copy_option_val(p_inex);
       COPY_OPT_SCTX(buf, BV_INEX);
       buf->b_p_dict = empty_option;
       buf->b_p_tsr = empty_option;
       buf->b_p_tsrfu = empty_option;
-      buf->b_p_qe = xstrdup(p_qe);
+      buf->b_p_qe = copy_option_val(p_qe);
       COPY_OPT_SCTX(buf, BV_QE);
       buf->b_p_udf = p_udf;
       COPY_OPT_SCTX(buf, BV_UDF);
@@ -4467,12 +4465,12 @@ void buf_copy_options(buf_T *buf, int flags)
           buf->b_p_vts_array = NULL;
         }
       } else {
-        buf->b_p_isk = xstrdup(p_isk);
+        buf->b_p_isk = copy_option_val(p_isk);
         COPY_OPT_SCTX(buf, BV_ISK);
         did_isk = true;
         buf->b_p_ts = p_ts;
         COPY_OPT_SCTX(buf, BV_TS);
-        buf->b_p_vts = xstrdup(p_vts);
+        buf->b_p_vts = copy_option_val(p_vts);
         COPY_OPT_SCTX(buf, BV_VTS);
         if (p_vts && p_vts != empty_option && !buf->b_p_vts_array) {
           (void)tabstop_set(p_vts, &buf->b_p_vts_array);
@@ -30,6 +30,7 @@
 #include "nvim/insexpand.h"
 #include "nvim/keycodes.h"
 #include "nvim/macros.h"
+#include "nvim/map.h"
 #include "nvim/mapping.h"
 #include "nvim/mbyte.h"
 #include "nvim/memline.h"
@@ -55,6 +56,17 @@
 #include "nvim/vim.h"
 #include "nvim/window.h"
 
+/// A shared option value.  Window and buffer options that are copied from
+/// another window or from the global value point to "str" of one of these,
+/// so that making a window or buffer doesn't allocate each string again.
+typedef struct {
+  size_t refcount;
+  char str[];
+} OptStr;
+
+/// Shared option values by their text.
+static Map(cstr_t, ptr_t) optstr_table = MAP_INIT;
+
 #ifdef INCLUDE_GENERATED_DECLARATIONS
 # include "optionstr.c.generated.h"
 #endif
@@ -275,19 +287,61 @@ void check_buf_options(buf_T *buf)
 /// Does NOT check for P_ALLOCED flag!
 void free_string_option(char *p)
 {
-  if (p != empty_option) {
+  if (p != empty_option && !optstr_release(p)) {
     xfree(p);
   }
 }
 
 void clear_string_option(char **pp)
 {
-  if (*pp != empty_option) {
-    xfree(*pp);
-  }
+  free_string_option(*pp);
   *pp = empty_option;
 }
 
+/// Get a copy of option value "val" that can be stored in a window or buffer
+/// option.  The copy is shared with other options that have the same value:
+/// it must not be changed and must be freed with free_string_option().
+char *optstr_copy(const char *val)
+  FUNC_ATTR_NONNULL_RET FUNC_ATTR_NONNULL_ALL
+{
+  if (val == empty_option) {
+    return empty_option;  // no need to allocate memory
+  }
+  OptStr *os = map_get(cstr_t, ptr_t)(&optstr_table, val);
+  if (os == NULL) {
+    size_t len = strlen(val);
+    os = xmalloc(offsetof(OptStr, str) + len + 1);
+    os->refcount = 0;
+    memcpy(os->str, val, len + 1);
+    map_put(cstr_t, ptr_t)(&optstr_table, os->str, os);
+  }
+  os->refcount++;
+  return os->str;
+}
+
+/// Drop a reference to "p" if it was returned by optstr_copy().
+///
+/// @return  false if "p" is not a shared value.
+static bool optstr_release(char *p)
+{
+  OptStr *os = map_get(cstr_t, ptr_t)(&optstr_table, p);
+  if (os == NULL || os->str != p) {
+    return false;
+  }
+  if (--os->refcount == 0) {
+    map_del(cstr_t, ptr_t)(&optstr_table, p);
+    xfree(os);
+  }
+  return true;
+}
+
+#if defined(EXITFREE)
+void free_optstr_table(void)
+{
+  map_destroy(cstr_t, ptr_t)(&optstr_table);
+}
+#endif
+
 void check_string_option(char **pp)
 {
   if (*pp == NULL) {
@@ -119,6 +119,8 @@ static void restart_cursorhold_wait(int tb_change_cnt)
 /// until `events` is non-empty.
 int os_inchar(uint8_t *buf, int maxlen, int ms, int tb_change_cnt, MultiQueue *events)
 {
+  PROFILE_SAMPLE_CHECK();
+
   // This check is needed so that feeding typeahead from RPC can prevent CursorHold.
   if (tb_change_cnt != cursorhold_tb_change_cnt) {
     restart_cursorhold_wait(tb_change_cnt);
@@ -202,6 +204,7 @@ bool os_char_avail(void)
 /// available)
 void os_breakcheck(void)
 {
+  PROFILE_SAMPLE_CHECK();
   if (got_int) {
     return;
   }
@@ -219,6 +222,7 @@ static int breakcheck_count = 0;
 /// time, because it will use system calls to check for input.
 void line_breakcheck(void)
 {
+  PROFILE_SAMPLE_CHECK();
   if (++breakcheck_count >= BREAKCHECK_SKIP) {
     breakcheck_count = 0;
     os_breakcheck();
@@ -228,6 +232,7 @@ void line_breakcheck(void)
 /// Like line_breakcheck() but check 10 times less often.
 void fast_breakcheck(void)
 {
+  PROFILE_SAMPLE_CHECK();
   if (++breakcheck_count >= BREAKCHECK_SKIP * 10) {
     breakcheck_count = 0;
     os_breakcheck();
@@ -237,6 +242,7 @@ void fast_breakcheck(void)
 /// Like line_breakcheck() but check 100 times less often.
 void veryfast_breakcheck(void)
 {
+  PROFILE_SAMPLE_CHECK();
   if (++breakcheck_count >= BREAKCHECK_SKIP * 100) {
     breakcheck_count = 0;
     os_breakcheck();
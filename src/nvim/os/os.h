@@ -17,6 +17,7 @@
 #endif
 
 #define ENV_LOGFILE "NVIM_LOG_FILE"
+#define ENV_LOGLEVEL "NVIM_LOG_LEVEL"
 #define ENV_NVIM "NVIM"
 
 #endif  // NVIM_OS_OS_H
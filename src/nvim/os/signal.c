@@ -12,10 +12,13 @@
 #include "nvim/buffer_defs.h"
 #include "nvim/eval.h"
 #include "nvim/event/signal.h"
+#include "nvim/event/stats.h"
 #include "nvim/globals.h"
 #include "nvim/log.h"
 #include "nvim/main.h"
 #include "nvim/memline.h"
+#include "nvim/memory.h"
+#include "nvim/os/os.h"
 #include "nvim/os/signal.h"
 
 static SignalWatcher spipe, shup, squit, sterm, susr1, swinch;
@@ -179,6 +182,18 @@ static void deadly_signal(int signum)
   preserve_exit();
 }
 
+/// Appends the event loop statistics to "$XDG_STATE_HOME/nvim/event_stats.log".
+static void dump_event_stats(void)
+{
+  char *fname = stdpaths_user_state_subpath("event_stats.log", 0, false);
+  if (event_stats_dump(fname, 20)) {
+    ILOG("event loop statistics written to %s", fname);
+  } else {
+    WLOG("failed to write event loop statistics to %s", fname);
+  }
+  xfree(fname);
+}
+
 static void on_signal(SignalWatcher *handle, int signum, void *data)
 {
   assert(signum >= 0);
@@ -206,6 +221,7 @@ static void on_signal(SignalWatcher *handle, int signum, void *data)
     break;
 #ifdef SIGUSR1
   case SIGUSR1:
+    dump_event_stats();
     apply_autocmds(EVENT_SIGNAL, "SIGUSR1", curbuf->b_fname, true, curbuf);
     break;
 #endif
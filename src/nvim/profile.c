@@ -3,11 +3,16 @@
 
 #include <assert.h>
 #include <math.h>
+#include <signal.h>
 #include <stdbool.h>
 #include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <uv.h>
+#ifndef MSWIN
+# include <sys/time.h>
+#endif
 
 #include "nvim/ascii.h"
 #include "nvim/charset.h"
@@ -22,6 +27,8 @@
 #include "nvim/globals.h"
 #include "nvim/hashtab.h"
 #include "nvim/keycodes.h"
+#include "nvim/lua/executor.h"
+#include "nvim/map.h"
 #include "nvim/memory.h"
 #include "nvim/message.h"
 #include "nvim/option_defs.h"
@@ -30,9 +37,22 @@
 #include "nvim/pos.h"
 #include "nvim/profile.h"
 #include "nvim/runtime.h"
+#include "nvim/strings.h"
 #include "nvim/types.h"
 #include "nvim/vim.h"
 
+/// State of ":profile sample".
+static struct {
+  bool active;
+  char *fname;
+  Map(cstr_t, int) stacks;  ///< number of samples of each folded stack
+  const char *subsystem;  ///< see profile_sample_enter()
+  uv_thread_t main_thread;
+#ifndef MSWIN
+  struct sigaction old_action;
+#endif
+} sample;
+
 #ifdef INCLUDE_GENERATED_DECLARATIONS
 # include "profile.c.generated.h"
 #endif
@@ -297,7 +317,9 @@ void ex_profile(exarg_T *eap)
   len = (int)(e - eap->arg);
   e = skipwhite(e);
 
-  if (len == 5 && strncmp(eap->arg, "start", 5) == 0 && *e != NUL) {
+  if (len == 6 && strncmp(eap->arg, "sample", 6) == 0) {
+    profile_sample_cmd(e);
+  } else if (len == 5 && strncmp(eap->arg, "start", 5) == 0 && *e != NUL) {
     xfree(profile_fname);
     profile_fname = (char *)expand_env_save_opt((char_u *)e, true);
     do_profiling = PROF_YES;
@@ -341,6 +363,7 @@ static char *pexpand_cmds[] = {
   "file",
   "func",
   "pause",
+  "sample",
   "start",
   "stop",
   NULL
@@ -965,3 +988,192 @@ void time_msg(const char *mesg, const proftime_T *start)
   g_prev_time = now;
   fprintf(time_fd, ": %s\n", mesg);
 }
+
+/// ":profile sample start {fname}" and ":profile sample stop".
+static void profile_sample_cmd(char *arg)
+{
+  char *e = skiptowhite(arg);
+  size_t len = (size_t)(e - arg);
+  e = skipwhite(e);
+
+  if (len == 5 && strncmp(arg, "start", 5) == 0 && *e != NUL) {
+    if (sample.active) {
+      profile_sample_stop();
+    }
+    profile_sample_start((char *)expand_env_save_opt((char_u *)e, true));
+  } else if (len == 4 && strncmp(arg, "stop", 4) == 0) {
+    if (!sample.active) {
+      emsg(_("E5710: First use \":profile sample start {fname}\""));
+      return;
+    }
+    profile_sample_stop();
+  } else {
+    semsg(_(e_invarg2), arg);
+  }
+}
+
+/// Starts sampling. Every millisecond of CPU time a sample of the Vimscript
+/// and Lua stacks is taken.
+///
+/// The timer signal only sets profile_sample_pending and arms a Lua hook, the
+/// sample is taken by profile_sample_take() at the next point where this is
+/// safe: in the Lua hook, before an Ex command, in line_breakcheck() and
+/// friends, or when leaving a subsystem (see profile_sample_enter()).
+///
+/// @param fname  File to write the samples to, taken over.
+static void profile_sample_start(char *fname)
+{
+#ifdef MSWIN
+  xfree(fname);
+  emsg(_("E5711: Sampling is not supported on this system"));
+#else
+  map_init(cstr_t, int, &sample.stacks);
+  sample.fname = fname;
+  sample.main_thread = uv_thread_self();
+  sample.active = true;
+  profile_sample_pending = 0;
+
+  struct sigaction action = { .sa_handler = profile_sample_signal, .sa_flags = SA_RESTART };
+  sigemptyset(&action.sa_mask);
+  sigaction(SIGPROF, &action, &sample.old_action);
+  struct itimerval timer = { .it_interval = { 0, 1000 }, .it_value = { 0, 1000 } };
+  setitimer(ITIMER_PROF, &timer, NULL);
+#endif
+}
+
+#ifndef MSWIN
+static void profile_sample_signal(int signum)
+{
+  // The process CPU time timer can fire in any thread. Samples that are due
+  // while another thread runs, like the thread pool, are dropped: there is
+  // nothing to attribute them to and counting them would race.
+  uv_thread_t self = uv_thread_self();
+  if (!uv_thread_equal(&self, &sample.main_thread)) {
+    return;
+  }
+  profile_sample_pending = 1;
+  nlua_sample_arm();
+}
+#endif
+
+/// Stops sampling and writes the samples to the file in the "folded stacks"
+/// format of flamegraph.pl: a line for each stack, with the frames from the
+/// outermost one separated by ";" and the number of samples.
+void profile_sample_stop(void)
+{
+  if (!sample.active) {
+    return;
+  }
+#ifndef MSWIN
+  struct itimerval timer = { 0 };
+  setitimer(ITIMER_PROF, &timer, NULL);
+  sigaction(SIGPROF, &sample.old_action, NULL);
+#endif
+  sample.active = false;
+  profile_sample_pending = 0;
+  nlua_sample_disarm();
+
+  FILE *fd = os_fopen(sample.fname, "w");
+  if (fd == NULL) {
+    semsg(_(e_notopen), sample.fname);
+  }
+  const char *stack;
+  int count;
+  map_foreach(&sample.stacks, stack, count, {
+    if (fd != NULL) {
+      fprintf(fd, "%s %d\n", stack, count);
+    }
+    xfree((char *)stack);
+  });
+  if (fd != NULL) {
+    fclose(fd);
+  }
+  map_destroy(cstr_t, int)(&sample.stacks);
+  XFREE_CLEAR(sample.fname);
+}
+
+/// Adds a frame to a folded stack.
+void profile_sample_add_frame(StringBuilder *stack, const char *name, size_t len)
+{
+  if (kv_size(*stack) > 0) {
+    kv_push(*stack, ';');
+  }
+  for (size_t i = 0; i < len; i++) {
+    // ";" separates frames, the last space separates the count.
+    char c = name[i];
+    kv_push(*stack, (c == ';' || c == '\n') ? '_' : c);
+  }
+}
+
+/// Takes the sample that profile_sample_pending asks for.
+///
+/// @param from_lua  Called from the Lua hook: Lua code is running, so the Lua
+///                  frames are the innermost ones. Otherwise the Vimscript
+///                  frames are.
+void profile_sample_take(bool from_lua)
+{
+  profile_sample_pending = 0;
+  if (!sample.active) {
+    return;
+  }
+  if (!from_lua) {
+    nlua_sample_disarm();
+  }
+
+  StringBuilder stack = KV_INITIAL_VALUE;
+  if (from_lua) {
+    profile_sample_add_estack(&stack);
+    nlua_sample_stack(&stack);
+  } else {
+    nlua_sample_stack(&stack);
+    profile_sample_add_estack(&stack);
+  }
+  if (sample.subsystem != NULL) {
+    profile_sample_add_frame(&stack, sample.subsystem, strlen(sample.subsystem));
+  }
+  if (kv_size(stack) == 0) {
+    profile_sample_add_frame(&stack, S_LEN("nvim"));
+  }
+  kv_push(stack, NUL);
+
+  int *count = map_ref(cstr_t, int)(&sample.stacks, stack.items, false);
+  if (count != NULL) {
+    (*count)++;
+    kv_destroy(stack);
+  } else {
+    map_put(cstr_t, int)(&sample.stacks, stack.items, 1);
+  }
+}
+
+static void profile_sample_add_estack(StringBuilder *stack)
+{
+  for (int i = 0; i < exestack.ga_len; i++) {
+    estack_T *entry = ((estack_T *)exestack.ga_data) + i;
+    if (entry->es_type == ETYPE_TOP || entry->es_name == NULL) {
+      continue;
+    }
+    profile_sample_add_frame(stack, entry->es_name, strlen(entry->es_name));
+    if (entry->es_type == ETYPE_UFUNC) {
+      kv_concat_len(*stack, "()", 2);
+    }
+  }
+}
+
+/// Marks the start of a part of Nvim that is shown as a frame of its own in
+/// ":profile sample" stacks, like "redraw".
+///
+/// @return  Value to pass to profile_sample_leave().
+const char *profile_sample_enter(const char *subsystem)
+{
+  const char *prev = sample.subsystem;
+  sample.subsystem = subsystem;
+  return prev;
+}
+
+/// Marks the end of a part started by profile_sample_enter(). A sample that
+/// is still pending is taken here, so it is counted for this part.
+void profile_sample_leave(const char *prev)
+{
+  PROFILE_SAMPLE_CHECK();
+  sample.subsystem = prev;
+}
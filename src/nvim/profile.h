@@ -1,16 +1,29 @@
 #ifndef NVIM_PROFILE_H
 #define NVIM_PROFILE_H
 
+#include <signal.h>
+#include <stdbool.h>
 #include <stdint.h>
 #include <time.h>
 
 #include "nvim/ex_cmds_defs.h"
+#include "nvim/macros.h"
 #include "nvim/runtime.h"
+#include "nvim/strings.h"
 
 #define TIME_MSG(s) do { \
   if (time_fd != NULL) time_msg(s, NULL); \
 } while (0)
 
+/// Set by the timer of ":profile sample" when a sample is due.
+EXTERN volatile sig_atomic_t profile_sample_pending INIT(= 0);
+
+/// Takes a pending ":profile sample" sample. Used where it is safe to look at
+/// the Vimscript and Lua stacks.
+#define PROFILE_SAMPLE_CHECK() do { \
+  if (profile_sample_pending) profile_sample_take(false); \
+} while (0)
+
 #ifdef INCLUDE_GENERATED_DECLARATIONS
 # include "profile.h.generated.h"
 #endif
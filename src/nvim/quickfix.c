@@ -12,6 +12,7 @@
 #include <stdlib.h>
 #include <string.h>
 #include <time.h>
+#include <uv.h>
 
 #include "nvim/arglist.h"
 #include "nvim/ascii.h"
@@ -21,6 +22,7 @@
 #include "nvim/cursor.h"
 #include "nvim/drawscreen.h"
 #include "nvim/edit.h"
+#include "nvim/event/pool.h"
 #include "nvim/eval.h"
 #include "nvim/eval/typval.h"
 #include "nvim/eval/typval_defs.h"
@@ -39,6 +41,7 @@
 #include "nvim/highlight_defs.h"
 #include "nvim/highlight_group.h"
 #include "nvim/macros.h"
+#include "nvim/map.h"
 #include "nvim/mark.h"
 #include "nvim/mbyte.h"
 #include "nvim/memfile_defs.h"
@@ -49,6 +52,7 @@
 #include "nvim/normal.h"
 #include "nvim/option.h"
 #include "nvim/optionstr.h"
+#include "nvim/os/fileio.h"
 #include "nvim/os/fs_defs.h"
 #include "nvim/os/input.h"
 #include "nvim/os/os.h"
@@ -176,6 +180,10 @@ struct efm_S {
                               // '-' do not include this line
                               // '+' include whole line in message
   int conthere;                 // %> used
+  char *literal;              // lower-cased text every matching line
+                              // contains, or NULL
+  size_t literal_len;
+  bool literal_at_start;      // matching lines start with "literal"
 };
 
 /// List of location lists to be deleted.
@@ -227,8 +235,21 @@ typedef struct {
   int enr;
   char type;
   bool valid;
+  bool ascii;  ///< the line only contains ASCII characters
 } qffields_T;
 
+/// Remembers the longest run of literal characters found by efm_to_regpat()
+/// so far, it is used to skip the regexp for lines that cannot match.
+typedef struct {
+  const char *start;  ///< start of the current run in the 'errorformat' part
+  size_t len;         ///< length of the current run
+  bool at_start;      ///< the current run starts the pattern
+  const char *best;
+  size_t best_len;
+  bool best_at_start;
+  bool disabled;      ///< pattern syntax that makes runs unreliable
+} efm_literal_T;
+
 /// :vimgrep command arguments
 typedef struct vgr_args_S {
   long tomatch;          ///< maximum number of matches to find
@@ -240,6 +261,39 @@ typedef struct vgr_args_S {
   char *qf_title;      ///< quickfix list title
 } vgr_args_T;
 
+/// State of a file in a vgr_reader_T.
+typedef enum {
+  kVgrFilePending,   ///< not read yet
+  kVgrFileReading,   ///< being read
+  kVgrFileDone,      ///< read, "text" is set if it can be searched directly
+  kVgrFileSkipped,   ///< not needed anymore
+} VgrFileState;
+
+typedef struct {
+  char *fname;    ///< full file name
+  char *text;     ///< NUL-terminated file contents or NULL
+  size_t size;
+  VgrFileState state;
+} vgr_file_T;
+
+/// Reads the files for :vimgrep ahead on the thread pool, so that searching
+/// a file that is not loaded does not wait for the disk.
+/// Shared by vgr_process_files() and the read tasks, the last one to drop
+/// its reference frees it.
+typedef struct {
+  uv_mutex_t mutex;
+  uv_cond_t cond;    ///< signaled when a file is done
+  vgr_file_T *files;
+  int count;
+  int submitted;     ///< files before this index were given to the pool
+  int refcount;
+} vgr_reader_T;
+
+typedef struct {
+  vgr_reader_T *reader;
+  int idx;
+} vgr_read_task_T;
+
 #ifdef INCLUDE_GENERATED_DECLARATIONS
 # include "quickfix.c.generated.h"
 #endif
@@ -270,10 +324,15 @@ static char *e_no_more_items = N_("E553: No more items");
        !got_int && (i) <= (qfl)->qf_count && (qfp) != NULL; \
        (i)++, (qfp) = (qfp)->qf_next)
 
-// Looking up a buffer can be slow if there are many.  Remember the last one
-// to make this a lot faster if there are multiple matches in the same file.
-static char *qf_last_bufname = NULL;
-static bufref_T qf_last_bufref = { NULL, 0, 0 };
+// Looking up a buffer can be slow if there are many.  Remember the buffer
+// number for each file name, so that it is only done once per file.  Only
+// valid while one list is created or added to: the cache is emptied when
+// starting, since buffers may have been renamed or the current directory
+// changed since the last time.
+static Map(cstr_t, int) qf_fnum_cache = MAP_INIT;
+
+// Limit for the size of "qf_fnum_cache", it is emptied when it gets larger.
+#define QF_FNUM_CACHE_MAX 4096
 
 static char *e_current_quickfix_list_was_changed =
   N_("E925: Current quickfix list was changed");
@@ -481,6 +540,31 @@ static const char *efm_analyze_prefix(const char *efmp, efm_T *efminfo)
   return efmp;
 }
 
+static void efm_literal_end(efm_literal_T *lit)
+{
+  if (lit->len > lit->best_len) {
+    lit->best = lit->start;
+    lit->best_len = lit->len;
+    lit->best_at_start = lit->at_start;
+  }
+  lit->len = 0;
+}
+
+/// Adds a character that the regexp matches literally (ignoring case).
+static void efm_literal_add(efm_literal_T *lit, const char *p, bool pattern_start)
+{
+  if ((uint8_t)(*p) >= 0x80) {
+    // Ignoring case works on characters, not bytes.
+    efm_literal_end(lit);
+    return;
+  }
+  if (lit->len == 0) {
+    lit->start = p;
+    lit->at_start = pattern_start;
+  }
+  lit->len++;
+}
+
 // Converts a 'errorformat' string to regular expression pattern
 static int efm_to_regpat(const char *efm, int len, efm_T *fmt_ptr, char *regpat)
   FUNC_ATTR_NONNULL_ALL
@@ -489,9 +573,20 @@ static int efm_to_regpat(const char *efm, int len, efm_T *fmt_ptr, char *regpat)
   char *ptr = regpat;
   *ptr++ = '^';
   int round = 0;
+  efm_literal_T lit = { 0 };
   for (const char *efmp = efm; efmp < efm + len; efmp++) {
     if (*efmp == '%') {
       efmp++;
+      if (*efmp == '#' && lit.len > 0) {
+        lit.len--;  // the previous character is optional
+      }
+      if (*efmp == '\\' || *efmp == '[' || *efmp == '~') {
+        // Can start an alternative, a collection or insert a string.
+        lit.disabled = true;
+      }
+      if (*efmp != '>') {
+        efm_literal_end(&lit);
+      }
       int idx;
       for (idx = 0; idx < FMT_PATTERNS; idx++) {
         if (fmt_pat[idx].convchar == *efmp) {
@@ -528,10 +623,17 @@ static int efm_to_regpat(const char *efm, int len, efm_T *fmt_ptr, char *regpat)
         return FAIL;
       }
     } else {                    // copy normal character
-      if (*efmp == '\\' && efmp + 1 < efm + len) {
-        efmp++;
-      } else if (vim_strchr(".*^$~[", *efmp) != NULL) {
-        *ptr++ = '\\';  // escape regexp atoms
+      if (*efmp == '\\') {
+        // The next character is copied as-is and may be a regexp atom.
+        lit.disabled = true;
+        if (efmp + 1 < efm + len) {
+          efmp++;
+        }
+      } else {
+        if (vim_strchr(".*^$~[", *efmp) != NULL) {
+          *ptr++ = '\\';  // escape regexp atoms
+        }
+        efm_literal_add(&lit, efmp, ptr == regpat + 1);
       }
       if (*efmp) {
         *ptr++ = *efmp;
@@ -541,9 +643,44 @@ static int efm_to_regpat(const char *efm, int len, efm_T *fmt_ptr, char *regpat)
   *ptr++ = '$';
   *ptr = NUL;
 
+  efm_literal_end(&lit);
+  if (!lit.disabled && lit.best_len > 0) {
+    fmt_ptr->literal = xmemdupz(lit.best, lit.best_len);
+    for (size_t i = 0; i < lit.best_len; i++) {
+      fmt_ptr->literal[i] = (char)TOLOWER_ASC(fmt_ptr->literal[i]);
+    }
+    fmt_ptr->literal_len = lit.best_len;
+    fmt_ptr->literal_at_start = lit.best_at_start;
+  }
+
   return OK;
 }
 
+/// Checks whether "linebuf" may match the 'errorformat' part "fmt_ptr": it must
+/// contain the literal text of the part. Case is ignored like when matching.
+///
+/// @param ascii  "linebuf" only contains ASCII characters.
+static bool efm_may_match(const efm_T *fmt_ptr, const char *linebuf, size_t linelen, bool ascii)
+{
+  if (fmt_ptr->literal == NULL || !ascii) {
+    return true;
+  }
+  const size_t n = fmt_ptr->literal_len;
+  if (n > linelen) {
+    return false;
+  }
+  if (fmt_ptr->literal_at_start) {
+    return STRNICMP(linebuf, fmt_ptr->literal, n) == 0;
+  }
+  const char c = fmt_ptr->literal[0];
+  for (size_t i = 0; i + n <= linelen; i++) {
+    if (TOLOWER_ASC(linebuf[i]) == c && STRNICMP(linebuf + i, fmt_ptr->literal, n) == 0) {
+      return true;
+    }
+  }
+  return false;
+}
+
 static efm_T *fmt_start = NULL;  // cached across qf_parse_line() calls
 
 // callback function for 'quickfixtextfunc'
@@ -554,6 +691,7 @@ static void free_efm_list(efm_T **efm_first)
   for (efm_T *efm_ptr = *efm_first; efm_ptr != NULL; efm_ptr = *efm_first) {
     *efm_first = efm_ptr->next;
     vim_regfree(efm_ptr->prog);
+    xfree(efm_ptr->literal);
     xfree(efm_ptr);
   }
 
@@ -911,6 +1049,14 @@ static int qf_parse_line(qf_list_T *qfl, char *linebuf, size_t linelen, efm_T *f
   char *tail = NULL;
   int status;
 
+  fields->ascii = true;
+  for (size_t i = 0; i < linelen; i++) {
+    if ((uint8_t)linebuf[i] >= 0x80) {
+      fields->ascii = false;
+      break;
+    }
+  }
+
 restofline:
   // If there was no %> item start at the first pattern
   if (fmt_start == NULL) {
@@ -1079,8 +1225,9 @@ static int qf_init_ext(qf_info_T *qi, int qf_idx, const char *restrict efile, bu
   static char *last_efm = NULL;
   int retval = -1;                      // default: return error flag
 
-  // Do not used the cached buffer, it may have been wiped out.
-  XFREE_CLEAR(qf_last_bufname);
+  // Do not use the cached buffers, they may have been renamed or wiped out,
+  // or the current directory changed.
+  qf_fnum_cache_clear(false);
 
   qf_alloc_fields(&fields);
   if (qf_setup_state(&state, enc, efile, tv, buf, lnumfirst, lnumlast) == FAIL) {
@@ -1224,6 +1371,8 @@ static qf_list_T *qf_get_curlist(qf_info_T *qi)
 /// the new list is added.
 static void qf_new_list(qf_info_T *qi, const char *qf_title)
 {
+  qf_fnum_cache_clear(false);
+
   // If the current entry is not the last entry, delete entries beyond
   // the current entry.  This makes it possible to browse in a tree-like
   // way with ":grep".
@@ -1543,6 +1692,10 @@ static int qf_parse_get_fields(char *linebuf, size_t linelen, efm_T *fmt_ptr, qf
   fields->type = 0;
   *tail = NULL;
 
+  if (!efm_may_match(fmt_ptr, linebuf, linelen, fields->ascii)) {
+    return QF_FAIL;
+  }
+
   regmatch_T regmatch;
   // Always ignore case when looking for a matching error.
   regmatch.rm_ic = true;
@@ -1737,6 +1890,7 @@ void qf_free_all(win_T *wp)
     for (int i = 0; i < qi->qf_listcount; i++) {
       qf_free(qf_get_list(qi, i));
     }
+    qf_fnum_cache_clear(true);
   }
 }
 
@@ -2058,6 +2212,25 @@ void copy_loclist_stack(win_T *from, win_T *to)
   to->w_llist->qf_curlist = qi->qf_curlist;  // current list
 }
 
+/// Empty the cache used by qf_get_fnum().
+///
+/// @param destroy  also free the memory of the table
+static void qf_fnum_cache_clear(bool destroy)
+{
+  const char *name;
+  int fnum;
+  map_foreach(&qf_fnum_cache, name, fnum, {
+    (void)fnum;
+    xfree((char *)name);
+  });
+  if (destroy) {
+    map_destroy(cstr_t, int)(&qf_fnum_cache);
+    map_init(cstr_t, int, &qf_fnum_cache);
+  } else {
+    map_clear(cstr_t, int)(&qf_fnum_cache);
+  }
+}
+
 /// Get buffer number for file "directory/fname".
 /// Also sets the b_has_qf_entry flag.
 static int qf_get_fnum(qf_list_T *qfl, char *directory, char *fname)
@@ -2096,16 +2269,24 @@ static int qf_get_fnum(qf_list_T *qfl, char *directory, char *fname)
     bufname = fname;
   }
 
-  if (qf_last_bufname != NULL
-      && strcmp(bufname, qf_last_bufname) == 0
-      && bufref_valid(&qf_last_bufref)) {
-    buf = qf_last_bufref.br_buf;
+  int fnum = map_get(cstr_t, int)(&qf_fnum_cache, bufname);
+  buf = fnum != 0 ? buflist_findnr(fnum) : NULL;
+  if (buf != NULL) {
     xfree(ptr);
   } else {
-    xfree(qf_last_bufname);
     buf = buflist_new(bufname, NULL, (linenr_T)0, BLN_NOOPT);
-    qf_last_bufname = (bufname == ptr) ? bufname : xstrdup(bufname);
-    set_bufref(&qf_last_bufref, buf);
+    if (buf != NULL && fnum != 0) {
+      // The cached buffer was wiped out, the key is already stored.
+      map_put(cstr_t, int)(&qf_fnum_cache, bufname, buf->b_fnum);
+    } else if (buf != NULL) {
+      if (map_size(&qf_fnum_cache) >= QF_FNUM_CACHE_MAX) {
+        qf_fnum_cache_clear(false);
+      }
+      map_put(cstr_t, int)(&qf_fnum_cache, (bufname == ptr) ? ptr : xstrdup(bufname),
+                           buf->b_fnum);
+      ptr = NULL;
+    }
+    xfree(ptr);
   }
   if (buf == NULL) {
     return 0;
@@ -5118,7 +5299,7 @@ static void vgr_init_regmatch(regmmatch_T *regmatch, char *s)
 static void vgr_display_fname(char *fname)
 {
   msg_start();
-  char *p = msg_strtrunc(fname, true);
+  char *p = msg_strtrunc(NULL, fname, true);
   if (p == NULL) {
     msg_outtrans(fname);
   } else {
@@ -5224,27 +5405,114 @@ static bool vgr_match_buflines(qf_list_T *qfl, char *fname, buf_T *buf, char *sp
         }
       }
     } else {
-      char *const str = ml_get_buf(buf, lnum, false);
-      int score;
-      uint32_t matches[MAX_FUZZY_MATCHES];
-      const size_t sz = sizeof(matches) / sizeof(matches[0]);
-
-      // Fuzzy string match
-      while (fuzzy_match((char_u *)str + col, (char_u *)spat, false, &score, matches,
-                         (int)sz) > 0) {
-        // Pass the buffer number so that it gets used even for a
-        // dummy buffer, unless duplicate_name is set, then the
-        // buffer will be wiped out below.
+      // Pass the buffer number so that it gets used even for a
+      // dummy buffer, unless duplicate_name is set, then the
+      // buffer will be wiped out below.
+      if (vgr_match_fuzzy_line(qfl, fname, duplicate_name ? 0 : buf->b_fnum,
+                               ml_get_buf(buf, lnum, false), lnum, spat, pat_len,
+                               tomatch, flags)) {
+        found_match = true;
+      }
+    }
+    line_breakcheck();
+    if (got_int) {
+      break;
+    }
+  }
+
+  return found_match;
+}
+
+/// Search for fuzzy pattern "spat" in line "str" and add the matches to a
+/// quickfix list.
+///
+/// @return  true if there was a match.
+static bool vgr_match_fuzzy_line(qf_list_T *qfl, char *fname, int bufnr, char *str,
+                                 linenr_T lnum, char *spat, size_t pat_len, long *tomatch,
+                                 int flags)
+{
+  bool found_match = false;
+  colnr_T col = 0;
+  int score;
+  uint32_t matches[MAX_FUZZY_MATCHES];
+  const size_t sz = sizeof(matches) / sizeof(matches[0]);
+
+  // Fuzzy string match
+  while (fuzzy_match((char_u *)str + col, (char_u *)spat, false, &score, matches,
+                     (int)sz) > 0) {
+    if (qf_add_entry(qfl,
+                     NULL,   // dir
+                     fname,
+                     NULL,
+                     bufnr,
+                     str,
+                     lnum,
+                     0,
+                     (colnr_T)matches[0] + col + 1,
+                     0,
+                     false,  // vis_col
+                     NULL,   // search pattern
+                     0,      // nr
+                     0,      // type
+                     true)   // valid
+        == QF_FAIL) {
+      got_int = true;
+      break;
+    }
+    found_match = true;
+    if (--*tomatch == 0) {
+      break;
+    }
+    if ((flags & VGR_GLOBAL) == 0) {
+      break;
+    }
+    col = (colnr_T)matches[pat_len - 1] + col + 1;
+    if (col > (colnr_T)strlen(str)) {
+      break;
+    }
+  }
+
+  return found_match;
+}
+
+/// Like vgr_match_buflines(), but search file contents "text" that were not
+/// loaded into a buffer. The lines of "text" are NUL-terminated in place.
+///
+/// Only used when loading the file would give the same lines: see
+/// vgr_can_read_directly() and vgr_read_file().
+static bool vgr_match_text(qf_list_T *qfl, char *fname, char *text, size_t size, char *spat,
+                           regmmatch_T *regmatch, long *tomatch, int flags)
+  FUNC_ATTR_NONNULL_ALL
+{
+  bool found_match = false;
+  const size_t pat_len = strlen(spat);
+  char *const end = text + size;
+  regmatch_T rm = { .regprog = regmatch->regprog, .rm_ic = regmatch->rmm_ic };
+
+  char *line = text;
+  for (linenr_T lnum = 1; *tomatch > 0; lnum++) {
+    char *eol = memchr(line, NL, (size_t)(end - line));
+    if (eol != NULL) {
+      *eol = NUL;
+    } else if (line == end && lnum > 1) {
+      break;  // the last line ended in a NL
+    }
+
+    if (!(flags & VGR_FUZZY)) {
+      // Regular expression match
+      colnr_T col = 0;
+      while (rm.regprog != NULL && vim_regexec(&rm, line, col)) {
+        const colnr_T endcol = (colnr_T)(rm.endp[0] - line);
         if (qf_add_entry(qfl,
                          NULL,   // dir
                          fname,
                          NULL,
-                         duplicate_name ? 0 : buf->b_fnum,
-                         str,
-                         lnum,
-                         0,
-                         (colnr_T)matches[0] + col + 1,
                          0,
+                         line,
+                         lnum,
+                         lnum,
+                         (colnr_T)(rm.startp[0] - line) + 1,
+                         endcol + 1,
                          false,  // vis_col
                          NULL,   // search pattern
                          0,      // nr
@@ -5261,21 +5529,259 @@ static bool vgr_match_buflines(qf_list_T *qfl, char *fname, buf_T *buf, char *sp
         if ((flags & VGR_GLOBAL) == 0) {
           break;
         }
-        col = (colnr_T)matches[pat_len - 1] + col + 1;
-        if (col > (colnr_T)strlen(str)) {
+        col = endcol + (col == endcol);
+        if (col > (colnr_T)strlen(line)) {
           break;
         }
       }
+    } else if (vgr_match_fuzzy_line(qfl, fname, 0, line, lnum, spat, pat_len, tomatch, flags)) {
+      found_match = true;
     }
     line_breakcheck();
-    if (got_int) {
+    if (got_int || eol == NULL) {
       break;
     }
+    line = eol + 1;
   }
+  regmatch->regprog = rm.regprog;
 
   return found_match;
 }
 
+/// Check whether the files for :vimgrep with pattern "spat" can be searched
+/// without loading them into a buffer, if their contents allow for it.
+/// Loading must not change the text: no 'fileencodings' that could convert
+/// UTF-8 text, no 'fileformats' that split lines at a CR, and the pattern
+/// must only look at one line and not depend on the buffer or window.
+static bool vgr_can_read_directly(const char *spat, regprog_T *prog, int flags)
+{
+  if (!(flags & VGR_FUZZY)) {
+    if (re_multiline(prog)) {
+      return false;
+    }
+    // "\%23l", "\%V", "\%#", marks, etc. need a buffer.
+    for (const char *p = strchr(spat, '%'); p != NULL; p = strchr(p + 1, '%')) {
+      if (p[1] == NUL || vim_strchr("([dxouUC", (uint8_t)p[1]) == NULL) {
+        return false;
+      }
+    }
+    // Words are matched with 'iskeyword' of the current buffer, but a dummy
+    // buffer uses the global value.
+    if (strcmp(curbuf->b_p_isk, p_isk) != 0) {
+      return false;
+    }
+  }
+  if (p_acd) {
+    return false;
+  }
+  if (*p_ffs == NUL
+      ? *p_ff == 'm'
+      : strstr(p_ffs, "unix") == NULL && strstr(p_ffs, "dos") == NULL) {
+    return false;
+  }
+  // The first encoding tried for a file without a BOM must be UTF-8.
+  char buf[NUMBUFLEN];
+  for (char *p = p_fencs; *p != NUL;) {
+    (void)copy_option_part(&p, buf, sizeof(buf), ",");
+    if (strcmp(buf, "ucs-bom") != 0) {
+      return strcmp(buf, "utf-8") == 0 || strcmp(buf, "utf8") == 0;
+    }
+  }
+  return *p_fencs == NUL;
+}
+
+/// Check whether loading "fname" into a buffer triggers autocommands.
+/// Filetype detection is ignored, it only sets an option in the buffer.
+static bool vgr_has_read_autocmds(char *fname)
+{
+  const int ftdetect = augroup_find("filetypedetect");
+  static const event_T events[] = {
+    EVENT_BUFNEW, EVENT_BUFREADCMD, EVENT_BUFREADPRE, EVENT_BUFREADPOST, EVENT_SWAPEXISTS,
+    EVENT_BUFUNLOAD, EVENT_BUFHIDDEN, EVENT_BUFDELETE, EVENT_BUFWIPEOUT,
+  };
+  for (size_t i = 0; i < ARRAY_SIZE(events); i++) {
+    if (has_event(events[i]) && has_autocmd_except(events[i], fname, NULL, ftdetect)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+// Files larger than this are always loaded into a buffer.
+#define VGR_READ_MAX_SIZE (16 * 1024 * 1024)
+// Number of files read ahead per pool worker.
+#define VGR_READ_AHEAD 4
+
+/// Read file "fname" for vgr_match_text(). Can be called on any thread.
+///
+/// @return  NUL-terminated contents, NULL when the file can't be read or
+///          loading it into a buffer could change the text: it has a BOM,
+///          NUL or CR characters or is not valid UTF-8.
+static char *vgr_read_file(const char *fname, size_t *sizep)
+  FUNC_ATTR_NONNULL_ALL
+{
+  FileDescriptor fp;
+  if (file_open(&fp, fname, kFileReadOnly, 0) != 0) {
+    return NULL;
+  }
+  size_t cap = 64 * 1024;
+  size_t size = 0;
+  char *text = xmalloc(cap + 1);
+  while (true) {
+    if (size == cap) {
+      if (cap >= VGR_READ_MAX_SIZE) {
+        goto fail;
+      }
+      cap *= 2;
+      text = xrealloc(text, cap + 1);
+    }
+    const ptrdiff_t n = file_read(&fp, text + size, cap - size);
+    if (n < 0) {
+      goto fail;
+    }
+    size += (size_t)n;
+    if (size < cap) {
+      break;  // end of file
+    }
+  }
+  (void)file_close(&fp, false);
+
+  if ((size >= 3 && memcmp(text, "\xef\xbb\xbf", 3) == 0)
+      || memchr(text, NUL, size) != NULL
+      || memchr(text, CAR, size) != NULL
+      || !utf_valid_string((char_u *)text, (char_u *)text + size)) {
+    xfree(text);
+    return NULL;
+  }
+  text[size] = NUL;
+  *sizep = size;
+  return text;
+
+fail:
+  (void)file_close(&fp, false);
+  xfree(text);
+  return NULL;
+}
+
+static vgr_reader_T *vgr_reader_new(int count)
+{
+  vgr_reader_T *reader = xcalloc(1, sizeof(*reader));
+  uv_mutex_init(&reader->mutex);
+  uv_cond_init(&reader->cond);
+  reader->files = xcalloc((size_t)count, sizeof(*reader->files));
+  reader->count = count;
+  reader->refcount = 1;
+  return reader;
+}
+
+/// Start reading the files "fnames" before index "upto".
+static void vgr_reader_fill(vgr_reader_T *reader, char **fnames, int upto)
+{
+  upto = MIN(upto, reader->count);
+  for (; reader->submitted < upto; reader->submitted++) {
+    // Workers can't use relative names, autocommands may change directory.
+    reader->files[reader->submitted].fname = FullName_save(fnames[reader->submitted], true);
+    uv_mutex_lock(&reader->mutex);
+    reader->refcount++;
+    uv_mutex_unlock(&reader->mutex);
+    vgr_read_task_T *task = xmalloc(sizeof(*task));
+    task->reader = reader;
+    task->idx = reader->submitted;
+    pool_submit(vgr_read_work, NULL, vgr_read_cancel, task);
+  }
+}
+
+static void vgr_read_work(void *data)
+{
+  vgr_read_task_T *task = data;
+  vgr_reader_T *reader = task->reader;
+  vgr_file_T *file = &reader->files[task->idx];
+  xfree(task);
+
+  uv_mutex_lock(&reader->mutex);
+  bool todo = file->state == kVgrFilePending;
+  if (todo) {
+    file->state = kVgrFileReading;
+  }
+  uv_mutex_unlock(&reader->mutex);
+
+  if (todo) {
+    size_t size = 0;
+    char *text = file->fname != NULL ? vgr_read_file(file->fname, &size) : NULL;
+    uv_mutex_lock(&reader->mutex);
+    file->text = text;
+    file->size = size;
+    file->state = kVgrFileDone;
+    uv_cond_broadcast(&reader->cond);
+    uv_mutex_unlock(&reader->mutex);
+  }
+  vgr_reader_unref(reader);
+}
+
+/// Called instead of vgr_read_work() when the thread pool discards the task.
+/// The file is read by vgr_reader_take() when needed.
+static void vgr_read_cancel(void *data)
+{
+  vgr_read_task_T *task = data;
+  vgr_reader_T *reader = task->reader;
+  xfree(task);
+  vgr_reader_unref(reader);
+}
+
+/// Get the contents of file "idx", reading it now when no worker started
+/// reading it yet. The caller must free the result.
+static char *vgr_reader_take(vgr_reader_T *reader, int idx, size_t *sizep)
+{
+  vgr_file_T *file = &reader->files[idx];
+  uv_mutex_lock(&reader->mutex);
+  if (file->state == kVgrFilePending) {
+    file->state = kVgrFileSkipped;
+    uv_mutex_unlock(&reader->mutex);
+    return file->fname != NULL ? vgr_read_file(file->fname, sizep) : NULL;
+  }
+  while (file->state == kVgrFileReading) {
+    uv_cond_wait(&reader->cond, &reader->mutex);
+  }
+  char *text = file->text;
+  *sizep = file->size;
+  file->text = NULL;
+  file->state = kVgrFileSkipped;
+  uv_mutex_unlock(&reader->mutex);
+  return text;
+}
+
+/// Drop the reference of vgr_process_files(), files that were not read yet
+/// are skipped.
+static void vgr_reader_close(vgr_reader_T *reader)
+{
+  uv_mutex_lock(&reader->mutex);
+  for (int i = 0; i < reader->count; i++) {
+    if (reader->files[i].state == kVgrFilePending) {
+      reader->files[i].state = kVgrFileSkipped;
+    }
+  }
+  uv_mutex_unlock(&reader->mutex);
+  vgr_reader_unref(reader);
+}
+
+static void vgr_reader_unref(vgr_reader_T *reader)
+{
+  uv_mutex_lock(&reader->mutex);
+  bool last = --reader->refcount == 0;
+  uv_mutex_unlock(&reader->mutex);
+  if (!last) {
+    return;
+  }
+  for (int i = 0; i < reader->count; i++) {
+    xfree(reader->files[i].fname);
+    xfree(reader->files[i].text);
+  }
+  xfree(reader->files);
+  uv_cond_destroy(&reader->cond);
+  uv_mutex_destroy(&reader->mutex);
+  xfree(reader);
+}
+
 /// Jump to the first match and update the directory.
 static void vgr_jump_to_match(qf_info_T *qi, int forceit, bool *redraw_for_dummy,
                               buf_T *first_match_buf, char *target_dir)  // NOLINT(readability-non-const-parameter)
@@ -5372,6 +5878,13 @@ static int vgr_process_files(win_T *wp, qf_info_T *qi, vgr_args_T *cmd_args, boo
   // ":lcd %:p:h" changes the meaning of short path names.
   os_dirname((char_u *)dirname_start, MAXPATHL);
 
+  // Files that are not loaded are read ahead by the thread pool and, when
+  // possible, searched without loading them into a dummy buffer.
+  vgr_reader_T *reader = NULL;
+  if (vgr_can_read_directly(cmd_args->spat, cmd_args->regmatch.regprog, cmd_args->flags)) {
+    reader = vgr_reader_new(cmd_args->fcount);
+  }
+
   time_t seconds = (time_t)0;
   for (int fi = 0; fi < cmd_args->fcount && !got_int && cmd_args->tomatch > 0; fi++) {
     char *fname = (char *)path_try_shorten_fname((char_u *)cmd_args->fnames[fi]);
@@ -5383,8 +5896,21 @@ static int vgr_process_files(win_T *wp, qf_info_T *qi, vgr_args_T *cmd_args, boo
     }
 
     buf_T *buf = buflist_findname_exp(cmd_args->fnames[fi]);
+    if (reader != NULL) {
+      vgr_reader_fill(reader, cmd_args->fnames, fi + 1 + VGR_READ_AHEAD * (int)pool_size());
+    }
     bool using_dummy;
     if (buf == NULL || buf->b_ml.ml_mfp == NULL) {
+      size_t size = 0;
+      char *text = reader != NULL ? vgr_reader_take(reader, fi, &size) : NULL;
+      if (text != NULL && !vgr_has_read_autocmds(fname)) {
+        vgr_match_text(qf_get_curlist(qi), fname, text, size, cmd_args->spat,
+                       &cmd_args->regmatch, &cmd_args->tomatch, cmd_args->flags);
+        xfree(text);
+        continue;
+      }
+      xfree(text);
+
       // Remember that a buffer with this name already exists.
       duplicate_name = (buf != NULL);
       using_dummy = true;
@@ -5480,6 +6006,9 @@ static int vgr_process_files(win_T *wp, qf_info_T *qi, vgr_args_T *cmd_args, boo
   status = OK;
 
 theend:
+  if (reader != NULL) {
+    vgr_reader_close(reader);
+  }
   xfree(dirname_now);
   xfree(dirname_start);
   return status;
@@ -6346,6 +6875,10 @@ static int qf_add_entries(qf_info_T *qi, int qf_idx, list_T *list, char *title,
   int retval = OK;
   bool valid_entry = false;
 
+  // Do not use the cached buffers, they may have been renamed or wiped out,
+  // or the current directory changed.
+  qf_fnum_cache_clear(false);
+
   if (action == ' ' || qf_idx == qi->qf_listcount) {
     // make place for a new list
     qf_new_list(qi, title);
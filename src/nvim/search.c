@@ -1229,7 +1229,7 @@ int do_search(oparg_T *oap, int dirc, int search_delim, char *pat, long count, i
           memmove(msgbuf + strlen(p) + 1, off_buf, off_len);
         }
 
-        trunc = msg_strtrunc(msgbuf, true);
+        trunc = msg_strtrunc(NULL, msgbuf, true);
         if (trunc != NULL) {
           xfree(msgbuf);
           msgbuf = trunc;
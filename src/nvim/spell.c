@@ -177,6 +177,34 @@ typedef struct syl_item_S {
   int sy_len;
 } syl_item_T;
 
+// Size of a spell_cache_T: number of hash buckets and entries per bucket.
+#define SPELL_CACHE_SETS 256
+#define SPELL_CACHE_WAYS 4
+// Longest text that is cached: a word and the character after it.
+#define SPELL_CACHE_WORDLEN 30
+
+// Result of checking a word in all languages of 'spelllang'.
+typedef struct {
+  char sce_word[SPELL_CACHE_WORDLEN];  // checked text, not NUL-terminated
+  uint8_t sce_len;                     // length of sce_word, zero if unused
+  bool sce_camel;                      // checked with "camel" in 'spelloptions'
+  int8_t sce_result;                   // SP_OK, SP_BAD, etc.
+  uint8_t sce_endlen;                  // length of the matched text
+  uint8_t sce_countlen;                // length of the counted word
+  slang_T *sce_countlang;              // language it is counted for, or NULL
+} spell_cache_entry_T;
+
+// Cache of spell_check() results for a synblock_T.  Each bucket is kept in
+// most recently used order.
+struct spell_cache_S {
+  unsigned sc_gen;                     // "spell_cache_gen" for the entries
+  spell_cache_entry_T sc_entries[SPELL_CACHE_SETS][SPELL_CACHE_WAYS];
+};
+
+// Incremented when cached spell_check() results may have become invalid,
+// because a language was (re)loaded or 'spelllang' changed.
+static unsigned spell_cache_gen = 1;
+
 spelltab_T spelltab;
 int did_set_spelltab;
 
@@ -300,54 +328,20 @@ size_t spell_check(win_T *wp, char_u *ptr, hlf_T *attrp, int *capcol, bool docou
     MB_PTR_ADV(mi.mi_fend);
   }
 
-  (void)spell_casefold(wp, ptr, (int)(mi.mi_fend - ptr), (char_u *)mi.mi_fword,
-                       MAXWLEN + 1);
-  mi.mi_fwordlen = (int)strlen(mi.mi_fword);
-
-  if (camel_case && mi.mi_fwordlen > 0) {
-    // introduce a fake word end space into the folded word.
-    mi.mi_fword[mi.mi_fwordlen - 1] = ' ';
-  }
-
-  // The word is bad unless we recognize it.
-  mi.mi_result = SP_BAD;
-  mi.mi_result2 = SP_BAD;
-
-  // Loop over the languages specified in 'spelllang'.
-  // We check them all, because a word may be matched longer in another
-  // language.
-  for (int lpi = 0; lpi < wp->w_s->b_langp.ga_len; lpi++) {
-    mi.mi_lp = LANGP_ENTRY(wp->w_s->b_langp, lpi);
-
-    // If reloading fails the language is still in the list but everything
-    // has been cleared.
-    if (mi.mi_lp->lp_slang->sl_fidxs == NULL) {
-      continue;
-    }
-
-    // Check for a matching word in case-folded words.
-    find_word(&mi, FIND_FOLDWORD);
-
-    // Check for a matching word in keep-case words.
-    find_word(&mi, FIND_KEEPWORD);
-
-    // Check for matching prefixes.
-    find_prefix(&mi, FIND_FOLDWORD);
-
-    // For a NOBREAK language, may want to use a word without a following
-    // word as a backup.
-    if (mi.mi_lp->lp_slang->sl_nobreak && mi.mi_result == SP_BAD
-        && mi.mi_result2 != SP_BAD) {
-      mi.mi_result = mi.mi_result2;
-      mi.mi_end = mi.mi_end2;
-    }
-
-    // Count the word in the first language where it's found to be OK.
-    if (count_word && mi.mi_result == SP_OK) {
-      count_common_word(mi.mi_lp->lp_slang, (char *)ptr,
-                        (int)(mi.mi_end - ptr), 1);
-      count_word = false;
+  // The result for the same text is remembered, unless the first language
+  // is NOBREAK: then the case-folded word is needed below.
+  const bool use_cache = !LANGP_ENTRY(wp->w_s->b_langp, 0)->lp_slang->sl_nobreak;
+  spell_cache_entry_T *sce
+    = use_cache ? spell_cache_find(wp->w_s, ptr, (size_t)(mi.mi_fend - ptr), use_camel_case)
+                : NULL;
+  if (sce != NULL) {
+    mi.mi_result = sce->sce_result;
+    mi.mi_end = ptr + sce->sce_endlen;
+    if (count_word && sce->sce_countlang != NULL) {
+      count_common_word(sce->sce_countlang, (char *)ptr, sce->sce_countlen, 1);
     }
+  } else {
+    spell_check_langs(&mi, ptr, camel_case, count_word, use_cache, use_camel_case);
   }
 
   if (mi.mi_result != SP_OK) {
@@ -424,6 +418,154 @@ size_t spell_check(win_T *wp, char_u *ptr, hlf_T *attrp, int *capcol, bool docou
   return (size_t)(mi.mi_end - ptr);
 }
 
+/// Check the word at "ptr" in all languages of 'spelllang', for spell_check().
+/// "mip->mi_fend" must be after the character following the word.
+/// Sets "mip->mi_result" and "mip->mi_end".
+///
+/// @param count_word  count the word if it is good
+/// @param cache  remember the result, see spell_cache_find()
+static void spell_check_langs(matchinf_T *mip, char_u *ptr, bool camel_case, bool count_word,
+                              bool cache, bool use_camel_case)
+{
+  win_T *wp = mip->mi_win;
+  const char_u *const fend = mip->mi_fend;
+
+  (void)spell_casefold(wp, ptr, (int)(mip->mi_fend - ptr), (char_u *)mip->mi_fword,
+                       MAXWLEN + 1);
+  mip->mi_fwordlen = (int)strlen(mip->mi_fword);
+
+  if (camel_case && mip->mi_fwordlen > 0) {
+    // introduce a fake word end space into the folded word.
+    mip->mi_fword[mip->mi_fwordlen - 1] = ' ';
+  }
+
+  // The word is bad unless we recognize it.
+  mip->mi_result = SP_BAD;
+  mip->mi_result2 = SP_BAD;
+
+  slang_T *countlang = NULL;
+  int countlen = 0;
+
+  // Loop over the languages specified in 'spelllang'.
+  // We check them all, because a word may be matched longer in another
+  // language.
+  for (int lpi = 0; lpi < wp->w_s->b_langp.ga_len; lpi++) {
+    mip->mi_lp = LANGP_ENTRY(wp->w_s->b_langp, lpi);
+
+    // If reloading fails the language is still in the list but everything
+    // has been cleared.
+    if (mip->mi_lp->lp_slang->sl_fidxs == NULL) {
+      continue;
+    }
+
+    // Check for a matching word in case-folded words.
+    find_word(mip, FIND_FOLDWORD);
+
+    // Check for a matching word in keep-case words.
+    find_word(mip, FIND_KEEPWORD);
+
+    // Check for matching prefixes.
+    find_prefix(mip, FIND_FOLDWORD);
+
+    // For a NOBREAK language, may want to use a word without a following
+    // word as a backup.
+    if (mip->mi_lp->lp_slang->sl_nobreak && mip->mi_result == SP_BAD
+        && mip->mi_result2 != SP_BAD) {
+      mip->mi_result = mip->mi_result2;
+      mip->mi_end = mip->mi_end2;
+    }
+
+    // Count the word in the first language where it's found to be OK.
+    if (countlang == NULL && mip->mi_result == SP_OK) {
+      countlang = mip->mi_lp->lp_slang;
+      countlen = (int)(mip->mi_end - ptr);
+      if (count_word) {
+        count_common_word(countlang, (char *)ptr, countlen, 1);
+      }
+    }
+  }
+
+  // When text after the word was used, e.g. for a word with a space, the
+  // result depends on more than the cached text.
+  if (cache && mip->mi_fend == fend) {
+    spell_cache_add(wp->w_s, ptr, (size_t)(fend - ptr), use_camel_case, mip->mi_result,
+                    (size_t)(mip->mi_end - ptr), countlang, countlen);
+  }
+}
+
+static uint32_t spell_cache_hash(const char_u *word, size_t len, bool camel)
+{
+  uint32_t h = 2166136261U;
+  for (size_t i = 0; i < len; i++) {
+    h = (h ^ word[i]) * 16777619U;
+  }
+  return h ^ camel;
+}
+
+/// Find the result of checking the "len" bytes at "word", the word and the
+/// character after it, in the languages of "synblock".
+///
+/// @return  the cache entry, NULL if it wasn't checked recently.
+static spell_cache_entry_T *spell_cache_find(synblock_T *synblock, const char_u *word, size_t len,
+                                             bool camel)
+{
+  spell_cache_T *sc = synblock->b_spell_cache;
+  if (sc == NULL || sc->sc_gen != spell_cache_gen || len > SPELL_CACHE_WORDLEN) {
+    return NULL;
+  }
+  spell_cache_entry_T *set
+    = sc->sc_entries[spell_cache_hash(word, len, camel) % SPELL_CACHE_SETS];
+  for (int i = 0; i < SPELL_CACHE_WAYS && set[i].sce_len != 0; i++) {
+    if (set[i].sce_len == len && set[i].sce_camel == camel
+        && memcmp(set[i].sce_word, word, len) == 0) {
+      if (i > 0) {
+        // Move it to the front, it is now the most recently used.
+        spell_cache_entry_T found = set[i];
+        memmove(set + 1, set, (size_t)i * sizeof(*set));
+        set[0] = found;
+      }
+      return &set[0];
+    }
+  }
+  return NULL;
+}
+
+/// Remember the result of checking the word "word".
+/// @see spell_cache_find()
+static void spell_cache_add(synblock_T *synblock, const char_u *word, size_t len, bool camel,
+                            int result, size_t endlen, slang_T *countlang, int countlen)
+{
+  if (len == 0 || len > SPELL_CACHE_WORDLEN) {
+    return;
+  }
+  spell_cache_T *sc = synblock->b_spell_cache;
+  if (sc == NULL) {
+    sc = synblock->b_spell_cache = xmalloc(sizeof(*sc));
+    sc->sc_gen = 0;
+  }
+  if (sc->sc_gen != spell_cache_gen) {
+    memset(sc->sc_entries, 0, sizeof(sc->sc_entries));
+    sc->sc_gen = spell_cache_gen;
+  }
+  spell_cache_entry_T *set
+    = sc->sc_entries[spell_cache_hash(word, len, camel) % SPELL_CACHE_SETS];
+  // Drop the least recently used entry.
+  memmove(set + 1, set, (SPELL_CACHE_WAYS - 1) * sizeof(*set));
+  memcpy(set[0].sce_word, word, len);
+  set[0].sce_len = (uint8_t)len;
+  set[0].sce_camel = camel;
+  set[0].sce_result = (int8_t)result;
+  set[0].sce_endlen = (uint8_t)endlen;
+  set[0].sce_countlang = countlang;
+  set[0].sce_countlen = (uint8_t)countlen;
+}
+
+/// Free the spell_check() cache of "synblock".
+void spell_cache_free(synblock_T *synblock)
+{
+  XFREE_CLEAR(synblock->b_spell_cache);
+}
+
 // Check if the word at "mip->mi_word" is in the tree.
 // When "mode" is FIND_FOLDWORD check in fold-case word tree.
 // When "mode" is FIND_KEEPWORD check in keep-case word tree.
@@ -1631,6 +1773,8 @@ void slang_clear(slang_T *lp)
 {
   garray_T *gap;
 
+  spell_cache_gen++;
+
   XFREE_CLEAR(lp->sl_fbyts);
   XFREE_CLEAR(lp->sl_kbyts);
   XFREE_CLEAR(lp->sl_pbyts);
@@ -2097,6 +2241,7 @@ char *did_set_spelllang(win_T *wp)
   // Everything is fine, store the new b_langp value.
   ga_clear(&wp->w_s->b_langp);
   wp->w_s->b_langp = ga;
+  spell_cache_gen++;
 
   // For each language figure out what language to use for sound folding and
   // REP items.  If the language doesn't support it itself use another one
@@ -2272,7 +2417,9 @@ void spell_free_all(void)
   // Go through all buffers and handle 'spelllang'. <VN>
   FOR_ALL_BUFFERS(buf) {
     ga_clear(&buf->b_s.b_langp);
+    spell_cache_free(&buf->b_s);
   }
+  spell_cache_gen++;
 
   while (first_lang != NULL) {
     slang_T *slang = first_lang;
@@ -79,6 +79,9 @@ typedef struct suginfo_S {
   char_u su_sal_badword[MAXWLEN];  ///< su_badword soundfolded
   hashtab_T su_banned;             ///< table with banned words
   slang_T *su_sallang;             ///< default language for sound folding
+  proftime_T su_deadline;          ///< when to stop searching, if su_has_deadline
+  bool su_has_deadline;
+  bool su_timed_out;               ///< su_deadline has passed
 } suginfo_T;
 
 /// One word suggestion.  Used in "si_ga".
@@ -912,9 +915,27 @@ static void spell_suggest_file(suginfo_T *su, char_u *fname)
   (void)cleanup_suggestions(&su->su_ga, su->su_maxscore, su->su_maxcount);
 }
 
+/// Check whether the time for finding suggestions is up.  The suggestions
+/// found so far are used then.
+static bool suggest_timed_out(suginfo_T *su)
+{
+  if (!su->su_timed_out && su->su_has_deadline && profile_passed_limit(su->su_deadline)) {
+    su->su_timed_out = true;
+  }
+  return su->su_timed_out;
+}
+
 /// Find suggestions for the internal method indicated by "sps_flags".
 static void spell_suggest_intern(suginfo_T *su, bool interactive)
 {
+  // All steps below may take an indefinite amount of time.  They share one
+  // deadline, so that the total time is limited.
+  su->su_has_deadline = spell_suggest_timeout > 0;
+  su->su_timed_out = false;
+  if (su->su_has_deadline) {
+    su->su_deadline = profile_setlimit(spell_suggest_timeout);
+  }
+
   // Load the .sug file(s) that are available and not done yet.
   suggest_load_files();
 
@@ -934,7 +955,7 @@ static void spell_suggest_intern(suginfo_T *su, bool interactive)
   }
 
   // 3. Try finding sound-a-like words.
-  if ((sps_flags & SPS_FAST) == 0) {
+  if ((sps_flags & SPS_FAST) == 0 && !suggest_timed_out(su)) {
     if (sps_flags & SPS_BEST) {
       // Adjust the word score for the suggestions found so far for how
       // they sounds like.
@@ -953,12 +974,12 @@ static void spell_suggest_intern(suginfo_T *su, bool interactive)
     su->su_maxscore = SCORE_SFMAX1;
     su->su_sfmaxscore = SCORE_MAXINIT * 3;
     suggest_try_soundalike(su);
-    if (su->su_ga.ga_len < SUG_CLEAN_COUNT(su)) {
+    if (su->su_ga.ga_len < SUG_CLEAN_COUNT(su) && !su->su_timed_out) {
       // We didn't find enough matches, try again, allowing more
       // changes to the soundfold word.
       su->su_maxscore = SCORE_SFMAX2;
       suggest_try_soundalike(su);
-      if (su->su_ga.ga_len < SUG_CLEAN_COUNT(su)) {
+      if (su->su_ga.ga_len < SUG_CLEAN_COUNT(su) && !su->su_timed_out) {
         // Still didn't find enough matches, try again, allowing even
         // more changes to the soundfold word.
         su->su_maxscore = SCORE_SFMAX3;
@@ -1101,6 +1122,9 @@ static void suggest_try_change(suginfo_T *su)
     if (lp->lp_slang->sl_fbyts == NULL) {
       continue;
     }
+    if (su->su_timed_out) {
+      break;
+    }
 
     // Try it for this language.  Will add possible suggestions.
 #ifdef SUGGEST_PROFILE
@@ -1219,19 +1243,12 @@ static void suggest_trie_walk(suginfo_T *su, langp_T *lp, char *fword, bool soun
     }
   }
 
-  // The loop may take an indefinite amount of time. Break out after some
-  // time.
-  proftime_T time_limit;
-  if (spell_suggest_timeout > 0) {
-    time_limit = profile_setlimit(spell_suggest_timeout);
-  }
-
   // Loop to find all suggestions.  At each round we either:
   // - For the current state try one operation, advance "ts_curi",
   //   increase "depth".
   // - When a state is done go to the next, set "ts_state".
   // - When all states are tried decrease "depth".
-  while (depth >= 0 && !got_int) {
+  while (depth >= 0 && !got_int && !su->su_timed_out) {
     sp = &stack[depth];
     switch (sp->ts_state) {
     case STATE_START:
@@ -2353,9 +2370,7 @@ static void suggest_trie_walk(suginfo_T *su, langp_T *lp, char *fword, bool soun
       if (--breakcheckcount == 0) {
         os_breakcheck();
         breakcheckcount = 1000;
-        if (spell_suggest_timeout > 0 && profile_passed_limit(time_limit)) {
-          got_int = true;
-        }
+        (void)suggest_timed_out(su);
       }
     }
   }
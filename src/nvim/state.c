@@ -112,10 +112,7 @@ getkey:
 void state_handle_k_event(void)
 {
   while (true) {
-    Event event = multiqueue_get(main_loop.events);
-    if (event.handler) {
-      event.handler(event.argv);
-    }
+    multiqueue_process_one(main_loop.events);
 
     if (multiqueue_empty(main_loop.events)) {
       // don't breakcheck before return, caller should return to main-loop
@@ -366,10 +366,13 @@ static void win_redr_custom(win_T *wp, bool draw_winbar, bool draw_ruler)
 
   // Make a copy, because the statusline may include a function call that
   // might change the option value and free the memory.
-  stl = xstrdup(stl);
+  Arena *arena = arena_scope_get(&redraw_scope);
+  stl = arena_memdupz(arena, stl, strlen(stl));
   width = build_stl_str_hl(ewp, buf, sizeof(buf), stl, opt_name,
                            opt_scope, fillchar, maxwidth, &hltab, &tabtab);
-  xfree(stl);
+  if (arena == NULL) {
+    xfree(stl);
+  }
   ewp->w_p_crb = p_crb_save;
 
   // Make all characters printable.
@@ -41,6 +41,7 @@
 #include "nvim/profile.h"
 #include "nvim/regexp.h"
 #include "nvim/runtime.h"
+#include "nvim/spell.h"
 #include "nvim/strings.h"
 #include "nvim/syntax.h"
 #include "nvim/types.h"
@@ -3013,6 +3014,7 @@ void reset_synblock(win_T *wp)
 {
   if (wp->w_s != &wp->w_buffer->b_s) {
     syntax_clear(wp->w_s);
+    spell_cache_free(wp->w_s);
     xfree(wp->w_s);
     wp->w_s = &wp->w_buffer->b_s;
   }
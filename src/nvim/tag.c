@@ -1282,7 +1282,7 @@ static int find_tagfunc_tags(char_u *pat, garray_T *ga, int *match_count, int fl
   save_pos = curwin->w_cursor;
   result = callback_call(&curbuf->b_tfu_cb, 3, args, &rettv);
   curwin->w_cursor = save_pos;  // restore the cursor position
-  d->dv_refcount--;
+  tv_dict_unref(d);
 
   if (result == FAIL) {
     return FAIL;
@@ -81,6 +81,7 @@
 #include "nvim/normal.h"
 #include "nvim/option.h"
 #include "nvim/optionstr.h"
+#include "nvim/os/time.h"
 #include "nvim/pos.h"
 #include "nvim/screen.h"
 #include "nvim/state.h"
@@ -105,13 +106,33 @@ typedef struct terminal_state {
 // Delay for refreshing the terminal buffer after receiving updates from
 // libvterm. Improves performance when receiving large bursts of data.
 #define REFRESH_DELAY 10
+// Upper bound for the delay when refreshing is slow, see refresh_delay().
+#define REFRESH_DELAY_MAX 100
 
 static TimeWatcher refresh_timer;
 static bool refresh_pending = false;
+static uint64_t refresh_cost = 0;  // duration of the last refresh (ns)
+static uint64_t refresh_end = 0;   // time the last refresh ended (ns)
+
+// Scrollback rows are stored compactly: the cell attributes as runs of equal
+// attributes and colors, one info byte per cell and the UTF-8 text of all
+// cells. The info byte holds the length of the cell text and the SB_CELL_*
+// flags.
+#define SB_CELL_LEN_MASK 0x3f
+#define SB_CELL_CONT 0x40  // continuation of a double-width cell
+#define SB_CELL_WIDE 0x80  // double-width cell
+
+typedef struct {
+  VTermScreenCellAttrs attrs;
+  VTermColor fg, bg;
+  uint32_t cols;  // number of cells covered by the run
+} ScrollbackRun;
 
 typedef struct {
   size_t cols;
-  VTermScreenCell cells[];
+  uint32_t nruns;
+  uint32_t textlen;
+  ScrollbackRun runs[];  // followed by `cols` info bytes and the text
 } ScrollbackLine;
 
 struct terminal {
@@ -123,7 +144,8 @@ struct terminal {
   //  - receive data from libvterm as a result of key presses.
   char textbuf[0x1fff];
 
-  ScrollbackLine **sb_buffer;       // Scrollback storage.
+  ScrollbackLine **sb_buffer;       // Scrollback storage (ring buffer).
+  size_t sb_start;                  // Index of the newest row in sb_buffer.
   size_t sb_current;                // Lines stored in sb_buffer.
   size_t sb_size;                   // Capacity of sb_buffer.
   // "virtual index" that points to the first sb_buffer row that we need to
@@ -131,6 +153,10 @@ struct terminal {
   // it actually points to entries that are no longer in sb_buffer (because the
   // window height has increased) and must be deleted from the terminal buffer
   int sb_pending;
+  // Cells of the scrollback row `sb_cells_row`, decoded for fetch_cell().
+  VTermScreenCell *sb_cells;
+  size_t sb_cells_size;
+  const ScrollbackLine *sb_cells_row;
 
   char *title;     // VTermStringFragment buffer
   size_t title_len;    // number of rows pushed to sb_buffer
@@ -661,9 +687,10 @@ void terminal_destroy(Terminal **termpp)
       pmap_del(ptr_t)(&invalidated_terminals, term);
     }
     for (size_t i = 0; i < term->sb_current; i++) {
-      xfree(term->sb_buffer[i]);
+      xfree(*sb_row(term, i));
     }
     xfree(term->sb_buffer);
+    xfree(term->sb_cells);
     xfree(term->title);
     vterm_free(term->vt);
     xfree(term);
@@ -773,8 +800,11 @@ void terminal_receive(Terminal *term, char *data, size_t len)
     return;
   }
 
+  // Only parse the data here. The damage is accumulated by libvterm and
+  // applied to the buffer by the next refresh, so a burst of reads only
+  // materializes the final screen.
   vterm_input_write(term->vt, data, len);
-  vterm_screen_flush_damage(term->vts);
+  invalidate_terminal(term, -1, -1);
 }
 
 static int get_rgb(VTermState *state, VTermColor color)
@@ -988,42 +1018,22 @@ static int term_sb_push(int cols, const VTermScreenCell *cells, void *data)
     return 0;
   }
 
-  // copy vterm cells into sb_buffer
-  size_t c = (size_t)cols;
-  ScrollbackLine *sbrow = NULL;
+  // The new row becomes the newest one, in the slot before the current
+  // newest. When the storage is full, that slot holds the oldest row.
+  term->sb_start = (term->sb_start + term->sb_size - 1) % term->sb_size;
+  ScrollbackLine **slot = &term->sb_buffer[term->sb_start];
   if (term->sb_current == term->sb_size) {
-    if (term->sb_buffer[term->sb_current - 1]->cols == c) {
-      // Recycle old row if it's the right size
-      sbrow = term->sb_buffer[term->sb_current - 1];
-    } else {
-      xfree(term->sb_buffer[term->sb_current - 1]);
-    }
-
-    // Make room at the start by shifting to the right.
-    memmove(term->sb_buffer + 1, term->sb_buffer,
-            sizeof(term->sb_buffer[0]) * (term->sb_current - 1));
-  } else if (term->sb_current > 0) {
-    // Make room at the start by shifting to the right.
-    memmove(term->sb_buffer + 1, term->sb_buffer,
-            sizeof(term->sb_buffer[0]) * term->sb_current);
-  }
-
-  if (!sbrow) {
-    sbrow = xmalloc(sizeof(ScrollbackLine) + c * sizeof(sbrow->cells[0]));
-    sbrow->cols = c;
-  }
-
-  // New row is added at the start of the storage buffer.
-  term->sb_buffer[0] = sbrow;
-  if (term->sb_current < term->sb_size) {
+    sb_row_forget(term, *slot);
+  } else {
+    *slot = NULL;
     term->sb_current++;
   }
+  *slot = sb_row_encode(*slot, (size_t)cols, cells);
 
   if (term->sb_pending < (int)term->sb_size) {
     term->sb_pending++;
   }
 
-  memcpy(sbrow->cells, cells, sizeof(cells[0]) * c);
   pmap_put(ptr_t)(&invalidated_terminals, term, NULL);
 
   return 1;
@@ -1046,30 +1056,151 @@ static int term_sb_pop(int cols, VTermScreenCell *cells, void *data)
     term->sb_pending--;
   }
 
-  ScrollbackLine *sbrow = term->sb_buffer[0];
+  ScrollbackLine *sbrow = term->sb_buffer[term->sb_start];
+  term->sb_start = (term->sb_start + 1) % term->sb_size;
   term->sb_current--;
-  // Forget the "popped" row by shifting the rest onto it.
-  memmove(term->sb_buffer, term->sb_buffer + 1,
-          sizeof(term->sb_buffer[0]) * (term->sb_current));
-
-  size_t cols_to_copy = (size_t)cols;
-  if (cols_to_copy > sbrow->cols) {
-    cols_to_copy = sbrow->cols;
-  }
 
   // copy to vterm state
-  memcpy(cells, sbrow->cells, sizeof(cells[0]) * cols_to_copy);
+  size_t cols_to_copy = MIN((size_t)cols, sbrow->cols);
+  sb_row_decode(sbrow, cells, cols_to_copy);
   for (size_t col = cols_to_copy; col < (size_t)cols; col++) {
     cells[col].chars[0] = 0;
     cells[col].width = 1;
   }
 
+  sb_row_forget(term, sbrow);
   xfree(sbrow);
   pmap_put(ptr_t)(&invalidated_terminals, term, NULL);
 
   return 1;
 }
 
+/// Gets the storage slot of scrollback row `idx`, 0 being the newest row.
+static inline ScrollbackLine **sb_row(Terminal *term, size_t idx)
+{
+  return &term->sb_buffer[(term->sb_start + idx) % term->sb_size];
+}
+
+/// Drops the decoded cells of `sbrow` before it is freed or reused.
+static inline void sb_row_forget(Terminal *term, const ScrollbackLine *sbrow)
+{
+  if (term->sb_cells_row == sbrow) {
+    term->sb_cells_row = NULL;
+  }
+}
+
+static inline uint8_t *sb_row_info(const ScrollbackLine *sbrow)
+{
+  return (uint8_t *)(sbrow->runs + sbrow->nruns);
+}
+
+static inline char *sb_row_text(const ScrollbackLine *sbrow)
+{
+  return (char *)sb_row_info(sbrow) + sbrow->cols;
+}
+
+static bool sb_cell_same_attrs(const VTermScreenCell *a, const VTermScreenCell *b)
+{
+  // libvterm fills the cells it pushes from zeroed memory field by field, so
+  // the attribute bitfields can be compared as bytes.
+  return memcmp(&a->attrs, &b->attrs, sizeof(a->attrs)) == 0
+         && vterm_color_is_equal(&a->fg, &b->fg)
+         && vterm_color_is_equal(&a->bg, &b->bg);
+}
+
+/// Converts a row of cells into the compact scrollback form.
+///
+/// @param sbrow  Row to reuse the memory of, or NULL.
+static ScrollbackLine *sb_row_encode(ScrollbackLine *sbrow, size_t cols,
+                                     const VTermScreenCell *cells)
+{
+  uint32_t nruns = 0;
+  size_t textlen = 0;
+  for (size_t col = 0; col < cols; col++) {
+    if (col == 0 || !sb_cell_same_attrs(&cells[col - 1], &cells[col])) {
+      nruns++;
+    }
+    if (cells[col].chars[0] == (uint32_t)-1) {
+      continue;
+    }
+    for (int i = 0; i < VTERM_MAX_CHARS_PER_CELL && cells[col].chars[i]; i++) {
+      textlen += (size_t)utf_char2len((int)cells[col].chars[i]);
+    }
+  }
+
+  sbrow = xrealloc(sbrow, sizeof(ScrollbackLine) + nruns * sizeof(ScrollbackRun)
+                   + cols + textlen);
+  sbrow->cols = cols;
+  sbrow->nruns = nruns;
+  sbrow->textlen = (uint32_t)textlen;
+
+  ScrollbackRun *run = sbrow->runs;
+  uint8_t *info = sb_row_info(sbrow);
+  char *text = sb_row_text(sbrow);
+  for (size_t col = 0; col < cols; col++) {
+    const VTermScreenCell *cell = &cells[col];
+    if (col == 0 || !sb_cell_same_attrs(&cells[col - 1], cell)) {
+      run += col > 0;
+      run->attrs = cell->attrs;
+      run->fg = cell->fg;
+      run->bg = cell->bg;
+      run->cols = 0;
+    }
+    run->cols++;
+
+    if (cell->chars[0] == (uint32_t)-1) {
+      info[col] = SB_CELL_CONT;
+      continue;
+    }
+    int len = 0;
+    for (int i = 0; i < VTERM_MAX_CHARS_PER_CELL && cell->chars[i]; i++) {
+      len += utf_char2bytes((int)cell->chars[i], text + len);
+    }
+    text += len;
+    info[col] = (uint8_t)(len | (cell->width == 2 ? SB_CELL_WIDE : 0));
+  }
+
+  return sbrow;
+}
+
+/// Converts the first `cols` cells of a compact scrollback row back into
+/// libvterm cells.
+static void sb_row_decode(const ScrollbackLine *sbrow, VTermScreenCell *cells, size_t cols)
+{
+  const ScrollbackRun *run = sbrow->runs;
+  uint32_t run_left = cols ? run->cols : 0;
+  const uint8_t *info = sb_row_info(sbrow);
+  const char *text = sb_row_text(sbrow);
+  for (size_t col = 0; col < cols; col++) {
+    if (run_left == 0) {
+      run++;
+      run_left = run->cols;
+    }
+    run_left--;
+
+    VTermScreenCell *cell = &cells[col];
+    cell->attrs = run->attrs;
+    cell->fg = run->fg;
+    cell->bg = run->bg;
+    cell->width = (info[col] & SB_CELL_WIDE) ? 2 : 1;
+    if (info[col] & SB_CELL_CONT) {
+      cell->chars[0] = (uint32_t)-1;
+      cell->chars[1] = 0;
+      continue;
+    }
+    const char *end = text + (info[col] & SB_CELL_LEN_MASK);
+    int i = 0;
+    for (; text < end && i < VTERM_MAX_CHARS_PER_CELL; i++) {
+      cell->chars[i] = (uint32_t)utf_ptr2char(text);
+      text += utf_ptr2len(text);
+    }
+    text = end;
+    if (i < VTERM_MAX_CHARS_PER_CELL) {
+      cell->chars[i] = 0;
+    }
+  }
+}
+
 // }}}
 // input handling {{{
 
@@ -1468,6 +1599,11 @@ end:
 
 static void fetch_row(Terminal *term, int row, int end_col)
 {
+  if (row < 0) {
+    fetch_sb_row(term, *sb_row(term, (size_t)(-row - 1)), end_col);
+    return;
+  }
+
   int col = 0;
   size_t line_len = 0;
   char *ptr = term->textbuf;
@@ -1492,12 +1628,50 @@ static void fetch_row(Terminal *term, int row, int end_col)
   term->textbuf[line_len] = NUL;
 }
 
+/// Like fetch_row() for a scrollback row, but takes the text directly from the
+/// compact form.
+static void fetch_sb_row(Terminal *term, const ScrollbackLine *sbrow, int end_col)
+{
+  size_t cols = MIN(sbrow->cols, (size_t)MAX(end_col, 0));
+  const uint8_t *info = sb_row_info(sbrow);
+  const char *text = sb_row_text(sbrow);
+  size_t line_len = 0;
+  char *ptr = term->textbuf;
+
+  size_t col = 0;
+  while (col < cols) {
+    int len = info[col] & SB_CELL_LEN_MASK;
+    if (len) {
+      memcpy(ptr, text, (size_t)len);
+      text += len;
+      ptr += len;
+      line_len = (size_t)(ptr - term->textbuf);
+    } else if (!(info[col] & SB_CELL_CONT)) {
+      *ptr++ = ' ';
+    }
+    col += (info[col] & SB_CELL_WIDE) ? 2 : 1;
+  }
+
+  // end of line
+  term->textbuf[line_len] = NUL;
+}
+
 static bool fetch_cell(Terminal *term, int row, int col, VTermScreenCell *cell)
 {
   if (row < 0) {
-    ScrollbackLine *sbrow = term->sb_buffer[-row - 1];
+    const ScrollbackLine *sbrow = *sb_row(term, (size_t)(-row - 1));
     if ((size_t)col < sbrow->cols) {
-      *cell = sbrow->cells[col];
+      // Callers go through a row cell by cell, decode it once.
+      if (term->sb_cells_row != sbrow) {
+        if (term->sb_cells_size < sbrow->cols) {
+          term->sb_cells_size = sbrow->cols;
+          term->sb_cells = xrealloc(term->sb_cells,
+                                    term->sb_cells_size * sizeof(term->sb_cells[0]));
+        }
+        sb_row_decode(sbrow, term->sb_cells, sbrow->cols);
+        term->sb_cells_row = sbrow;
+      }
+      *cell = term->sb_cells[col];
     } else {
       // fill the pointer with an empty cell
       *cell = (VTermScreenCell) {
@@ -1523,13 +1697,30 @@ static void invalidate_terminal(Terminal *term, int start_row, int end_row)
 
   pmap_put(ptr_t)(&invalidated_terminals, term, NULL);
   if (!refresh_pending) {
-    time_watcher_start(&refresh_timer, refresh_timer_cb, REFRESH_DELAY, 0);
+    time_watcher_start(&refresh_timer, refresh_timer_cb, refresh_delay(), 0);
     refresh_pending = true;
   }
 }
 
+/// Gets the delay before the next refresh (ms).
+///
+/// While refreshing is slow, e.g. when a job floods the terminal with output,
+/// the buffer is refreshed less often, so that at most a fifth of the time is
+/// spent on it. After a pause the first refresh is quick again.
+static uint64_t refresh_delay(void)
+{
+  if (os_hrtime() - refresh_end >= REFRESH_DELAY_MAX * 1000000ULL) {
+    return REFRESH_DELAY;
+  }
+  uint64_t delay = refresh_cost * 4 / 1000000;
+  return MIN(MAX(delay, REFRESH_DELAY), REFRESH_DELAY_MAX);
+}
+
 static void refresh_terminal(Terminal *term)
 {
+  // Get the damage accumulated since the last refresh.
+  vterm_screen_flush_damage(term->vts);
+
   buf_T *buf = handle_get_buffer(term->buf_handle);
   bool valid = true;
   if (!buf || !(valid = buf_valid(buf))) {
@@ -1556,19 +1747,25 @@ static void refresh_terminal(Terminal *term)
 /// Calls refresh_terminal() on all invalidated_terminals.
 static void refresh_timer_cb(TimeWatcher *watcher, void *data)
 {
-  refresh_pending = false;
   if (exiting) {  // Cannot redraw (requires event loop) during teardown/exit.
+    refresh_pending = false;
     return;
   }
+  uint64_t start = os_hrtime();
   Terminal *term;
   void *stub; (void)(stub);
   // don't process autocommands while updating terminal buffers
   block_autocmds();
+  // refresh_pending is still set, the damage flushed by refresh_terminal()
+  // must not schedule another refresh.
   map_foreach(&invalidated_terminals, term, stub, {
     refresh_terminal(term);
   });
   pmap_clear(ptr_t)(&invalidated_terminals);
   unblock_autocmds();
+  refresh_pending = false;
+  refresh_end = os_hrtime();
+  refresh_cost = refresh_end - start;
 }
 
 static void refresh_size(Terminal *term, buf_T *buf)
@@ -1611,15 +1808,22 @@ static void adjust_scrollback(Terminal *term, buf_T *buf)
     for (size_t i = 0; i < diff; i++) {
       ml_delete(1, false);
       term->sb_current--;
-      xfree(term->sb_buffer[term->sb_current]);
+      ScrollbackLine *sbrow = *sb_row(term, term->sb_current);
+      sb_row_forget(term, sbrow);
+      xfree(sbrow);
     }
     deleted_lines(1, (linenr_T)diff);
   }
 
-  // Resize the scrollback storage.
-  size_t sb_region = sizeof(ScrollbackLine *) * scbk;
+  // Resize the scrollback storage, moving the newest row to the start.
   if (scbk != term->sb_size) {
-    term->sb_buffer = xrealloc(term->sb_buffer, sb_region);
+    ScrollbackLine **sb_buffer = xmalloc(sizeof(ScrollbackLine *) * scbk);
+    for (size_t i = 0; i < term->sb_current; i++) {
+      sb_buffer[i] = *sb_row(term, i);
+    }
+    xfree(term->sb_buffer);
+    term->sb_buffer = sb_buffer;
+    term->sb_start = 0;
   }
 
   term->sb_size = scbk;
@@ -1634,29 +1838,41 @@ static void refresh_scrollback(Terminal *term, buf_T *buf)
   // May still have pending scrollback after increase in terminal height if the
   // scrollback wasn't refreshed in time; append these to the top of the buffer.
   int row_offset = term->sb_pending;
+  int count = 0;
   while (term->sb_pending > 0 && buf->b_ml.ml_line_count < height) {
     fetch_row(term, term->sb_pending - row_offset - 1, width);
     ml_append(0, term->textbuf, 0, false);
-    appended_lines(0, 1);
     term->sb_pending--;
+    count++;
+  }
+  if (count > 0) {
+    appended_lines(0, count);
   }
 
   row_offset -= term->sb_pending;
-  while (term->sb_pending > 0) {
+  if (term->sb_pending > 0) {
     // This means that either the window height has decreased or the screen
-    // became full and libvterm had to push all rows up. Convert the first
-    // pending scrollback row into a string and append it just above the visible
-    // section of the buffer
-    if (((int)buf->b_ml.ml_line_count - height) >= (int)term->sb_size) {
+    // became full and libvterm had to push all rows up. Convert the pending
+    // scrollback rows into strings and append them just above the visible
+    // section of the buffer. All rows pending in one refresh are appended (and
+    // the lines they push out of the scrollback deleted) as one change.
+    count = term->sb_pending;
+    int excess = (int)buf->b_ml.ml_line_count - height + count - (int)term->sb_size;
+    excess = MIN(MAX(excess, 0), count);
+    if (excess > 0) {
       // scrollback full, delete lines at the top
-      ml_delete(1, false);
-      deleted_lines(1, 1);
+      for (int i = 0; i < excess; i++) {
+        ml_delete(1, false);
+      }
+      deleted_lines(1, excess);
     }
-    fetch_row(term, -term->sb_pending - row_offset, width);
     int buf_index = (int)buf->b_ml.ml_line_count - height;
-    ml_append(buf_index, term->textbuf, 0, false);
-    appended_lines(buf_index, 1);
-    term->sb_pending--;
+    for (int i = 0; i < count; i++) {
+      fetch_row(term, -term->sb_pending - row_offset, width);
+      ml_append(buf_index + i, term->textbuf, 0, false);
+      term->sb_pending--;
+    }
+    appended_lines(buf_index, count);
   }
 
   // Remove extra lines at the bottom
@@ -13,6 +13,7 @@
 #include "nvim/event/loop.h"
 #include "nvim/grid_defs.h"
 #include "nvim/highlight_defs.h"
+#include "nvim/log.h"
 #include "nvim/main.h"
 #include "nvim/memory.h"
 #include "nvim/ui.h"
@@ -104,6 +105,7 @@ static void ui_thread_run(void *data)
 {
   UIBridgeData *bridge = data;
   bridge->ui_main(bridge, bridge->ui);
+  log_thread_exit();
 }
 
 static void ui_bridge_stop(UI *b)
@@ -4021,6 +4021,7 @@ static tabpage_T *alloc_tabpage(void)
 void free_tabpage(tabpage_T *tp)
 {
   pmap_del(handle_T)(&tabpage_handles, tp->handle);
+  diff_cancel_update(tp);
   diff_clear(tp);
   for (int idx = 0; idx < SNAP_COUNT; idx++) {
     clear_snapshot(tp, idx);
@@ -0,0 +1,45 @@
+-- Counts the allocations made while redrawing and executing commands, to catch
+-- hot paths that go back to malloc() for short-lived memory.
+
+local helpers = require('test.functional.helpers')(after_each)
+local Screen = require('test.functional.ui.screen')
+local clear, command, exec_lua, request = helpers.clear, helpers.command, helpers.exec_lua, helpers.request
+
+describe('arena scopes', function()
+  before_each(function()
+    clear()
+    local screen = Screen.new(120, 50)
+    screen:attach()
+    command('set list listchars=tab:>-,eol:$ linebreak foldcolumn=2 statusline=%f%m%=%l/%L')
+    exec_lua([[
+      local lines = {}
+      for i = 1, 1000 do
+        lines[i] = ('\tfoo\tbar %d\tbaz'):format(i)
+      end
+      vim.api.nvim_buf_set_lines(0, 0, -1, true, lines)
+    ]])
+  end)
+
+  local function measure(name, cmd)
+    local before = request('nvim__stats')
+    for _ = 1, 200 do
+      command(cmd)
+    end
+    local after = request('nvim__stats')
+    local scopes = after.arena_scopes
+    print(('\n%s: %d malloc() calls, redraw arena: %d allocs (%d mallocs), cmd arena: %d allocs (%d mallocs)')
+          :format(name, after.alloc_count - before.alloc_count,
+                  scopes.redraw.alloc_count - before.arena_scopes.redraw.alloc_count,
+                  scopes.redraw.malloc_count - before.arena_scopes.redraw.malloc_count,
+                  scopes.cmd.alloc_count - before.arena_scopes.cmd.alloc_count,
+                  scopes.cmd.malloc_count - before.arena_scopes.cmd.malloc_count))
+  end
+
+  it('full redraw', function()
+    measure('redraw!', 'redraw!')
+  end)
+
+  it('scrolling', function()
+    measure('scroll', 'execute "normal! \\<C-E>" | redraw')
+  end)
+end)
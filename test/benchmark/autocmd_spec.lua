@@ -0,0 +1,57 @@
+-- Measures the cost of triggering events with many autocommands defined.
+
+local helpers = require('test.functional.helpers')(after_each)
+local clear, exec_lua = helpers.clear, helpers.exec_lua
+
+describe('autocmd perf', function()
+  before_each(function()
+    clear()
+    -- 10000 autocommands, like a config with many plugins: mostly FileType
+    -- names and BufEnter/BufReadPost extensions, some buffer-local ones and
+    -- some that need a regexp.
+    exec_lua([[
+      local cb = function() end
+      local group = vim.api.nvim_create_augroup('bench', {})
+      for i = 1, 4000 do
+        vim.api.nvim_create_autocmd('FileType', { group = group, pattern = 'ft' .. i, callback = cb })
+      end
+      for i = 1, 2000 do
+        vim.api.nvim_create_autocmd({ 'BufEnter', 'BufReadPost' },
+          { group = group, pattern = '*.ext' .. i, callback = cb })
+      end
+      for i = 1, 100 do
+        vim.cmd('new')
+        vim.api.nvim_create_autocmd('BufEnter', { group = group, buffer = 0, callback = cb })
+        vim.cmd('close')
+      end
+      for i = 1, 1900 do
+        vim.api.nvim_create_autocmd('BufEnter',
+          { group = group, pattern = 'X' .. i .. '*[a-z].ext', callback = cb })
+      end
+    ]])
+  end)
+
+  local function measure(name, code)
+    local elapsed = exec_lua([[
+      local f = loadstring(...)
+      local start = vim.loop.hrtime()
+      for _ = 1, 10000 do
+        f()
+      end
+      return (vim.loop.hrtime() - start) / 1e6
+    ]], code)
+    print(('\n%s: %.1f ms for 10000 events'):format(name, elapsed))
+  end
+
+  it('FileType', function()
+    measure('FileType', [[vim.api.nvim_exec_autocmds('FileType', { pattern = 'ft1234' })]])
+  end)
+
+  it('BufEnter', function()
+    measure('BufEnter', [[vim.api.nvim_exec_autocmds('BufEnter', { pattern = 'foo.ext42' })]])
+  end)
+
+  it('BufEnter without matches', function()
+    measure('BufEnter (no match)', [[vim.api.nvim_exec_autocmds('BufEnter', { pattern = 'foo.c' })]])
+  end)
+end)
@@ -0,0 +1,45 @@
+-- Measures keyword completion with CTRL-N when there are many buffers to
+-- scan.
+
+local helpers = require('test.functional.helpers')(after_each)
+local luv = require('luv')
+local clear, exec_lua, feed = helpers.clear, helpers.exec_lua, helpers.feed
+local funcs, poke_eventloop = helpers.funcs, helpers.poke_eventloop
+
+describe('insert completion perf', function()
+  before_each(function()
+    clear()
+    -- 200 buffers of 2000 lines, with many words in common.
+    exec_lua([[
+      math.randomseed(42)
+      local lines = {}
+      for i = 1, 2000 do
+        local words = {}
+        for j = 1, 8 do
+          words[j] = ('fo%d_%d'):format(math.random(5000), (i + j) % 7)
+        end
+        lines[i] = table.concat(words, ' ')
+      end
+      for _ = 1, 200 do
+        local buf = vim.api.nvim_create_buf(true, false)
+        vim.api.nvim_buf_set_lines(buf, 0, -1, true, lines)
+      end
+      vim.o.complete = '.,b'
+    ]])
+  end)
+
+  local function measure(name)
+    local start = luv.hrtime()
+    feed('ofo<C-N>')
+    poke_eventloop()
+    local elapsed = (luv.hrtime() - start) / 1e6
+    local count = #funcs.complete_info({'items'}).items
+    feed('<C-E><Esc>')
+    print(('\n%s: %d matches in %.1f ms'):format(name, count, elapsed))
+  end
+
+  it('CTRL-N over 200 buffers', function()
+    measure('first CTRL-N')
+    measure('second CTRL-N')
+  end)
+end)
@@ -0,0 +1,74 @@
+-- Measures Vimscript dictionary and variable lookups, which go through the
+-- hashtab. Run it on two builds to compare hashtab implementations.
+
+local helpers = require('test.functional.helpers')(after_each)
+local clear, exec_lua, source = helpers.clear, helpers.exec_lua, helpers.source
+
+describe('dict perf', function()
+  before_each(function()
+    clear()
+    source([[
+      func DictOps(n)
+        let d = {}
+        for i in range(a:n)
+          let d['key' .. i] = i
+        endfor
+        let total = 0
+        for _ in range(10)
+          for i in range(a:n)
+            let total += d['key' .. i]
+          endfor
+        endfor
+        for i in range(0, a:n - 1, 2)
+          call remove(d, 'key' .. i)
+        endfor
+        for i in range(a:n)
+          let total += get(d, 'key' .. i, 0)
+        endfor
+        return total
+      endfunc
+
+      func SmallDicts(n)
+        let total = 0
+        for i in range(a:n)
+          let d = {'name': 'x', 'lnum': i, 'col': 1, 'type': 'E', 'valid': 1}
+          let total += d.lnum + d.col + d.valid
+        endfor
+        return total
+      endfunc
+
+      func Locals(n)
+        let a = 1
+        let b = 2
+        let c = 3
+        let total = 0
+        for i in range(a:n)
+          let total += a + b + c + i
+        endfor
+        return total
+      endfunc
+    ]])
+  end)
+
+  local function measure(name, expr)
+    local elapsed = exec_lua([[
+      local expr = ...
+      local start = vim.loop.hrtime()
+      vim.fn.eval(expr)
+      return (vim.loop.hrtime() - start) / 1e6
+    ]], expr)
+    print(('\n%s: %.1f ms'):format(name, elapsed))
+  end
+
+  it('large dict', function()
+    measure('insert, lookup and remove 100000 keys', 'DictOps(100000)')
+  end)
+
+  it('small dicts', function()
+    measure('200000 dicts of 5 keys', 'SmallDicts(200000)')
+  end)
+
+  it('function locals', function()
+    measure('1000000 loops over locals', 'Locals(1000000)')
+  end)
+end)
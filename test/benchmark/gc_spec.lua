@@ -0,0 +1,43 @@
+-- Measures garbage collection pauses with a lot of Vimscript state, and how
+-- often collections while waiting for input are skipped.
+
+local helpers = require('test.functional.helpers')(after_each)
+local clear, command, request, source = helpers.clear, helpers.command, helpers.request, helpers.source
+
+describe('garbage collection perf', function()
+  before_each(function()
+    clear()
+    -- About 200000 dicts in nested lists, like the state of many plugins.
+    source([[
+      let g:state = []
+      for i in range(2000)
+        let l = []
+        for j in range(100)
+          call add(l, {'name': 'item' .. j, 'lnum': j, 'data': [i, j]})
+        endfor
+        call add(g:state, l)
+      endfor
+    ]])
+  end)
+
+  local function report(name, gc)
+    print(('\n%s: %d collections, mean %.2f ms, p99 %.2f ms, max %.2f ms, %d skipped')
+          :format(name, gc.count, gc.mean / 1e6, gc.p99 / 1e6, gc.max / 1e6, gc.skipped))
+  end
+
+  it('explicit collections', function()
+    for _ = 1, 10 do
+      command('call test_garbagecollect_now()')
+    end
+    report('test_garbagecollect_now()', request('nvim__stats').gc)
+  end)
+
+  it('idle collections', function()
+    command('set updatetime=1')
+    for _ = 1, 50 do
+      helpers.feed('<Esc>')
+      helpers.sleep(5)
+    end
+    report('idle', request('nvim__stats').gc)
+  end)
+end)
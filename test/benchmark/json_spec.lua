@@ -0,0 +1,142 @@
+-- Measures JSON decoding and encoding of payloads like the ones exchanged with
+-- language servers.
+
+local helpers = require('test.functional.helpers')(after_each)
+local clear, exec_lua = helpers.clear, helpers.exec_lua
+
+describe('json perf', function()
+  before_each(function()
+    clear()
+    -- A completion response with 5000 items and a workspace/symbol response
+    -- with 5000 symbols: long ASCII strings, some escapes and some
+    -- non-ASCII text.
+    exec_lua([[
+      local items = {}
+      for i = 1, 5000 do
+        items[i] = {
+          label = 'completion_item_' .. i,
+          kind = i % 25 + 1,
+          detail = 'fn(a: &str, b: Option<usize>) -> Result<Vec<String>, Error>',
+          documentation = {
+            kind = 'markdown',
+            value = '```rust\nfn completion_item_' .. i .. '()\n```\n\nReturns the «value» of "item" ' .. i,
+          },
+          sortText = ('%08d'):format(i),
+          textEdit = {
+            range = { start = { line = i, character = 4 }, ['end'] = { line = i, character = 12 } },
+            newText = 'completion_item_' .. i .. '(${1:a}, ${2:b})',
+          },
+        }
+      end
+      local symbols = {}
+      for i = 1, 5000 do
+        symbols[i] = {
+          name = 'Symbol' .. i,
+          kind = 12,
+          containerName = 'crate::module::submodule_' .. i % 100,
+          location = {
+            uri = 'file:///home/user/src/project/src/module/submodule_' .. i % 100 .. '.rs',
+            range = { start = { line = i, character = 0 }, ['end'] = { line = i + 20, character = 1 } },
+          },
+        }
+      end
+      _G.payloads = {
+        completion = vim.json.encode({ isIncomplete = false, items = items }),
+        symbols = vim.json.encode(symbols),
+      }
+    ]])
+  end)
+
+  -- Runs `code` with every payload, decoded to a table first if `decoded`.
+  local function measure(name, code, decoded)
+    local result = exec_lua([[
+      local f = loadstring(...)
+      local decoded = select(2, ...)
+      local size = 0
+      local inputs = {}
+      for _, payload in pairs(_G.payloads) do
+        size = size + #payload
+        table.insert(inputs, decoded and vim.json.decode(payload) or payload)
+      end
+      local start = vim.loop.hrtime()
+      for _ = 1, 10 do
+        for _, input in ipairs(inputs) do
+          f(input)
+        end
+      end
+      local elapsed = (vim.loop.hrtime() - start) / 1e9
+      return { size * 10, elapsed }
+    ]], code, decoded)
+    local size, elapsed = unpack(result)
+    print(('\n%s: %.1f ms, %.1f MB/s'):format(name, elapsed * 1e3, size / elapsed / 1e6))
+  end
+
+  it('vim.json.decode', function()
+    measure('vim.json.decode', [[vim.json.decode(...)]], false)
+  end)
+
+  it('vim.json.encode', function()
+    measure('vim.json.encode', [[vim.json.encode(...)]], true)
+  end)
+
+  it('json_decode()', function()
+    measure('json_decode()', [[vim.fn.json_decode(...)]], false)
+  end)
+
+  it('json_encode()', function()
+    measure('json_encode()', [[vim.fn.json_encode(...)]], true)
+  end)
+
+  -- Reads the payloads framed like LSP messages, in chunks of 64 KiB like a
+  -- pipe delivers them. Also reports the time spent in the read callbacks,
+  -- which is how long input is blocked while a message arrives.
+  local function measure_rpc(name, use_reader)
+    local result = exec_lua([[
+      local use_reader = ...
+      local rpc = require('vim.lsp.rpc')
+      local data = {}
+      for _, payload in pairs(_G.payloads) do
+        table.insert(data, ('Content-Length: %d\r\n\r\n%s'):format(#payload, payload))
+      end
+      data = table.concat(data):rep(10)
+      local count = 0
+      local busy = 0
+      local read
+      if use_reader then
+        local reader = vim._json_rpc_reader(function(msg)
+          assert(msg)
+          count = count + 1
+        end, error)
+        read = function(_, chunk)
+          reader:feed(chunk)
+        end
+      else
+        read = rpc.create_read_loop(function(body)
+          assert(vim.json.decode(body, { luanil = { object = true } }))
+          count = count + 1
+        end)
+      end
+      local start = vim.loop.hrtime()
+      for i = 1, #data, 65536 do
+        local t = vim.loop.hrtime()
+        read(nil, data:sub(i, i + 65535))
+        busy = busy + vim.loop.hrtime() - t
+      end
+      vim.wait(60000, function()
+        return count == 20
+      end, 1)
+      return { #data, (vim.loop.hrtime() - start) / 1e9, busy / 1e9 }
+    ]], use_reader)
+    local size, elapsed, busy = unpack(result)
+    print(('\n%s: %.1f ms, %.1f MB/s, %.1f ms in read callbacks'):format(
+      name, elapsed * 1e3, size / elapsed / 1e6, busy * 1e3))
+  end
+
+  it('LSP messages with create_read_loop()', function()
+    measure_rpc('create_read_loop()', false)
+  end)
+
+  it('LSP messages with vim._json_rpc_reader()', function()
+    measure_rpc('vim._json_rpc_reader()', true)
+  end)
+end)
@@ -0,0 +1,68 @@
+-- Compares getting many lines or extmarks as tables with getting them as lazy
+-- arrays (vim._lazy()) when only a few of them are used.
+
+local helpers = require('test.functional.helpers')(after_each)
+local clear, exec_lua = helpers.clear, helpers.exec_lua
+
+describe('lazy API results', function()
+  before_each(function()
+    clear()
+    exec_lua([[
+      local lines = {}
+      for i = 1, 100000 do
+        lines[i] = ('%d: some text on a line %s'):format(i, ('x'):rep(i % 60))
+      end
+      vim.api.nvim_buf_set_lines(0, 0, -1, true, lines)
+      _G.ns = vim.api.nvim_create_namespace('bench')
+      for i = 0, 99999, 5 do
+        vim.api.nvim_buf_set_extmark(0, _G.ns, i, 0, {})
+      end
+    ]])
+  end)
+
+  local function measure(name, code)
+    local elapsed = exec_lua([[
+      local f = loadstring(...)
+      collectgarbage()
+      local start = vim.loop.hrtime()
+      for _ = 1, 20 do
+        f()
+      end
+      collectgarbage()
+      return (vim.loop.hrtime() - start) / 1e6
+    ]], code)
+    print(('\n%s: %.1f ms for 20 calls'):format(name, elapsed))
+  end
+
+  it('nvim_buf_get_lines', function()
+    measure('table', [[
+      local lines = vim.api.nvim_buf_get_lines(0, 0, -1, true)
+      return lines[50000]
+    ]])
+    measure('lazy', [[
+      local lines = vim._lazy(vim.api.nvim_buf_get_lines, 0, 0, -1, true)
+      return lines[50000]
+    ]])
+  end)
+
+  it('nvim_buf_get_lines and nvim_buf_set_lines', function()
+    measure('table', [[
+      vim.api.nvim_buf_set_lines(0, 0, -1, true, vim.api.nvim_buf_get_lines(0, 0, -1, true))
+    ]])
+    measure('lazy', [[
+      vim.api.nvim_buf_set_lines(0, 0, -1, true,
+                                 vim._lazy(vim.api.nvim_buf_get_lines, 0, 0, -1, true))
+    ]])
+  end)
+
+  it('nvim_buf_get_extmarks', function()
+    measure('table', [[
+      local marks = vim.api.nvim_buf_get_extmarks(0, _G.ns, 0, -1, {})
+      return marks[#marks]
+    ]])
+    measure('lazy', [[
+      local marks = vim._lazy(vim.api.nvim_buf_get_extmarks, 0, _G.ns, 0, -1, {})
+      return marks[#marks]
+    ]])
+  end)
+end)
@@ -0,0 +1,68 @@
+-- Measures how long it takes to fill the quickfix list from grep-like and
+-- compiler-like output, and to search many files with :vimgrep.
+
+local helpers = require('test.functional.helpers')(after_each)
+local clear, exec_lua = helpers.clear, helpers.exec_lua
+
+describe('quickfix perf', function()
+  before_each(function()
+    clear()
+  end)
+
+  local function measure(name, efm, fmt)
+    local elapsed = exec_lua([[
+      local efm, fmt = ...
+      local lines = {}
+      for i = 1, 200000 do
+        lines[i] = fmt:format(i % 500, i % 1000 + 1, i)
+      end
+      vim.o.errorformat = efm
+      local start = vim.loop.hrtime()
+      vim.fn.setqflist({}, ' ', { lines = lines })
+      return (vim.loop.hrtime() - start) / 1e6
+    ]], efm, fmt)
+    print(('\n%s: %.1f ms for 200000 lines'):format(name, elapsed))
+  end
+
+  it('grep output', function()
+    measure('grep', '%f:%l:%m', 'src/file%d.c:%d:match %d')
+  end)
+
+  it('compiler output with the default errorformat', function()
+    measure('default efm', helpers.eval('&errorformat'),
+            'src/file%d.c:%d:5: warning: unused variable %d')
+  end)
+end)
+
+describe('vimgrep perf', function()
+  local dir = 'Xvimgrep_bench'
+
+  setup(function()
+    helpers.mkdir_p(dir)
+    for i = 1, 2000 do
+      local f = assert(io.open(('%s/file%d.c'):format(dir, i), 'w'))
+      for j = 1, 500 do
+        f:write(('int var%d_%d = %d; /* some text on the line */\n'):format(i, j, j))
+      end
+      f:close()
+    end
+  end)
+
+  teardown(function()
+    helpers.rmdir(dir)
+  end)
+
+  before_each(function()
+    clear()
+  end)
+
+  it('2000 files', function()
+    local elapsed = exec_lua([[
+      local dir = ...
+      local start = vim.loop.hrtime()
+      vim.cmd('silent vimgrep /var\\d\\+_250 /j ' .. dir .. '/*.c')
+      return { (vim.loop.hrtime() - start) / 1e6, #vim.fn.getqflist() }
+    ]], dir)
+    print(('\n:vimgrep: %.1f ms, %d matches'):format(elapsed[1], elapsed[2]))
+  end)
+end)
@@ -0,0 +1,64 @@
+-- Measures spell checking of prose: redrawing with 'spell', moving to the
+-- next bad word with ]s and finding suggestions for long words.
+
+local helpers = require('test.functional.helpers')(after_each)
+local clear, exec_lua = helpers.clear, helpers.exec_lua
+
+describe('spell perf', function()
+  before_each(function()
+    clear()
+    exec_lua([[
+      local words = { 'the', 'quick', 'brown', 'fox', 'jumps', 'over', 'lazy',
+                      'dog', 'and', 'keeps', 'running', 'through', 'forest' }
+      local lines = {}
+      for i = 1, 100000 do
+        local line = {}
+        for j = 1, 12 do
+          line[j] = words[(i * 7 + j * 3) % #words + 1]
+        end
+        lines[i] = table.concat(line, ' ') .. '.'
+      end
+      -- A single misspelled word at the end.
+      lines[#lines] = 'speling ' .. lines[#lines]
+      vim.api.nvim_buf_set_lines(0, 0, -1, true, lines)
+      vim.o.spell = true
+    ]])
+  end)
+
+  it('redraw', function()
+    local elapsed = exec_lua([[
+      local start = vim.loop.hrtime()
+      for _ = 1, 200 do
+        vim.cmd('normal! \6')
+        vim.cmd('redraw!')
+      end
+      return (vim.loop.hrtime() - start) / 1e6
+    ]])
+    print(('\nredraw with spell: %.1f ms for 200 pages'):format(elapsed))
+  end)
+
+  it(']s', function()
+    local elapsed = exec_lua([[
+      local start = vim.loop.hrtime()
+      for _ = 1, 5 do
+        vim.cmd('normal! gg]s')
+      end
+      return (vim.loop.hrtime() - start) / 1e6
+    ]])
+    print(('\n]s over 100000 lines: %.1f ms for 5 moves'):format(elapsed))
+  end)
+
+  it('spellsuggest()', function()
+    local elapsed = exec_lua([[
+      local times = {}
+      for _, word in ipairs({ 'speling', 'recieveing', 'internationalisaton',
+                              'uncharacteristicalyl' }) do
+        local start = vim.loop.hrtime()
+        vim.fn.spellsuggest(word)
+        times[#times + 1] = ('%s %.1f ms'):format(word, (vim.loop.hrtime() - start) / 1e6)
+      end
+      return table.concat(times, ', ')
+    ]])
+    print('\nspellsuggest(): ' .. elapsed)
+  end)
+end)
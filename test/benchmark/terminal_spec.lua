@@ -0,0 +1,70 @@
+-- Compares the throughput of :terminal with a pty job whose output is not
+-- interpreted at all.
+
+local helpers = require('test.functional.helpers')(after_each)
+local clear, exec_lua = helpers.clear, helpers.exec_lua
+
+local sample_file = 'Xterminal_bench.txt'
+
+describe('terminal output', function()
+  setup(function()
+    local f = assert(io.open(sample_file, 'w'))
+    for i = 1, 500000 do
+      f:write(('%d: \027[3%dmcolored\027[m text %s\n'):format(i, i % 8, ('x'):rep(i % 60)))
+    end
+    f:close()
+  end)
+
+  teardown(function()
+    os.remove(sample_file)
+  end)
+
+  before_each(function()
+    clear()
+  end)
+
+  local function measure(use_terminal)
+    return exec_lua([[
+      local file, use_terminal = ...
+      local size = vim.loop.fs_stat(file).size
+      local start = vim.loop.hrtime()
+      local done = false
+      local opts = { on_exit = function() done = true end }
+      if use_terminal then
+        vim.fn.termopen({ 'cat', file }, opts)
+      else
+        opts.pty = true
+        vim.fn.jobstart({ 'cat', file }, opts)
+      end
+      vim.wait(120000, function() return done end, 1)
+      if use_terminal then
+        -- Wait until the final screen is in the buffer.
+        vim.wait(10000, function()
+          local lines = vim.api.nvim_buf_get_lines(0, -10, -1, false)
+          return table.concat(lines, '\n'):find('%[Process exited') ~= nil
+        end, 1)
+      end
+      local elapsed = (vim.loop.hrtime() - start) / 1e9
+      return { size, elapsed }
+    ]], sample_file, use_terminal)
+  end
+
+  local function report(name, result)
+    local size, elapsed = unpack(result)
+    print(('\n%s: %d bytes in %.3f s, %.1f MB/s'):format(name, size, elapsed,
+                                                          size / elapsed / 1e6))
+  end
+
+  it('pty job without terminal emulation', function()
+    report('pty job', measure(false))
+  end)
+
+  it(':terminal', function()
+    report(':terminal', measure(true))
+  end)
+
+  it(':terminal with scrollback=100000', function()
+    helpers.command('set scrollback=100000')
+    report(':terminal scrollback=100000', measure(true))
+  end)
+end)
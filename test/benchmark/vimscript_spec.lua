@@ -0,0 +1,139 @@
+-- Measures the throughput of Vimscript loops in user functions, where every
+-- line of the loop body is executed again for each iteration, and the number
+-- of allocations made by function calls (from nvim__stats().alloc_count).
+
+local helpers = require('test.functional.helpers')(after_each)
+local clear, exec_lua, source = helpers.clear, helpers.exec_lua, helpers.source
+
+describe('vimscript loop perf', function()
+  before_each(function()
+    clear()
+    source([[
+      func Count(n)
+        let i = 0
+        while i < a:n
+          let i += 1
+        endwhile
+        return i
+      endfunc
+
+      func Body(n)
+        let total = 0
+        for i in range(a:n)
+          let x = i * 2
+          if x % 3 == 0
+            let total += x
+          elseif x % 3 == 1
+            let total -= 1
+          else
+            let total += 1
+          endif
+        endfor
+        return total
+      endfunc
+
+      func Add(a, b)
+        return a:a + a:b
+      endfunc
+
+      func Calls(n)
+        let total = 0
+        for i in range(a:n)
+          let total = Add(total, i)
+        endfor
+        return total
+      endfunc
+
+      func Bars(n)
+        let total = 0
+        for i in range(a:n)
+          let total += 1 | let total -= 1 | let total += i
+        endfor
+        return total
+      endfunc
+    ]])
+  end)
+
+  local function measure(name, func, n)
+    local elapsed = exec_lua([[
+      local func, n = ...
+      local start = vim.loop.hrtime()
+      vim.fn[func](n)
+      return (vim.loop.hrtime() - start) / 1e6
+    ]], func, n)
+    print(('\n%s: %.1f ms for %d iterations, %.0f iterations/s'):format(name, elapsed, n,
+                                                                       n / elapsed * 1e3))
+  end
+
+  it(':while', function()
+    measure(':while counter', 'Count', 1000000)
+  end)
+
+  it(':for with :if', function()
+    measure(':for with :if', 'Body', 500000)
+  end)
+
+  it('function calls', function()
+    measure('function calls', 'Calls', 300000)
+  end)
+
+  it('commands separated with |', function()
+    measure('commands separated with |', 'Bars', 300000)
+  end)
+end)
+
+describe('vimscript allocations', function()
+  before_each(function()
+    clear()
+    source([[
+      func Add(a, b)
+        let sum = a:a + a:b
+        return sum
+      endfunc
+
+      func Fib(n)
+        return a:n < 2 ? a:n : Fib(a:n - 1) + Fib(a:n - 2)
+      endfunc
+
+      func Locals(n)
+        let x = a:n
+        let y = x * 2
+        let s = 'abc'
+        let t = s .. x
+        return len(t) + y
+      endfunc
+
+      " Make the redo buffer and the search pattern non-empty, like in a
+      " normal session.
+      call setline(1, 'foo bar')
+      normal! dw
+      let @/ = 'bar'
+    ]])
+  end)
+
+  local function measure(name, call, n)
+    local allocs, elapsed = unpack(exec_lua([[
+      local call, n = ...
+      local before = vim.api.nvim__stats().alloc_count
+      local start = vim.loop.hrtime()
+      vim.cmd(('for _ in range(%d) | call %s | endfor'):format(n, call))
+      local elapsed = (vim.loop.hrtime() - start) / 1e6
+      return { vim.api.nvim__stats().alloc_count - before, elapsed }
+    ]], call, n))
+    print(('\n%s: %.1f allocations per call, %.1f ms for %d calls'):format(name, allocs / n,
+                                                                          elapsed, n))
+  end
+
+  it('function call', function()
+    measure('Add()', 'Add(1, 2)', 100000)
+  end)
+
+  it('function with local variables', function()
+    measure('Locals()', 'Locals(5)', 100000)
+  end)
+
+  it('recursive function', function()
+    -- Fib(15) makes 1973 calls.
+    measure('Fib(15)', 'Fib(15)', 50)
+  end)
+end)
@@ -0,0 +1,42 @@
+-- Measures creating and closing many windows and buffers, which copies all
+-- window and buffer local options each time.
+
+local helpers = require('test.functional.helpers')(after_each)
+local clear, exec_lua = helpers.clear, helpers.exec_lua
+
+describe('window and buffer creation perf', function()
+  before_each(function()
+    clear()
+    -- Some long option values, as set by a typical config.
+    exec_lua([[
+      vim.o.statusline = ('%<%f %h%m%r%=%-14.(%l,%c%V%) %P'):rep(4)
+      vim.o.listchars = 'tab:> ,trail:-,nbsp:+,extends:>,precedes:<'
+      vim.o.fillchars = 'vert:|,fold:-,eob:~,diff:-'
+      vim.o.comments = 's1:/*,mb:*,ex:*/,://,b:#,:%,:XCOMM,n:>,fb:-'
+      vim.o.include = [[^\s*#\s*include]]
+    ]])
+  end)
+
+  local function measure(name, code)
+    local elapsed = exec_lua([[
+      local f = loadstring(...)
+      local start = vim.loop.hrtime()
+      for _ = 1, 10000 do
+        f()
+      end
+      return (vim.loop.hrtime() - start) / 1e6
+    ]], code)
+    print(('\n%s: %.1f ms for 10000'):format(name, elapsed))
+  end
+
+  it('windows', function()
+    measure(':split and :close', [[vim.cmd('split | close')]])
+  end)
+
+  it('buffers', function()
+    measure('create and wipe buffer', [[
+      local buf = vim.api.nvim_create_buf(true, false)
+      vim.api.nvim_buf_delete(buf, { force = true })
+    ]])
+  end)
+end)
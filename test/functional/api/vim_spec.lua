@@ -4050,4 +4050,86 @@ describe('API', function()
       end)
     end)
   end)
+
+  describe('nvim__event_stats', function()
+    it('records queue and handler statistics', function()
+      exec_lua([[
+        for _ = 1, 5 do
+          vim.schedule(function() end)
+        end
+      ]])
+      -- Round-trip so the scheduled callbacks have run.
+      eq(2, eval('1+1'))
+      local stats = request('nvim__event_stats', {})
+      eq({'channel', 'fast', 'main', 'ui'}, (function()
+        local kinds = {}
+        for k in pairs(stats.queues) do
+          table.insert(kinds, k)
+        end
+        table.sort(kinds)
+        return kinds
+      end)())
+      ok(stats.queues.main.run.count >= 5)
+      ok(stats.queues.main.depth_max >= 1)
+      ok(stats.queues.channel.wait.count >= 1)
+      local q = stats.queues.main.run
+      ok(q.min <= q.p50 and q.p50 <= q.p99 and q.p99 <= q.max)
+      ok(#stats.handlers >= 1 and #stats.handlers <= 10)
+      ok(stats.handlers[1].max >= stats.handlers[#stats.handlers].max)
+    end)
+
+    it('limits and resets', function()
+      eq(1, #request('nvim__event_stats', { top = 1, reset = true }).handlers)
+      local stats = request('nvim__event_stats', { top = 0 })
+      eq({}, stats.handlers)
+      eq(0, stats.queues.ui.run.count)
+      eq('top must be a non-negative integer',
+         pcall_err(request, 'nvim__event_stats', { top = -1 }))
+      -- Huge values are clamped, not allocated. Fewer than the limit of 257
+      -- handlers run here, so all of them are listed, each name once.
+      local all = request('nvim__event_stats', { top = 2^40 }).handlers
+      local names = {}
+      for _, h in ipairs(all) do
+        eq(nil, names[h.name])
+        names[h.name] = true
+      end
+      ok(#all < 257)
+      eq(#all, #request('nvim__event_stats', { top = 257 }).handlers)
+    end)
+  end)
+
+  describe('nvim__stats', function()
+    it('records garbage collection pauses', function()
+      local before = request('nvim__stats').gc.count
+      command('call test_garbagecollect_now()')
+      local gc = request('nvim__stats').gc
+      eq(before + 1, gc.count)
+      ok(gc.min <= gc.p50 and gc.p50 <= gc.max)
+    end)
+
+    it('skips idle garbage collection when nothing was unreferenced', function()
+      command('set updatetime=1')
+      local skipped = request('nvim__stats').gc.skipped
+      -- The first idle collection may still run for what startup left.
+      helpers.retry(nil, 5000, function()
+        feed('<Esc>')
+        ok(request('nvim__stats').gc.skipped > skipped)
+      end)
+    end)
+
+    it('counts allocations in the redraw and command arenas', function()
+      local screen = Screen.new(40, 8)
+      screen:attach()
+      command('set list listchars=tab:>- linebreak')
+      meths.buf_set_lines(0, 0, -1, true, {'\ta\tb', '\tc'})
+      local before = request('nvim__stats').arena_scopes
+      command('redraw!')
+      local after = request('nvim__stats').arena_scopes
+      -- One allocation for each tab.
+      ok(after.redraw.scope_count > before.redraw.scope_count)
+      ok(after.redraw.alloc_count >= before.redraw.alloc_count + 3)
+      ok(after.redraw.malloc_count <= before.redraw.malloc_count + 1)
+      ok(after.cmd.scope_count > before.cmd.scope_count)
+    end)
+  end)
 end)
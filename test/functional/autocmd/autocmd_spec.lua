@@ -457,6 +457,31 @@ describe('autocmd', function()
     ]]}
   end)
 
+  it('runs autocommands with different kinds of patterns in order', function()
+    source([[
+      let g:log = []
+      autocmd BufEnter * call add(g:log, 'star')
+      autocmd BufEnter *.txt call add(g:log, 'ext')
+      autocmd BufEnter Xfoo.txt call add(g:log, 'name')
+      autocmd BufEnter *.TXT call add(g:log, 'EXT')
+      autocmd BufEnter X*o.txt call add(g:log, 'glob')
+      autocmd BufEnter *.gz call add(g:log, 'gz')
+      autocmd BufEnter */Xfoo.txt call add(g:log, 'dir')
+      autocmd BufEnter *.tar.txt call add(g:log, 'tar')
+    ]])
+    command('edit Xfoo.txt')
+    eq({'star', 'ext', 'name', 'glob', 'dir'}, eval('g:log'))
+    command('let g:log = [] | edit Xbar.tar.txt')
+    eq({'star', 'ext', 'tar'}, eval('g:log'))
+    command('set fileignorecase')
+    command('let g:log = [] | edit XFOO.TXT')
+    eq({'star', 'ext', 'name', 'EXT', 'glob', 'dir'}, eval('g:log'))
+    command('autocmd BufEnter <buffer> call add(g:log, "buffer")')
+    command('autocmd! BufEnter *.txt')
+    command('let g:log = [] | doautocmd BufEnter')
+    eq({'star', 'name', 'EXT', 'glob', 'dir', 'buffer'}, eval('g:log'))
+  end)
+
   describe('v:event is readonly #18063', function()
     it('during ChanOpen event', function()
       command('autocmd ChanOpen * let v:event.info.id = 0')
@@ -1,10 +1,13 @@
 local helpers = require('test.functional.helpers')(after_each)
 local assert_log = helpers.assert_log
+local assert_nolog = helpers.assert_nolog
 local clear = helpers.clear
 local command = helpers.command
 local eq = helpers.eq
+local eval = helpers.eval
 local exec_lua = helpers.exec_lua
 local expect_exit = helpers.expect_exit
+local pcall_err = helpers.pcall_err
 local request = helpers.request
 local retry = helpers.retry
 
@@ -54,4 +57,34 @@ describe('log', function()
       assert_log('%.%d+%.%d/c +server_init:%d+: test log message', testlog, 100)
     end)
   end)
+
+  it('level can be set per subsystem', function()
+    clear({env={
+      NVIM_LOG_FILE=testlog,
+      NVIM_LOG_LEVEL='WRN,rpc=err',
+      __NVIM_TEST_LOG='1'
+      }})
+    retry(nil, 1000, function()
+      assert_log('ERR .*server_init:%d+: test log message', testlog, 100)
+    end)
+
+    -- RPC messages are logged at DBG level, which is only compiled in with
+    -- MIN_LOG_LEVEL=1 (default 2).
+    local min_level = eval('execute("version")'):match('%-DMIN_LOG_LEVEL=(%d)')
+    eq('before', request('nvim_eval', '"before"'))
+    eq(nil, request('nvim__set_log_level', 'RPC', 'DBG'))
+    eq(nil, request('nvim__set_log_level', '*', 'wrn'))
+    if tonumber(min_level or 2) <= 1 then
+      eq('after', request('nvim_eval', '"after"'))
+      retry(nil, 1000, function()
+        assert_log('DBG .* RPC ch %d+: .*after', testlog, 100)
+      end)
+      assert_log('RPC ch %d+: invoke nvim_eval', testlog, 100)
+      assert_nolog('RPC ch %d+: .*before', testlog, 100)
+    end
+    eq('Invalid log subsystem or level: foo=DBG',
+       pcall_err(request, 'nvim__set_log_level', 'foo', 'DBG'))
+    eq('Invalid log subsystem or level: UI=verbose',
+       pcall_err(request, 'nvim__set_log_level', 'UI', 'verbose'))
+  end)
 end)
@@ -1279,6 +1279,34 @@ describe('completion', function()
     ]])
   end)
 
+  it('completes words from other buffers with CTRL-N and CTRL-P', function()
+    local function words()
+      local rv = {}
+      for _, item in ipairs(funcs.complete_info({'items'}).items) do
+        table.insert(rv, item.word)
+      end
+      return rv
+    end
+    command('set complete=b')
+    local buf = meths.create_buf(true, false)
+    meths.buf_set_lines(buf, 0, -1, true, {'foo Foobar foo_x fob', 'fox foo fob'})
+
+    feed('ifo<C-N>')
+    eq({'foo', 'foo_x', 'fob', 'fox'}, words())
+    feed('<C-E><Esc>ccfo<C-P>')
+    eq({'foo_x', 'fox', 'foo', 'fob'}, words())
+    feed('<C-E><Esc>')
+    command('set ignorecase')
+    feed('ccfo<C-N>')
+    eq({'foo', 'Foobar', 'foo_x', 'fob', 'fox'}, words())
+    feed('<C-E><Esc>')
+    -- Changed text is used.
+    command('set noignorecase')
+    meths.buf_set_lines(buf, 0, 1, true, {'four'})
+    feed('ccfo<C-N>')
+    eq({'four', 'fox', 'foo', 'fob'}, words())
+  end)
+
   it('does not crash if text is changed by first call to complete function #17489', function()
     source([[
       func Complete(findstart, base) abort
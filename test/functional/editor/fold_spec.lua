@@ -359,4 +359,60 @@ a]], '13m7')
     eq(10, funcs.foldclosedend(7))
     eq(14, funcs.foldclosedend(11))
   end)
+  it('evaluates foldexpr only for changed lines', function()
+    helpers.exec([[
+      let g:fde_calls = 0
+      function! CountingFoldExpr(lnum)
+        let g:fde_calls += 1
+        return getline(a:lnum) =~ '^#' ? '>1' : '='
+      endfunction
+    ]])
+    local lines = {}
+    for i = 1, 1000 do
+      lines[i] = (i == 1 or i == 501) and '# section' or 'text'
+    end
+    helpers.meths.buf_set_lines(0, 0, -1, true, lines)
+    feed_command('set foldmethod=expr foldexpr=CountingFoldExpr(v:lnum)')
+    eq(500, foldclosedend(1))
+    eq(1000, foldclosedend(501))
+
+    helpers.command('let g:fde_calls = 0')
+    funcs.setline(250, 'changed')
+    eq(500, foldclosedend(1))
+    eq(true, funcs.eval('g:fde_calls') <= 5)
+
+    -- cached results move with inserted and deleted lines
+    funcs.append(99, '# new')
+    eq(99, foldclosedend(1))
+    eq(501, foldclosedend(100))
+    helpers.command('100delete')
+    eq(500, foldclosedend(1))
+    eq(true, funcs.eval('g:fde_calls') <= 15)
+
+    -- "zx" evaluates all lines again
+    helpers.command('let g:fde_calls = 0')
+    feed('zx')
+    eq(true, funcs.eval('g:fde_calls') >= 1000)
+  end)
+  it('evaluates foldexpr below a change until the result is unchanged', function()
+    -- the level of a line depends on all lines above it
+    helpers.exec([[
+      function! HeadersAbove(lnum)
+        return len(filter(getline(1, a:lnum), 'v:val =~ "^#"'))
+      endfunction
+    ]])
+    local lines = {}
+    for i = 1, 20 do
+      lines[i] = i == 1 and '# section' or 'text'
+    end
+    helpers.meths.buf_set_lines(0, 0, -1, true, lines)
+    feed_command('set foldmethod=expr foldexpr=HeadersAbove(v:lnum)')
+    eq(1, foldlevel(20))
+    funcs.setline(10, '# nested')
+    eq(1, foldlevel(9))
+    eq(2, foldlevel(10))
+    eq(2, foldlevel(20))
+    funcs.setline(10, 'text')
+    eq(1, foldlevel(20))
+  end)
 end)
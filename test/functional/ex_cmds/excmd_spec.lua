@@ -4,6 +4,8 @@ local eq = helpers.eq
 local clear = helpers.clear
 local pcall_err = helpers.pcall_err
 local assert_alive = helpers.assert_alive
+local eval = helpers.eval
+local source = helpers.source
 
 describe('Ex cmds', function()
   before_each(function()
@@ -26,5 +28,31 @@ describe('Ex cmds', function()
       pcall_err(command, ':bdelete 9999999999999999999999999999999999999999'))
     assert_alive()
   end)
+
+  it('in a function run the current definition after :function!', function()
+    source([[
+      func F()
+        let g:r = []
+        for i in range(3)
+          call add(g:r, i) | let g:r += ['|']
+          silent call add(g:r, 'm')
+        endfor
+        return g:r
+      endfunc
+    ]])
+    eq({0, '|', 'm', 1, '|', 'm', 2, '|', 'm'}, eval('F()'))
+    eq({0, '|', 'm', 1, '|', 'm', 2, '|', 'm'}, eval('F()'))
+    source([[
+      func! F()
+        let g:r = []
+        for i in range(2)
+          let g:r += ['x'] | call add(g:r, i)
+          silent! call add(g:r, 'r')
+        endfor
+        return g:r
+      endfunc
+    ]])
+    eq({'x', 0, 'r', 'x', 1, 'r'}, eval('F()'))
+  end)
 end)
 
@@ -98,4 +98,77 @@ describe(':profile', function()
       matches('Called 1 time', profile)
     end)
   end)
+
+  describe('sample', function()
+    it('writes folded stacks of Vimscript and Lua', function()
+      helpers.skip(helpers.is_os('win'), 'not supported on Windows')
+      source([[
+        function! SampleSpin()
+          let l:i = 0
+          let l:start = reltime()
+          while reltimefloat(reltime(l:start)) < 0.3
+            let l:i += 1
+          endwhile
+        endfunction
+      ]])
+      helpers.exec_lua([[
+        function _G.sample_spin_lua()
+          local start = vim.loop.hrtime()
+          local n = 0
+          while vim.loop.hrtime() - start < 3e8 do
+            n = n + 1
+          end
+          return n
+        end
+      ]])
+      command('profile sample start ' .. tempfile)
+      command('call SampleSpin()')
+      command('lua sample_spin_lua()')
+      assert_file_exists_not(tempfile)
+      command('profile sample stop')
+      assert_file_exists(tempfile)
+      local profile = read_file(tempfile)
+      -- One line per stack: frames separated by ";" and the number of samples.
+      for line in profile:gmatch('[^\n]+') do
+        matches('^[^;]+.* %d+$', line)
+      end
+      matches('SampleSpin%(%) %d+\n', profile)
+      matches('sample_spin_lua [^;\n]*:%d+', profile)
+    end)
+
+    it('keeps a hook set with debug.sethook()', function()
+      helpers.skip(helpers.is_os('win'), 'not supported on Windows')
+      helpers.exec_lua([[
+        _G.lines = 0
+        _G.hook = function() _G.lines = _G.lines + 1 end
+        debug.sethook(_G.hook, 'l')
+      ]])
+      command('profile sample start ' .. tempfile)
+      eq(true, helpers.exec_lua([[
+        local start = vim.loop.hrtime()
+        local n = 0
+        while vim.loop.hrtime() - start < 2e8 do
+          n = n + 1
+        end
+        local before = _G.lines
+        local x = n
+        return _G.lines > before
+      ]]))
+      command('profile sample stop | let g:stopped = 1')
+      eq(1, eval('g:stopped'))
+      assert_file_exists(tempfile)
+      eq({true, 'l'}, helpers.exec_lua([[
+        local hook, mask = debug.gethook()
+        debug.sethook()
+        return { hook == _G.hook, mask }
+      ]]))
+    end)
+
+    it('gives an error when not started', function()
+      eq('Vim(profile):E5710: First use ":profile sample start {fname}"',
+         helpers.pcall_err(command, 'profile sample stop'))
+      eq('Vim(profile):E475: Invalid argument: foo',
+         helpers.pcall_err(command, 'profile sample foo'))
+    end)
+  end)
 end)
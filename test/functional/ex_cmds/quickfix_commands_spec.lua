@@ -122,4 +122,67 @@ describe('quickfix', function()
     command('grep foo ' .. file)
     os.remove(file)
   end)
+
+  it('matches lines that contain the literal text of a format', function()
+    command([[set efm=ERROR\ in\ %f:%l:\ %m,%f>%l:\ warnings%#:\ %m]])
+    command([[cgetexpr ['error IN a.c:3: first', 'b.c>4: warning: x', 'b.c>5: WARNINGS: y', 'a.c>6 warning: z']])
+    local qf = funcs.getqflist()
+    eq({
+      { 'a.c', 3, 'first' },
+      { 'b.c', 4, 'x' },
+      { 'b.c', 5, 'y' },
+      { '', 0, 'a.c>6 warning: z' },
+    }, helpers.exec_lua([[
+      return vim.tbl_map(function(e)
+        return { vim.fn.bufname(e.bufnr), e.lnum, e.text }
+      end, ...)
+    ]], qf))
+    -- Entries for the same file use the same buffer.
+    eq(qf[2].bufnr, qf[3].bufnr)
+  end)
+
+  it('does not use the buffer of a file that was renamed', function()
+    command([[call setqflist([{'filename': 'Xqf_a.c', 'lnum': 1}])]])
+    command('buffer ' .. funcs.getqflist()[1].bufnr .. ' | file Xqf_b.c')
+    command([[call setqflist([{'filename': 'Xqf_a.c', 'lnum': 1}], 'a')]])
+    local qf = funcs.getqflist()
+    eq('Xqf_b.c', funcs.bufname(qf[1].bufnr))
+    eq('Xqf_a.c', funcs.bufname(qf[2].bufnr))
+  end)
+
+  it(':vimgrep finds the same matches in loaded and unloaded files', function()
+    local files = {}
+    for i, text in ipairs({
+      'foo bar\nbaz foo foo\n',  -- searched without loading it
+      'foo\r\nbar\r\n',         -- "dos" 'fileformat'
+      'caf\233 foo\n',           -- latin1
+      'foo',                     -- no end-of-line
+      '',
+    }) do
+      files[i] = ('%s_vimgrep_%d'):format(file_base, i)
+      write_file(files[i], text)
+    end
+    -- A loaded buffer is searched with its changes.
+    command('edit ' .. files[5])
+    curbufmeths.set_lines(0, -1, true, {'', 'a foo'})
+    command('silent vimgrep /foo\\|^$/gj ' .. table.concat(files, ' '))
+    eq({
+      { files[1], 1, 1, 'foo bar' },
+      { files[1], 2, 5, 'baz foo foo' },
+      { files[1], 2, 9, 'baz foo foo' },
+      { files[2], 1, 1, 'foo' },
+      { files[3], 1, 7, 'caf\195\169 foo' },
+      { files[4], 1, 1, 'foo' },
+      { files[5], 1, 1, '' },
+      { files[5], 2, 3, 'a foo' },
+    }, helpers.exec_lua([[
+      return vim.tbl_map(function(e)
+        return { vim.fn.bufname(e.bufnr), e.lnum, e.col, e.text }
+      end, vim.fn.getqflist())
+    ]]))
+    command('bwipe!')
+    for _, f in ipairs(files) do
+      os.remove(f)
+    end
+  end)
 end)
@@ -222,3 +222,66 @@ describe('luaeval(vim.api.…)', function()
     eq('', funcs.luaeval('vim.api.nvim_replace_termcodes("", true, {}, {[vim.type_idx]=vim.types.array})'))
   end)
 end)
+
+describe('vim._lazy', function()
+  it('returns lines as a lazy array', function()
+    funcs.setline(1, {'abc', '', 'a\nb', 'ttt'})
+    eq({'userdata', 4, 'abc', '', 'a\000b', 'ttt', true, true, {'abc', '', 'a\000b', 'ttt'}},
+       exec_lua([[
+         local lines = vim._lazy(vim.api.nvim_buf_get_lines, 0, 0, -1, true)
+         return { type(lines), #lines, lines[1], lines[2], lines[3], lines[4], lines[5] == nil,
+                  lines[0] == nil, lines:totable() }
+       ]]))
+    eq(0, exec_lua([[return #vim._lazy(vim.api.nvim_buf_get_lines, 0, 2, 1, false)]]))
+    eq('Index out of bounds', exec_lua([[
+      local ok, err = pcall(vim._lazy, vim.api.nvim_buf_get_lines, 0, 0, 10, true)
+      return not ok and err
+    ]]))
+    -- Only the result of the called function is lazy.
+    eq('table', exec_lua([[
+      vim._lazy(vim.api.nvim_buf_get_lines, 0, 0, -1, true)
+      return type(vim.api.nvim_buf_get_lines(0, 0, -1, true))
+    ]]))
+  end)
+
+  it('returns other arrays as a lazy array', function()
+    eq({'userdata', 2, {1, 0, 1}, {2, 1, 0}}, exec_lua([[
+      vim.api.nvim_buf_set_lines(0, 0, -1, true, {'abc', 'def'})
+      local ns = vim.api.nvim_create_namespace('test')
+      vim.api.nvim_buf_set_extmark(0, ns, 0, 1, {})
+      vim.api.nvim_buf_set_extmark(0, ns, 1, 0, {})
+      local marks = vim._lazy(vim.api.nvim_buf_get_extmarks, 0, ns, 0, -1, {})
+      return { type(marks), #marks, marks[1], marks[2] }
+    ]]))
+    eq({'table', 1}, exec_lua([[
+      return { type(vim._lazy(vim.api.nvim_get_mode)),
+               vim._lazy(vim.api.nvim_buf_line_count, 0) }
+    ]]))
+  end)
+
+  it('can be passed to API functions', function()
+    funcs.setline(1, {'abc', 'a\nb'})
+    eq({'abc', 'a\000b', 'x', 'y'}, exec_lua([[
+      local lines = vim._lazy(vim.api.nvim_buf_get_lines, 0, 0, -1, true)
+      local other = vim._lazy(vim.api.nvim__id_array, {'x', 'y'})
+      vim.api.nvim_buf_set_lines(0, 0, -1, true, lines)
+      vim.api.nvim_buf_set_lines(0, -1, -1, true, other)
+      return vim.api.nvim_buf_get_lines(0, 0, -1, true)
+    ]]))
+    eq({{'a', 'b'}, {1, 2}}, exec_lua([[
+      return vim.api.nvim__id({ vim._lazy(vim.api.nvim__id_array, {'a', 'b'}),
+                                vim._lazy(vim.api.nvim__id_array, {1, 2}) })
+    ]]))
+  end)
+
+  it('only makes the result of the function itself lazy', function()
+    funcs.setline(1, {'abc', 'def'})
+    eq({'table', 'userdata', 2}, exec_lua([[
+      local res = vim._lazy(vim.api.nvim_exec_lua, [=[
+        _G.inner = vim.api.nvim_buf_get_lines(0, 0, -1, true)
+        return { 1, 2 }
+      ]=], {})
+      return { type(_G.inner), type(res), res[2] }
+    ]]))
+  end)
+end)
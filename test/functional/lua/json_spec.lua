@@ -3,6 +3,7 @@ local clear = helpers.clear
 local NIL = helpers.NIL
 local exec_lua = helpers.exec_lua
 local eq = helpers.eq
+local matches = helpers.matches
 
 describe('vim.json.decode function', function()
   before_each(function()
@@ -80,6 +81,16 @@ describe('vim.json.decode function', function()
     eq('\240\144\128\128', exec_lua([[return vim.json.decode('"\\uD800\\uDC00"')]]))
   end)
 
+  it('parses long strings with escapes and multibyte characters', function()
+    -- Escapes and non-ASCII bytes on both sides of 16-byte boundaries.
+    local plain = ('abcdefghijklmnopq'):rep(3)
+    eq(plain .. '\n' .. plain .. '«' .. plain .. '"',
+       exec_lua([[return vim.json.decode(...)]],
+                '"' .. plain .. '\\n' .. plain .. '«' .. plain .. '\\""'))
+    matches('unexpected end of string',
+            exec_lua([[return select(2, pcall(vim.json.decode, ...))]], '["' .. plain))
+  end)
+
   it('accepts all spaces in every position where space may be put', function()
     local s = ' \t\n\r \t\r\n \n\t\r \n\r\t \r\t\n \r\n\t\t \n\r\t \r\n\t\n \r\t\n\r \t\r \n\t\r\n \n \t\r\n \r\t\n\t \r\n\t\r \n\r \t\n\r\t \r \t\n\r \n\t\r\t \n\r\t\n \r\n \t\r\n\t'
     local str = ('%s{%s"key"%s:%s[%s"val"%s,%s"val2"%s]%s,%s"key2"%s:%s1%s}%s'):gsub('%%s', s)
@@ -103,6 +114,12 @@ describe('vim.json.encode function', function()
      eq('"þÿþ"', exec_lua([[return vim.json.encode('þÿþ')]]))
    end)
 
+   it('dumps long strings with characters to escape', function()
+     local plain = ('abcdefghijklmnopq'):rep(3)
+     eq('"' .. plain .. '\\n' .. plain .. '\\/' .. plain .. '«\\""',
+        exec_lua([[return vim.json.encode(...)]], plain .. '\n' .. plain .. '/' .. plain .. '«"'))
+   end)
+
    it('dumps numbers', function()
      eq('0', exec_lua([[return vim.json.encode(0)]]))
      eq('10', exec_lua([[return vim.json.encode(10)]]))
@@ -131,3 +148,42 @@ describe('vim.json.encode function', function()
   end)
 
 end)
+
+describe('vim._json_rpc_reader', function()
+  before_each(function()
+    clear()
+  end)
+
+  it('decodes messages split across chunks in order', function()
+    eq({ true, {
+      { id = 1, result = { 1, NIL, 'a\nb' } },
+      {},
+      { 'body', 'unexpected end of input at character 4' },
+      { 'header', 'Content-Length not found in headers: Content-Type: x' },
+      { method = 'x' },
+    } }, exec_lua([[
+      local msgs = {}
+      local reader = vim._json_rpc_reader(function(msg)
+        table.insert(msgs, msg)
+      end, function(err, kind)
+        table.insert(msgs, { kind, err })
+      end)
+      local function frame(body)
+        return ('Content-Length: %d\r\n\r\n%s'):format(#body, body)
+      end
+      local data = frame('{"id":1,"result":[1,null,"a\\nb"],"error":null}') .. frame('{}')
+        .. frame('[1,') .. 'Content-Type: x\r\n\r\n' .. 'garbage' .. frame('{"method":"x"}')
+      for i = 1, #data, 7 do
+        reader:feed(data:sub(i, i + 6))
+      end
+      local closed = false
+      reader:close(function()
+        closed = true
+      end)
+      vim.wait(1000, function()
+        return closed
+      end)
+      return { closed, msgs }
+    ]]))
+  end)
+end)
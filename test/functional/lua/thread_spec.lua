@@ -1,12 +1,17 @@
+local luv = require('luv')
 local helpers = require('test.functional.helpers')(after_each)
 local Screen = require('test.functional.ui.screen')
 local assert_alive = helpers.assert_alive
 local clear = helpers.clear
+local command = helpers.command
+local expect_exit = helpers.expect_exit
 local feed = helpers.feed
 local eq = helpers.eq
 local exec_lua = helpers.exec_lua
+local matches = helpers.matches
 local next_msg = helpers.next_msg
 local NIL = helpers.NIL
+local ok = helpers.ok
 local pcall_err = helpers.pcall_err
 
 describe('thread', function()
@@ -406,3 +411,47 @@ describe('threadpool', function()
     end)
   end)
 end)
+
+describe('vim.pool', function()
+  before_each(clear)
+
+  it('runs functions on worker threads', function()
+    exec_lua [[
+      vim.pool.submit(function(a, b)
+        return a + b, vim.is_thread(), {vim.diff('a\n', 'b\n')}
+      end, 1, 2, function(err, sum, is_thread, t)
+        vim.rpcnotify(1, 'result', err, sum, is_thread, t)
+      end)
+    ]]
+    eq({'notification', 'result', {NIL, 3, true, {'@@ -1 +1 @@\n-a\n+b\n'}}}, next_msg())
+    assert(exec_lua('return vim.pool.size()') >= 1)
+  end)
+
+  it('passes errors to the callback', function()
+    exec_lua [[
+      vim.pool.submit(function()
+        error('Error in pool task')
+      end, function(err)
+        vim.rpcnotify(1, 'result', err:match('Error in pool task') ~= nil)
+      end)
+    ]]
+    eq({'notification', 'result', {true}}, next_msg())
+  end)
+
+  it('validates arguments', function()
+    matches('vim.pool.submit: expected Lua function',
+            pcall_err(exec_lua, 'vim.pool.submit(print)'))
+    assert_alive()
+  end)
+
+  it('does not run queued tasks on exit', function()
+    exec_lua [[
+      for _ = 1, vim.pool.size() * 20 do
+        vim.pool.submit(function() vim.loop.sleep(200) end)
+      end
+    ]]
+    local start = luv.hrtime()
+    expect_exit(command, 'qa!')
+    ok((luv.hrtime() - start) / 1e6 < 2000)
+  end)
+end)
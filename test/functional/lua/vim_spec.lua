@@ -2243,6 +2243,46 @@ describe('lua stdlib', function()
     assert_alive()
   end)
 
+  it('vim.buf_view', function()
+    meths.buf_set_lines(0, 0, -1, true, {"abc", "", "a\0b", "abc abbc"})
+    exec_lua [[view = vim.buf_view(0)]]
+    eq({true, 4, 'abc', '', 'a\0b', 3}, exec_lua[[
+      return {view:valid(), view:line_count(), view:line(0), view:line(1), view:line(2),
+              view:line_len(2)}
+    ]])
+    eq('bc\n\na\0b\nab', exec_lua[[return view:text(0, 1, 3, 2)]])
+    eq('b', exec_lua[[return view:text(2, 2, 2, 3)]])
+    eq({{1, ''}, {2, 'a\0b'}}, exec_lua[[
+      local lines = {}
+      for row, line in view:lines(1, 3) do
+        table.insert(lines, {row, line})
+      end
+      return lines
+    ]])
+    eq(4, exec_lua[[
+      local n = 0
+      for _ in view:lines() do
+        n = n + 1
+      end
+      return n
+    ]])
+
+    eq({0, 0, 3}, exec_lua[[return {view:find('abc')}]])
+    eq({3, 4, 8}, exec_lua[[return {view:find('ab\\+c', 3, 1)}]])
+    eq({3, 0, 3}, exec_lua[[return {view:find('abc', 1)}]])
+    eq({}, exec_lua[[return {view:find('abc', 1, 0, 3)}]])
+    eq({3, 4, 8}, exec_lua[[return {view:find('abbc', 0, 0, 4, true)}]])
+    eq({}, exec_lua[[return {view:find('b\\+', 0, 0, 4, true)}]])
+    matches('couldn.t parse regex', pcall_err(exec_lua, [[view:find('\\z')]]))
+    matches('invalid row', pcall_err(exec_lua, [[view:line(4)]]))
+
+    -- Outdated once the buffer changes.
+    meths.buf_set_lines(0, 0, 1, true, {"xyz"})
+    eq(false, exec_lua[[return view:valid()]])
+    matches('buffer view is outdated', pcall_err(exec_lua, [[view:line(0)]]))
+    eq('xyz', exec_lua[[return vim.buf_view(0):line(0)]])
+  end)
+
   it('vim.defer_fn', function()
     eq(false, exec_lua [[
       vim.g.test = false
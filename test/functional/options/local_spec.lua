@@ -0,0 +1,39 @@
+local helpers = require('test.functional.helpers')(after_each)
+local clear, command, eq, eval = helpers.clear, helpers.command, helpers.eq, helpers.eval
+local meths = helpers.meths
+
+describe('window and buffer local string options', function()
+  before_each(clear)
+
+  it('keep their own value when copied from another window', function()
+    command('setlocal foldmethod=marker statusline=%f colorcolumn=+1')
+    command('split')
+    command('split')
+    command('setlocal foldmethod=indent statusline=%t')
+    eq({'marker', 'marker', 'indent'},
+       eval("map(range(3, 1, -1), {_, nr -> getwinvar(nr, '&foldmethod')})"))
+    eq('%f', eval('getwinvar(2, "&statusline")'))
+    command('close')
+    command('close')
+    eq('marker', eval('&foldmethod'))
+    eq('%f', eval('&statusline'))
+    eq('+1', eval('&colorcolumn'))
+  end)
+
+  it('keep their own value when copied from the global value', function()
+    command('set iskeyword=@,48-57,_ comments=:#')
+    local bufs = {}
+    for i = 1, 3 do
+      bufs[i] = meths.create_buf(true, false)
+    end
+    meths.buf_set_option(bufs[2], 'iskeyword', '@,-')
+    meths.buf_set_option(bufs[2], 'comments', ':--')
+    command('bwipe ' .. bufs[1])
+    eq('@,48-57,_', meths.buf_get_option(bufs[3], 'iskeyword'))
+    eq(':#', meths.buf_get_option(bufs[3], 'comments'))
+    eq('@,-', meths.buf_get_option(bufs[2], 'iskeyword'))
+    command('bwipe ' .. bufs[3])
+    eq(':--', meths.buf_get_option(bufs[2], 'comments'))
+    eq(':#', eval('&g:comments'))
+  end)
+end)
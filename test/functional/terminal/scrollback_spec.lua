@@ -58,6 +58,24 @@ describe(':terminal scrollback', function()
     end)
   end)
 
+  describe('rows scrolled off the screen', function()
+    it('keep their text and attributes', function()
+      feed_data({'\027[1mbold\027[m 日本語', 'line1', 'line2', 'line3', 'line4',
+                 'line5', ''})
+      feed('<c-\\><c-n>gg')
+      screen:expect([[
+        ^tty ready                     |
+        {3:bold} 日本語                   |
+        line1                         |
+        line2                         |
+        line3                         |
+        line4                         |
+                                      |
+      ]])
+      eq('bold 日本語', eval('getline(2)'))
+    end)
+  end)
+
   describe('with cursor at last row', function()
     before_each(function()
       feed_data({'line1', 'line2', 'line3', 'line4', ''})
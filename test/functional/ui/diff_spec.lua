@@ -1618,3 +1618,79 @@ it('diff mode works properly if file contains NUL bytes vim-patch:8.2.3925', fun
                                             |
   ]])
 end)
+
+describe('diff update', function()
+  local exec_lua = helpers.exec_lua
+  local eq = helpers.eq
+
+  before_each(function()
+    clear()
+    exec_lua [[
+      -- Diff highlight and filler lines of every line of the diff windows.
+      function _G.diff_state()
+        local state = {}
+        for _, win in ipairs(vim.api.nvim_tabpage_list_wins(0)) do
+          vim.api.nvim_win_call(win, function()
+            for lnum = 1, vim.fn.line('$') + 1 do
+              table.insert(state, { vim.fn.diff_hlID(lnum, 1), vim.fn.diff_filler(lnum) })
+            end
+          end)
+        end
+        return state
+      end
+
+      function _G.setup_diff(n)
+        local lines = {}
+        for i = 1, n do
+          lines[i] = 'line ' .. i
+        end
+        vim.api.nvim_buf_set_lines(0, 0, -1, true, lines)
+        vim.cmd('diffthis | vnew | diffthis')
+        vim.api.nvim_buf_set_lines(0, 0, -1, true, lines)
+      end
+    ]]
+  end)
+
+  it('only diffs changed lines again', function()
+    exec_lua [[
+      setup_diff(100)
+      vim.api.nvim_buf_set_lines(0, 10, 12, true, { 'changed' })
+      vim.cmd('redraw')
+      vim.api.nvim_buf_set_lines(0, 50, 50, true, { 'new 1', 'new 2' })
+      vim.api.nvim_buf_set_lines(0, 9, 10, true, {})
+      vim.cmd('redraw')
+      vim.api.nvim_buf_set_text(0, 80, 0, 80, 0, { 'x' })
+      vim.api.nvim_buf_set_lines(0, 0, 1, true, {})
+      vim.cmd('redraw')
+    ]]
+    local incremental = exec_lua('return diff_state()')
+    command('diffupdate')
+    eq(exec_lua('return diff_state()'), incremental)
+  end)
+
+  it('computes large diffs without blocking', function()
+    exec_lua [[
+      setup_diff(30000)
+      vim.api.nvim_buf_set_lines(0, 20000, 20001, true, { 'changed' })
+      vim.cmd('redraw')
+    ]]
+    eq(true, exec_lua [[
+      return vim.wait(10000, function()
+        return vim.fn.diff_hlID(20001, 1) ~= 0
+      end)
+    ]])
+    -- Changes made while the diff is computed are applied afterwards.
+    exec_lua [[
+      vim.cmd('diffoff! | diffthis | wincmd w | diffthis | wincmd w | redraw')
+      vim.api.nvim_buf_set_lines(0, 100, 101, true, {})
+      vim.api.nvim_buf_set_lines(0, 25000, 25001, true, { 'changed too' })
+      vim.wait(10000, function()
+        return vim.fn.diff_hlID(25001, 1) ~= 0
+      end)
+      vim.cmd('redraw')
+    ]]
+    local async = exec_lua('return diff_state()')
+    command('diffupdate')
+    eq(exec_lua('return diff_state()'), async)
+  end)
+end)
@@ -992,4 +992,27 @@ describe('regressions', function()
     helpers.curbufmeths.set_lines(0, -1, false, { string.rep('a', 1010)..'world' })
     helpers.exec 'windo diffthis'
   end)
+
+  it('aligns large hunks in three buffers', function()
+    clear()
+    feed(':set diffopt+=linematch:1500<cr>')
+    local function lines(buf, skip)
+      local t = {}
+      for i = 1, 400 do
+        if not skip or i % 10 ~= 0 then
+          table.insert(t, ('line %d of buffer %d'):format(i, buf))
+        end
+      end
+      return t
+    end
+    helpers.curbufmeths.set_lines(0, -1, false, lines(1))
+    helpers.exec 'vnew'
+    helpers.curbufmeths.set_lines(0, -1, false, lines(2, true))
+    helpers.exec 'vnew'
+    helpers.curbufmeths.set_lines(0, -1, false, lines(3))
+    helpers.exec 'windo diffthis'
+    helpers.exec '2wincmd w'
+    -- the filler lines are where the lines are missing, not at the end
+    helpers.eq({0, 1, 1, 0}, helpers.funcs.map({9, 10, 19, 360}, 'diff_filler(v:val)'))
+  end)
 end)
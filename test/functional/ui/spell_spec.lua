@@ -7,6 +7,7 @@ local feed = helpers.feed
 local insert = helpers.insert
 local command = helpers.command
 local is_os = helpers.is_os
+local eq = helpers.eq
 
 describe("'spell'", function()
   local screen
@@ -74,6 +75,32 @@ describe("'spell'", function()
     ]])
   end)
 
+  it('rechecks words after :spellgood', function()
+    command('set spell')
+    insert('Lorem ipsum dolor')
+    screen:expect([[
+      {1:Lorem} {1:ipsum} dolo^r                                                               |
+      {0:~                                                                               }|
+      {0:~                                                                               }|
+      {0:~                                                                               }|
+      {0:~                                                                               }|
+      {0:~                                                                               }|
+      {0:~                                                                               }|
+                                                                                      |
+    ]])
+    command('spellgood! ipsum')
+    screen:expect([[
+      {1:Lorem} ipsum dolo^r                                                               |
+      {0:~                                                                               }|
+      {0:~                                                                               }|
+      {0:~                                                                               }|
+      {0:~                                                                               }|
+      {0:~                                                                               }|
+      {0:~                                                                               }|
+                                                                                      |
+    ]])
+  end)
+
   it('"noplainbuffer" and syntax #20385', function()
     command('set filetype=c')
     command('syntax on')
@@ -163,4 +190,15 @@ describe("'spell'", function()
       {6:search hit BOTTOM, continuing at TOP}                                            |
     ]])
   end)
+
+  it("returns suggestions found before the 'spellsuggest' timeout", function()
+    command('set spell spellsuggest=timeout:1,best')
+    helpers.exec([[
+      let g:sugs = spellsuggest(repeat('qwxz', 12) .. 'thee')
+      let g:done = 1
+    ]])
+    -- Hitting the timeout does not interrupt the following commands.
+    eq(1, helpers.eval('g:done'))
+    eq(1, helpers.eval('type(g:sugs) == v:t_list'))
+  end)
 end)
@@ -122,6 +122,9 @@ describe('json_decode() function', function()
     eq(-100000, funcs.json_decode('  -100000  '))
     eq(0, funcs.json_decode('0'))
     eq(0, funcs.json_decode('-0'))
+    eq(123456789012345678, funcs.json_decode('123456789012345678'))
+    eq(-123456789012345678, funcs.json_decode('-123456789012345678'))
+    eq(1234567890123456789, funcs.json_decode('1234567890123456789'))
   end)
 
   it('fails to parse +numbers and .number', function()
@@ -367,6 +370,18 @@ describe('json_decode() function', function()
     }))
   end)
 
+  it('parses long strings with escapes and multibyte characters', function()
+    -- Escapes and non-ASCII bytes on both sides of 16-byte boundaries.
+    local plain = ('abcdefghijklmnopq'):rep(3)
+    eq(plain, funcs.json_decode('"' .. plain .. '"'))
+    eq(plain .. '\n' .. plain .. '«' .. plain .. '\240\144\128\128',
+       funcs.json_decode('"' .. plain .. '\\n' .. plain .. '«' .. plain .. '\\uD800\\uDC00"'))
+    eq('Vim(call):E474: Only UTF-8 strings allowed: \255"',
+       exc_exec('call json_decode("\\"' .. plain .. '\\xFF\\"")'))
+    eq('Vim(call):E474: ASCII control characters cannot be present inside string: \t"',
+       exc_exec('call json_decode("\\"' .. plain .. '\t\\"")'))
+  end)
+
   it('fails on strings with invalid bytes', function()
     eq('Vim(call):E474: Only UTF-8 strings allowed: \255"',
        exc_exec('call json_decode("\\t\\"\\xFF\\"")'))
@@ -538,6 +553,12 @@ describe('json_encode() function', function()
     eq('"þÿþ"', funcs.json_encode('þÿþ'))
   end)
 
+  it('dumps long strings with characters to escape', function()
+    local plain = ('abcdefghijklmnopq'):rep(3)
+    eq('"' .. plain .. '\\n' .. plain .. '\\u001B' .. plain .. 'þ\\""',
+       funcs.json_encode(plain .. '\n' .. plain .. '\27' .. plain .. 'þ"'))
+  end)
+
   it('dumps blobs', function()
     eq('[]', eval('json_encode(0z)'))
     eq('[222, 173, 190, 239]', eval('json_encode(0zDEADBEEF)'))
@@ -92,6 +92,27 @@ describe(':let', function()
     ]])
     eq(1, eval('1'))
   end)
+
+  it('handles many local variables, :unlet and a kept l: dict', function()
+    source([[
+      func F(a, b)
+        for i in range(20)
+          let l:v{i} = i
+        endfor
+        unlet l:v3 l:v15
+        let l:v3 = 'again'
+        let g:locals = l:
+        return l:v3 .. l:v19
+      endfunc
+    ]])
+    for _ = 1, 3 do
+      eq('again19', eval('F(1, 2)'))
+    end
+    eq(19, eval('len(g:locals)'))
+    command('call remove(g:locals, "v1") | let g:locals.v1 = 1 | unlet g:locals.v2')
+    command('call garbagecollect()')
+    eq({1, 4}, eval('[g:locals.v1, g:locals.v4]'))
+  end)
 end)
 
 describe(':let and :const', function()
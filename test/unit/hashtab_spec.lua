@@ -0,0 +1,81 @@
+local helpers = require('test.unit.helpers')(after_each)
+local itp = helpers.gen_itp(it)
+
+local cimport = helpers.cimport
+local eq = helpers.eq
+local ffi = helpers.ffi
+local to_cstr = helpers.to_cstr
+
+local hashtab = cimport('./src/nvim/hashtab.h')
+
+describe('hashtab', function()
+  local ht
+  local keys
+
+  local function add(key)
+    keys[key] = to_cstr(key)  -- keep the key alive
+    return hashtab.hash_add(ht, keys[key])
+  end
+
+  local function has(key)
+    local hi = hashtab.hash_find(ht, key)
+    return hi.hi_key ~= nil
+           and hi.hi_key ~= ffi.cast('char *', hashtab._hash_key_removed())
+           and ffi.string(hi.hi_key) == key
+  end
+
+  local function remove(key)
+    hashtab.hash_remove(ht, hashtab.hash_find(ht, key))
+  end
+
+  before_each(function()
+    ht = ffi.new('hashtab_T[1]')
+    keys = {}
+    hashtab.hash_init(ht)
+  end)
+
+  after_each(function()
+    hashtab.hash_clear(ht)
+  end)
+
+  itp('finds added keys when growing and shrinking', function()
+    for i = 1, 2000 do
+      eq(1, add('key' .. i))
+    end
+    eq(2000, tonumber(ht[0].ht_used))
+    for i = 1, 2000 do
+      eq(true, has('key' .. i))
+    end
+    eq(false, has('key0'))
+    eq(false, has('key2001'))
+
+    for i = 1, 2000, 2 do
+      remove('key' .. i)
+    end
+    eq(1000, tonumber(ht[0].ht_used))
+    for i = 1, 2000 do
+      eq(i % 2 == 0, has('key' .. i))
+    end
+
+    for i = 2, 2000, 2 do
+      remove('key' .. i)
+    end
+    eq(0, tonumber(ht[0].ht_used))
+    eq(false, has('key2'))
+  end)
+
+  itp('reuses removed items', function()
+    -- Keep the table small, so that lookups have to skip removed items.
+    for round = 1, 50 do
+      for i = 1, 8 do
+        eq(1, add(('r%d_%d'):format(round, i)))
+      end
+      for i = 1, 8 do
+        eq(true, has(('r%d_%d'):format(round, i)))
+        remove(('r%d_%d'):format(round, i))
+      end
+      eq(0, tonumber(ht[0].ht_used))
+    end
+    eq(15, tonumber(ht[0].ht_mask))
+  end)
+end)